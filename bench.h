@@ -0,0 +1,29 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include "pcb.h"
+
+// Shared harness for the benchmark programs (bench_*.c), built and run with "make bench".
+// Each program boots the simulator in-process and drives it through the same calls the shell
+// and the kernel use, so what it times is the simulator's own code with no parsing. The
+// simulator keeps printing to stdout as usual; Bench_boot sends that to /dev/null and results
+// go to stderr.
+
+// Creates the process table with maxPids slots and starts init. Returns false on failure.
+bool Bench_boot(int maxPids);
+
+// Seconds on a monotonic clock
+double Bench_now();
+
+// Makes a process at priority that is not scheduled, for benchmarks that drive the PCB and
+// mailbox layers directly. Exits on failure.
+PCB *Bench_newProcess(int priority);
+
+// Prints one result line: what was measured, how many operations and the time per operation.
+void Bench_report(const char *label, long operations, double seconds);
+
+// Prints one result line for memory: what was measured and how many bytes it took.
+void Bench_reportBytes(const char *label, long bytes);
+
+#endif // BENCH_H
@@ -0,0 +1,69 @@
+#include "bench.h"
+#include <stdio.h>
+
+// Batched against one-at-a-time message passing: K messages from one sender are queued with
+// sendMessages and drained with receiveMessages, against K calls of sendMessage and
+// receiveMessage, for K = 1, 8, 64 and 512.
+
+#define BENCH_MESSAGES 4000000L
+#define BENCH_MAX_BATCH 512
+
+int main()
+{
+    if (!Bench_boot(64))
+    {
+        fprintf(stderr, "Failed to start the simulator.\n");
+        return 1;
+    }
+    PCB *receiver = Bench_newProcess(1);
+    PCB *sender = Bench_newProcess(1);
+    setMailboxCapacity(receiver, BENCH_MAX_BATCH);
+
+    const char *contents[BENCH_MAX_BATCH];
+    for (int i = 0; i < BENCH_MAX_BATCH; i++)
+    {
+        contents[i] = "batched message";
+    }
+    static Message out[BENCH_MAX_BATCH];
+    char buffer[MAX_MESSAGE_LENGTH];
+    int senderPid;
+    char label[64];
+
+    static const int batchSizes[] = {1, 8, 64, BENCH_MAX_BATCH};
+    for (int b = 0; b < (int)(sizeof(batchSizes) / sizeof(batchSizes[0])); b++)
+    {
+        int k = batchSizes[b];
+        long rounds = BENCH_MESSAGES / k;
+
+        double start = Bench_now();
+        for (long round = 0; round < rounds; round++)
+        {
+            for (int i = 0; i < k; i++)
+            {
+                sendMessage(receiver, contents[i], sender->pid);
+            }
+            for (int i = 0; i < k; i++)
+            {
+                receiveMessage(receiver, buffer, &senderPid);
+            }
+        }
+        snprintf(label, sizeof(label), "K=%d one at a time (per message)", k);
+        Bench_report(label, rounds * k, Bench_now() - start);
+
+        start = Bench_now();
+        long moved = 0;
+        for (long round = 0; round < rounds; round++)
+        {
+            sendMessages(receiver, contents, k, sender->pid);
+            moved += receiveMessages(receiver, out, k);
+        }
+        snprintf(label, sizeof(label), "K=%d batched (per message)", k);
+        Bench_report(label, rounds * k, Bench_now() - start);
+        if (moved != rounds * k)
+        {
+            fprintf(stderr, "Batched run moved %ld of %ld messages.\n", moved, rounds * k);
+            return 1;
+        }
+    }
+    return 0;
+}
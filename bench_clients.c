@@ -0,0 +1,246 @@
+#include "bench.h"
+#include "server.h"
+#include "ring.h"
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Command throughput of the two server modes with C concurrent client processes, for C = 1, 8
+// and 64. Each client of the socket server keeps BENCH_PIPELINE timer-tick commands in flight
+// and counts the '.' lines ending their responses. Each driver of the shared-memory ring pushes
+// RING_TICK records, and a final RING_SYNC shows they have all run. The simulator runs in a
+// child process; the time covers starting the clients until the last command is done.
+
+#define BENCH_COMMANDS 400000L
+#define BENCH_PIPELINE 64
+#define BENCH_MAX_CLIENTS 64
+// How long a client waits for the server to come up
+#define BENCH_CONNECT_TRIES 5000
+
+static void pause_briefly()
+{
+    struct timespec pause = {.tv_sec = 0, .tv_nsec = 1000000};
+    nanosleep(&pause, NULL);
+}
+
+// Runs the simulator in a child process serving on the socket path, or on the ring name
+static pid_t start_server(bool ring, const char *name)
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        if (!Bench_boot(64))
+        {
+            _exit(1);
+        }
+        _exit((ring ? Server_runRing(name) : Server_run(name)) ? 0 : 1);
+    }
+    return pid;
+}
+
+static int connect_to(const char *path)
+{
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+    for (int attempt = 0; attempt < BENCH_CONNECT_TRIES; attempt++)
+    {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+        {
+            return -1;
+        }
+        if (connect(fd, (struct sockaddr *)&address, sizeof(address)) == 0)
+        {
+            return fd;
+        }
+        close(fd);
+        pause_briefly();
+    }
+    return -1;
+}
+
+// Sends commands timer ticks over the socket, BENCH_PIPELINE at a time, and waits for every
+// response. Returns false on a connection failure.
+static bool socket_client(const char *path, long commands)
+{
+    int fd = connect_to(path);
+    if (fd < 0)
+    {
+        return false;
+    }
+    char requests[2 * BENCH_PIPELINE];
+    for (int i = 0; i < BENCH_PIPELINE; i++)
+    {
+        memcpy(requests + 2 * i, "T\n", 2);
+    }
+
+    char buffer[65536];
+    bool lineStart = true;
+    bool dotLine = false; // The current line so far is a single '.'
+    for (long sent = 0; sent < commands;)
+    {
+        int window = commands - sent < BENCH_PIPELINE ? (int)(commands - sent) : BENCH_PIPELINE;
+        if (write(fd, requests, 2 * window) != 2 * window)
+        {
+            return false;
+        }
+        sent += window;
+        for (int done = 0; done < window;)
+        {
+            ssize_t length = read(fd, buffer, sizeof(buffer));
+            if (length <= 0)
+            {
+                return false;
+            }
+            for (ssize_t i = 0; i < length; i++)
+            {
+                char c = buffer[i];
+                if (c == '\n')
+                {
+                    done += dotLine;
+                    dotLine = false;
+                    lineStart = true;
+                    continue;
+                }
+                dotLine = lineStart && c == '.';
+                lineStart = false;
+            }
+        }
+    }
+    close(fd);
+    return true;
+}
+
+static RingChannel *attach_to(const char *name)
+{
+    for (int attempt = 0; attempt < BENCH_CONNECT_TRIES; attempt++)
+    {
+        RingChannel *channel = Ring_attach(name);
+        if (channel != NULL)
+        {
+            return channel;
+        }
+        pause_briefly();
+    }
+    return NULL;
+}
+
+// Pushes commands RING_TICK records without asking for completions
+static bool ring_client(const char *name, long commands)
+{
+    RingChannel *channel = attach_to(name);
+    if (channel == NULL)
+    {
+        return false;
+    }
+    RingCommand command = {.op = RING_TICK};
+    for (long i = 0; i < commands; i++)
+    {
+        command.tag = (uint64_t)i;
+        while (!Ring_pushCommand(channel, &command))
+        {
+            sched_yield(); // The simulator is behind
+        }
+    }
+    Ring_close(channel);
+    return true;
+}
+
+// Runs one command through the ring with a completion and waits for it
+static bool ring_call(RingChannel *channel, RingOp op)
+{
+    RingCommand command = {.op = op, .flags = RING_REPLY_WANTED};
+    while (!Ring_pushCommand(channel, &command))
+    {
+        sched_yield();
+    }
+    RingCompletion completion;
+    while (!Ring_popCompletion(channel, &completion))
+    {
+        sched_yield();
+    }
+    return completion.op == op;
+}
+
+// Starts clients client processes that each send their share of BENCH_COMMANDS and waits for
+// them. Returns false if any of them failed.
+static bool run_clients(bool ring, const char *name, int clients)
+{
+    pid_t pids[BENCH_MAX_CLIENTS];
+    for (int i = 0; i < clients; i++)
+    {
+        pids[i] = fork();
+        if (pids[i] == 0)
+        {
+            long commands = BENCH_COMMANDS / clients;
+            _exit((ring ? ring_client(name, commands) : socket_client(name, commands)) ? 0 : 1);
+        }
+    }
+    bool succeeded = true;
+    for (int i = 0; i < clients; i++)
+    {
+        int status;
+        succeeded &= pids[i] > 0 && waitpid(pids[i], &status, 0) == pids[i] && WIFEXITED(status) &&
+                     WEXITSTATUS(status) == 0;
+    }
+    return succeeded;
+}
+
+int main()
+{
+    char socketPath[64];
+    char ringName[64];
+    snprintf(socketPath, sizeof(socketPath), "/tmp/bench_clients.%d.sock", (int)getpid());
+    snprintf(ringName, sizeof(ringName), "/bench_clients.%d", (int)getpid());
+    char label[64];
+
+    static const int clientCounts[] = {1, 8, BENCH_MAX_CLIENTS};
+    for (int c = 0; c < (int)(sizeof(clientCounts) / sizeof(clientCounts[0])); c++)
+    {
+        int clients = clientCounts[c];
+        long commands = BENCH_COMMANDS / clients * clients;
+
+        pid_t server = start_server(false, socketPath);
+        double start = Bench_now();
+        bool succeeded = run_clients(false, socketPath, clients);
+        double seconds = Bench_now() - start;
+        kill(server, SIGTERM);
+        waitpid(server, NULL, 0);
+        if (!succeeded)
+        {
+            fprintf(stderr, "A socket client failed.\n");
+            return 1;
+        }
+        snprintf(label, sizeof(label), "C=%d socket clients (per command)", clients);
+        Bench_report(label, commands, seconds);
+
+        server = start_server(true, ringName);
+        RingChannel *channel = attach_to(ringName);
+        if (channel == NULL)
+        {
+            fprintf(stderr, "Failed to attach to the ring.\n");
+            kill(server, SIGTERM);
+            return 1;
+        }
+        start = Bench_now();
+        succeeded = run_clients(true, ringName, clients) && ring_call(channel, RING_SYNC);
+        seconds = Bench_now() - start;
+        ring_call(channel, RING_QUIT);
+        Ring_close(channel);
+        waitpid(server, NULL, 0);
+        if (!succeeded)
+        {
+            fprintf(stderr, "A ring driver failed.\n");
+            return 1;
+        }
+        snprintf(label, sizeof(label), "C=%d ring drivers (per command)", clients);
+        Bench_report(label, commands, seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "bench.h"
+#include "deadlock.h"
+#include "pidtable.h"
+#include "semaphore.h"
+#include <stdio.h>
+
+// Cost of the deadlock detector on block/unblock churn. A waiter blocks at the end of a
+// wait-for chain of L processes and is unblocked again, over and over, with cycle checks on and
+// off. On a semaphore the block is semaphoreP and the unblock semaphoreCancelWait. On a message
+// it is what a blocked send and its reply do to the PCBs: the message queued, the sender kept
+// on the receiver's reply waiters with an edge to it, and both undone. Each check follows L
+// edges however many processes there are, which the runs with N bystander processes show.
+
+#define BENCH_BLOCKS 200000L
+#define BENCH_MAX_CHAIN 256
+#define BENCH_BYSTANDERS 65536
+
+// chain[i] holds semaphores[i] and, past the first, waits on semaphores[i - 1]
+static PCB *chain[BENCH_MAX_CHAIN];
+static Semaphore semaphores[BENCH_MAX_CHAIN];
+
+static void build_chain()
+{
+    for (int i = 0; i < BENCH_MAX_CHAIN; i++)
+    {
+        chain[i] = Bench_newProcess(1);
+        initializeSemaphore(&semaphores[i], 1);
+        semaphoreP(&semaphores[i], chain[i]);
+        if (i > 0)
+        {
+            semaphoreP(&semaphores[i - 1], chain[i]);
+        }
+    }
+}
+
+// Blocks waiter on the semaphore held by the last of length chained processes and cancels the
+// wait, blocks times over
+static void semaphore_churn(PCB *waiter, int length, long blocks)
+{
+    Semaphore *semaphore = &semaphores[length - 1];
+    for (long i = 0; i < blocks; i++)
+    {
+        semaphoreP(semaphore, waiter);
+        semaphoreCancelWait(waiter);
+    }
+}
+
+// Sends from waiter to the last of length chained processes, blocking for the reply, and
+// undoes the send as the reply would, blocks times over
+static void message_churn(PCB *waiter, int length, long blocks)
+{
+    PCB *receiver = chain[length - 1];
+    char buffer[MAX_MESSAGE_LENGTH];
+    int senderPid;
+    for (long i = 0; i < blocks; i++)
+    {
+        sendMessage(receiver, "request", waiter->pid);
+        waiter->senderPid = receiver->pid;
+        processQueueAppend(&receiver->replyWaiters, waiter);
+        Deadlock_waitForProcess(waiter, receiver->pid);
+
+        receiveMessage(receiver, buffer, &senderPid);
+        processQueueRemove(waiter);
+        waiter->senderPid = -1;
+        Deadlock_clearWait(waiter);
+    }
+}
+
+// Times both kinds of churn at each chain length with checks on and off. Returns false if the
+// detector followed other than L edges per check.
+static bool run_lengths(PCB *waiter)
+{
+    static const int lengths[] = {1, 16, BENCH_MAX_CHAIN};
+    char label[64];
+    for (int l = 0; l < (int)(sizeof(lengths) / sizeof(lengths[0])); l++)
+    {
+        int length = lengths[l];
+        for (int checking = 1; checking >= 0; checking--)
+        {
+            Deadlock_setChecking(checking);
+            const char *mode = checking ? "on" : "off";
+            long expected = checking ? 2 * BENCH_BLOCKS * length : 0;
+            long edges = Deadlock_edgesVisited();
+
+            double start = Bench_now();
+            semaphore_churn(waiter, length, BENCH_BLOCKS);
+            double seconds = Bench_now() - start;
+            snprintf(label, sizeof(label), "N=%d L=%d semaphore, checks %s", PidTable_count(), length, mode);
+            Bench_report(label, BENCH_BLOCKS, seconds);
+
+            start = Bench_now();
+            message_churn(waiter, length, BENCH_BLOCKS);
+            seconds = Bench_now() - start;
+            snprintf(label, sizeof(label), "N=%d L=%d message, checks %s", PidTable_count(), length, mode);
+            Bench_report(label, BENCH_BLOCKS, seconds);
+
+            if (Deadlock_edgesVisited() - edges != expected || Deadlock_cycleCount() != 0)
+            {
+                fprintf(stderr, "L=%d: %ld edges followed, expected %ld.\n", length,
+                        Deadlock_edgesVisited() - edges, expected);
+                return false;
+            }
+        }
+    }
+    Deadlock_setChecking(true);
+    return true;
+}
+
+int main()
+{
+    if (!Bench_boot(BENCH_MAX_CHAIN + BENCH_BYSTANDERS + 8))
+    {
+        fprintf(stderr, "Failed to start the simulator.\n");
+        return 1;
+    }
+    semaphoreSetPriorityInheritance(false); // Its walk along the chain is not what is timed
+    build_chain();
+    PCB *waiter = Bench_newProcess(1);
+    if (!run_lengths(waiter))
+    {
+        return 1;
+    }
+
+    for (int i = 0; i < BENCH_BYSTANDERS; i++)
+    {
+        Bench_newProcess(1);
+    }
+    return run_lengths(waiter) ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#include "bench.h"
+#include "commands.h"
+#include "pidtable.h"
+#include <stdio.h>
+#include <string.h>
+
+// Fork latency against the size of the forking process's state: a process with all three
+// state blocks (PcbStateBlock) of S bytes forks a child and kills it again. The child shares
+// the blocks copy-on-write, so this should not grow with S. Writing every block of the child
+// before killing it forces the copies, which is what an eager fork would pay up front. Each
+// run checks the number of copies made (Cow_copyCount) and that the parent's state is unchanged.
+
+#define BENCH_PARENT_BYTE 0x5a
+#define BENCH_CHILD_BYTE 0xa5
+
+// Forks the running process and kills the child, count times. If write is set the child first
+// writes the first byte of every block. Returns false if a copy is missing or leaked into the
+// parent.
+static bool fork_and_kill(PCB *parent, long count, bool write, double *seconds)
+{
+    long copiesBefore = Cow_copyCount();
+    double start = Bench_now();
+    for (long i = 0; i < count; i++)
+    {
+        int childPid = Commands_Fork();
+        PCB *child = PidTable_lookup(childPid);
+        if (child == NULL)
+        {
+            return false;
+        }
+        for (int block = 0; write && block < PCB_NUM_STATE_BLOCKS; block++)
+        {
+            unsigned char *data = writePCBState(child, (PcbStateBlock)block, 0);
+            if (data == NULL)
+            {
+                return false;
+            }
+            data[0] = BENCH_CHILD_BYTE;
+        }
+        Commands_Kill(childPid);
+    }
+    *seconds = Bench_now() - start;
+
+    long expectedCopies = write ? count * PCB_NUM_STATE_BLOCKS : 0;
+    if (Cow_copyCount() - copiesBefore != expectedCopies)
+    {
+        fprintf(stderr, "Made %ld state copies, expected %ld.\n", Cow_copyCount() - copiesBefore, expectedCopies);
+        return false;
+    }
+    for (int block = 0; block < PCB_NUM_STATE_BLOCKS; block++)
+    {
+        const unsigned char *data = readPCBState(parent, (PcbStateBlock)block);
+        if (data != NULL && (data[0] != BENCH_PARENT_BYTE || parent->stateBlocks[block]->refCount != 1))
+        {
+            fprintf(stderr, "The parent's state changed when its child wrote to it.\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    if (!Bench_boot(64))
+    {
+        fprintf(stderr, "Failed to start the simulator.\n");
+        return 1;
+    }
+    char label[64];
+    double seconds;
+
+    static const size_t sizes[] = {0, 4096, 65536, 1048576};
+    for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+    {
+        size_t size = sizes[s];
+        long forks = size >= 65536 ? 1000 : 100000;
+
+        PCB *parent = Bench_newProcess(1);
+        for (int block = 0; size > 0 && block < PCB_NUM_STATE_BLOCKS; block++)
+        {
+            memset(writePCBState(parent, (PcbStateBlock)block, size), BENCH_PARENT_BYTE, size);
+        }
+        Scheduler_setCurrentProcess(parent);
+
+        if (!fork_and_kill(parent, forks, false, &seconds))
+        {
+            return 1;
+        }
+        snprintf(label, sizeof(label), "S=%zu fork + kill", size);
+        Bench_report(label, forks, seconds);
+
+        if (size > 0)
+        {
+            if (!fork_and_kill(parent, forks, true, &seconds))
+            {
+                return 1;
+            }
+            snprintf(label, sizeof(label), "S=%zu fork + write every block + kill", size);
+            Bench_report(label, forks, seconds);
+        }
+
+        Commands_Exit();
+    }
+    return 0;
+}
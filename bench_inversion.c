@@ -0,0 +1,94 @@
+#include "bench.h"
+#include "commands.h"
+#include "pidtable.h"
+#include "program.h"
+#include "semaphore.h"
+#include <stdio.h>
+
+// The classic priority inversion, through the same commands the shell runs: a low-priority
+// worker (priority 2) takes a semaphore, a high-priority worker (priority 0) blocks on it, and S
+// medium-priority processes (priority 1) compute for BENCH_SPIN ticks each. Without priority
+// inheritance the low worker cannot run to release the semaphore until the medium ones are done;
+// with it, the low worker runs at priority 0 and the high one gets the semaphore a tick later.
+// Reports the quanta counted as inversion and the ticks the high worker took to finish, per
+// scenario, with inheritance on and off.
+
+#define BENCH_ROUNDS 2000
+#define BENCH_SPIN 20
+#define BENCH_MAX_SPINNERS 4
+#define BENCH_SEMAPHORE 0
+// Steps after which a scenario counts as stuck
+#define BENCH_MAX_STEPS 10000
+
+// Runs one scenario with spinners medium processes and adds the ticks until the high worker
+// finished to *ticks. Returns false if the processes did not all finish.
+static bool run_scenario(int spinners, long *ticks)
+{
+    Commands_CreateProgramProcess(2, "worker", BENCH_SEMAPHORE, 1);
+    Commands_Quantum(); // The low worker runs
+    Commands_RunPrograms(1); // and takes the semaphore
+
+    long start = Scheduler_getTime();
+    int high = Commands_CreateProgramProcess(0, "worker", BENCH_SEMAPHORE, 1);
+    for (int i = 0; i < spinners; i++)
+    {
+        Commands_CreateProgramProcess(1, "spin", BENCH_SPIN, 0);
+    }
+    for (int step = 0; step < BENCH_MAX_STEPS && Program_count() > 0; step++)
+    {
+        if (Commands_RunPrograms(1) == 0)
+        {
+            return false;
+        }
+        if (high > 0 && PidTable_lookup(high) == NULL)
+        {
+            *ticks += Scheduler_getTime() - start;
+            high = -1;
+        }
+    }
+    return high < 0 && Program_count() == 0;
+}
+
+int main()
+{
+    if (!Bench_boot(BENCH_MAX_SPINNERS + 4))
+    {
+        fprintf(stderr, "Failed to start the simulator.\n");
+        return 1;
+    }
+    Commands_NewSemaphore(BENCH_SEMAPHORE, 1);
+    char label[64];
+
+    static const int spinnerCounts[] = {1, BENCH_MAX_SPINNERS};
+    for (int s = 0; s < (int)(sizeof(spinnerCounts) / sizeof(spinnerCounts[0])); s++)
+    {
+        for (int inheritance = 1; inheritance >= 0; inheritance--)
+        {
+            int spinners = spinnerCounts[s];
+            Commands_PriorityInheritance(inheritance);
+            long inversion = semaphoreInversionQuanta();
+            long ticks = 0;
+
+            double start = Bench_now();
+            for (int round = 0; round < BENCH_ROUNDS; round++)
+            {
+                if (!run_scenario(spinners, &ticks))
+                {
+                    fprintf(stderr, "S=%d: a scenario did not finish.\n", spinners);
+                    return 1;
+                }
+            }
+            double seconds = Bench_now() - start;
+            inversion = semaphoreInversionQuanta() - inversion;
+
+            const char *mode = inheritance ? "on" : "off";
+            snprintf(label, sizeof(label), "S=%d inheritance %s (per scenario)", spinners, mode);
+            Bench_report(label, BENCH_ROUNDS, seconds);
+            snprintf(label, sizeof(label), "S=%d inheritance %s inversion", spinners, mode);
+            fprintf(stderr, "%-48s %10.1f quanta\n", label, (double)inversion / BENCH_ROUNDS);
+            snprintf(label, sizeof(label), "S=%d inheritance %s high worker done", spinners, mode);
+            fprintf(stderr, "%-48s %10.1f ticks\n", label, (double)ticks / BENCH_ROUNDS);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,254 @@
+#include "bench.h"
+#include "list.h"
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// The list.h backends on synthetic replays of the access patterns a kernel makes of a list,
+// built once against each backend (bench_list_node and bench_list_ring) so their lines can be
+// compared. The simulator's own ready queues and mailboxes no longer use lists, so these are
+// stand-ins for them rather than traces taken from it:
+// - Scheduler: ready queues at a few priorities, with the first item of one taken and appended
+//   again as a round-robin tick does, and every so often an item searched for and taken out of
+//   the middle of its queue as a kill does.
+// - Mailbox: one FIFO with the oldest item taken and a new one appended, and every so often the
+//   oldest item from one sender searched for and taken as a selective receive does.
+// - Scan: walking a full list from the first item to the last.
+// Each trace runs with N items in the lists, from the default LIST_MAX_NUM_NODES cap up to far
+// more than fits in cache, so the growth of the time per operation with N shows the cost of
+// cache misses. Where the kernel lets a process count its own last-level cache misses they are
+// reported too.
+
+#ifdef LIST_BACKEND_RING
+#define BENCH_BACKEND "ring"
+#else
+#define BENCH_BACKEND "node"
+#endif
+
+// The makefile raises LIST_MAX_NUM_NODES for these builds so N can grow past the default cap
+#define BENCH_DEFAULT_CAP 100
+#define BENCH_OPERATIONS 4000000L
+#define BENCH_QUEUES 4
+// One operation in this many is a search and remove from the middle
+#define BENCH_SEARCH_PERIOD 16
+#define BENCH_SENDERS 8
+
+#if LIST_MAX_NUM_NODES < BENCH_DEFAULT_CAP
+#error "bench_list needs at least the default LIST_MAX_NUM_NODES"
+#endif
+
+static int items[LIST_MAX_NUM_NODES];
+
+static bool matches(void *item, void *key)
+{
+    return *(int *)item == *(int *)key;
+}
+
+static bool from_sender(void *item, void *sender)
+{
+    return *(int *)item % BENCH_SENDERS == *(int *)sender;
+}
+
+// Opens a counter of this process's last-level cache misses, -1 if it cannot be had
+static int open_miss_counter()
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void start_counting(int counter)
+{
+    if (counter >= 0)
+    {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+// Prints the time per operation, and the misses counted since start_counting if there is a
+// counter
+static void report(int counter, const char *label, long operations, double seconds)
+{
+    Bench_report(label, operations, seconds);
+    long long misses;
+    if (counter < 0)
+    {
+        return;
+    }
+    ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(counter, &misses, sizeof(misses)) == sizeof(misses))
+    {
+        fprintf(stderr, "%-48s %10.3f misses/op\n", label, (double)misses / operations);
+    }
+}
+
+// Runs the scheduler trace over count items. Returns false if a queue came up short.
+static bool scheduler_trace(List **queues, int count, long operations)
+{
+    for (long i = 0; i < operations; i++)
+    {
+        if (i % BENCH_SEARCH_PERIOD == 0)
+        {
+            // Keys spread over all the items, however few searches there are
+            int key = (int)((unsigned long)i * 2654435761UL % (unsigned long)count);
+            List *queue = queues[key % BENCH_QUEUES];
+            List_first(queue);
+            void *item = List_search(queue, matches, &key);
+            if (item == NULL || List_remove(queue) != item || List_append(queue, item) != LIST_SUCCESS)
+            {
+                return false;
+            }
+            continue;
+        }
+        List *queue = queues[i % BENCH_QUEUES]; // Stands in for the highest one ready
+        void *item = List_first(queue);
+        if (item == NULL || List_remove(queue) != item || List_append(queue, item) != LIST_SUCCESS)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs the mailbox trace. Returns false if the mailbox came up short.
+static bool mailbox_trace(List *mailbox, long operations)
+{
+    for (long i = 0; i < operations; i++)
+    {
+        void *item;
+        if (i % BENCH_SEARCH_PERIOD == 0)
+        {
+            int sender = (int)(i * 7 % BENCH_SENDERS);
+            List_first(mailbox);
+            item = List_search(mailbox, from_sender, &sender);
+        }
+        else
+        {
+            item = List_first(mailbox);
+        }
+        if (item == NULL || List_remove(mailbox) != item || List_append(mailbox, item) != LIST_SUCCESS)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs the scan trace, returning the number of items visited
+static long scan_trace(List *list, long operations)
+{
+    long visited = 0;
+    while (visited < operations)
+    {
+        for (void *item = List_first(list); item != NULL; item = List_next(list))
+        {
+            visited++;
+        }
+    }
+    return visited;
+}
+
+// Runs the three traces with count items. Returns false if one of them failed.
+static bool run_traces(int counter, int count)
+{
+    char label[64];
+    List *queues[BENCH_QUEUES];
+    for (int q = 0; q < BENCH_QUEUES; q++)
+    {
+        queues[q] = List_create();
+    }
+    for (int i = 0; i < count; i++)
+    {
+        List_append(queues[i % BENCH_QUEUES], &items[i]);
+    }
+    // Each search walks a quarter of the items on average, so there are fewer operations as
+    // they grow
+    long operations = BENCH_OPERATIONS / (count / BENCH_DEFAULT_CAP + 1);
+    start_counting(counter);
+    double start = Bench_now();
+    bool succeeded = scheduler_trace(queues, count, operations);
+    double seconds = Bench_now() - start;
+    for (int q = 0; q < BENCH_QUEUES; q++)
+    {
+        List_free(queues[q], NULL);
+    }
+    if (!succeeded)
+    {
+        fprintf(stderr, "N=%d: a ready queue lost a process.\n", count);
+        return false;
+    }
+    snprintf(label, sizeof(label), "%s N=%d: scheduler ready queues", BENCH_BACKEND, count);
+    report(counter, label, operations, seconds);
+
+    List *mailbox = List_create();
+    for (int i = 0; i < count; i++)
+    {
+        List_append(mailbox, &items[i]);
+    }
+    start_counting(counter);
+    start = Bench_now();
+    succeeded = mailbox_trace(mailbox, BENCH_OPERATIONS);
+    seconds = Bench_now() - start;
+    if (!succeeded)
+    {
+        fprintf(stderr, "N=%d: the mailbox lost a message.\n", count);
+        List_free(mailbox, NULL);
+        return false;
+    }
+    snprintf(label, sizeof(label), "%s N=%d: mailbox FIFO", BENCH_BACKEND, count);
+    report(counter, label, BENCH_OPERATIONS, seconds);
+
+    start_counting(counter);
+    start = Bench_now();
+    long visited = scan_trace(mailbox, BENCH_OPERATIONS);
+    seconds = Bench_now() - start;
+    snprintf(label, sizeof(label), "%s N=%d: scan (per item)", BENCH_BACKEND, count);
+    report(counter, label, visited, seconds);
+    List_free(mailbox, NULL);
+    return true;
+}
+
+int main()
+{
+    if (!Bench_boot(64))
+    {
+        fprintf(stderr, "Failed to start the simulator.\n");
+        return 1;
+    }
+    for (int i = 0; i < LIST_MAX_NUM_NODES; i++)
+    {
+        items[i] = i;
+    }
+    int counter = open_miss_counter();
+    if (counter < 0)
+    {
+        fprintf(stderr, "%s: no cache miss counter here; compare ns/op as N grows instead.\n", BENCH_BACKEND);
+    }
+
+    // The default cap less a few nodes, then 4 KB, 256 KB and 32 MB of ring slots, or three
+    // times that in nodes
+    static const int counts[] = {BENCH_DEFAULT_CAP - 4, 512, 32768, 1 << 22};
+    for (int c = 0; c < (int)(sizeof(counts) / sizeof(counts[0])); c++)
+    {
+        if (counts[c] <= LIST_MAX_NUM_NODES && !run_traces(counter, counts[c]))
+        {
+            return 1;
+        }
+    }
+
+    if (counter >= 0)
+    {
+        close(counter);
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "bench.h"
+#include <stdio.h>
+
+// Fan-out to 10000 recipients: ROUNDS messages sent to every recipient one by one with
+// sendMessage, which copies the content into each mailbox, against multicastMessage, which
+// queues one shared payload in all of them. Reports the time per delivered message and the
+// payload memory held while the messages are queued.
+
+#define BENCH_RECIPIENTS 10000
+#define BENCH_ROUNDS 32 // Fits the default mailbox capacity
+#define BENCH_REPEATS 10
+
+static PCB *recipients[BENCH_RECIPIENTS];
+
+// Empties every mailbox and checks each got every message
+static bool drain()
+{
+    static Message out[BENCH_ROUNDS];
+    bool complete = true;
+    for (int i = 0; i < BENCH_RECIPIENTS; i++)
+    {
+        complete = receiveMessages(recipients[i], out, BENCH_ROUNDS) == BENCH_ROUNDS && complete;
+    }
+    return complete && Payload_liveCount() == 0;
+}
+
+int main()
+{
+    if (!Bench_boot(BENCH_RECIPIENTS + 1))
+    {
+        fprintf(stderr, "Failed to start the simulator.\n");
+        return 1;
+    }
+    for (int i = 0; i < BENCH_RECIPIENTS; i++)
+    {
+        recipients[i] = Bench_newProcess(1);
+    }
+    const char *message = "multicast to every recipient";
+    int senderPid = 1;
+
+    double unicastSeconds = 0;
+    double multicastSeconds = 0;
+    long unicastBytes = 0;
+    long multicastBytes = 0;
+    for (int repeat = 0; repeat < BENCH_REPEATS; repeat++)
+    {
+        double start = Bench_now();
+        for (int round = 0; round < BENCH_ROUNDS; round++)
+        {
+            for (int i = 0; i < BENCH_RECIPIENTS; i++)
+            {
+                sendMessage(recipients[i], message, senderPid);
+            }
+        }
+        unicastSeconds += Bench_now() - start;
+        unicastBytes = Payload_liveBytes();
+        if (!drain())
+        {
+            fprintf(stderr, "A recipient missed a copied message.\n");
+            return 1;
+        }
+
+        start = Bench_now();
+        for (int round = 0; round < BENCH_ROUNDS; round++)
+        {
+            multicastMessage(recipients, BENCH_RECIPIENTS, message, senderPid);
+        }
+        multicastSeconds += Bench_now() - start;
+        multicastBytes = Payload_liveBytes();
+        if (!drain())
+        {
+            fprintf(stderr, "A recipient missed a multicast message.\n");
+            return 1;
+        }
+    }
+
+    long deliveries = (long)BENCH_REPEATS * BENCH_ROUNDS * BENCH_RECIPIENTS;
+    Bench_report("N=10000 copied to each (per delivery)", deliveries, unicastSeconds);
+    Bench_report("N=10000 multicast (per delivery)", deliveries, multicastSeconds);
+    Bench_reportBytes("N=10000 copied to each, payloads queued", unicastBytes);
+    Bench_reportBytes("N=10000 multicast, payloads queued", multicastBytes);
+    return 0;
+}
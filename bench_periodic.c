@@ -0,0 +1,81 @@
+#include "bench.h"
+#include "commands.h"
+#include "edf.h"
+#include <stdio.h>
+
+// Periodic real-time tasks under EDF: N tasks with periods spread over a range and budgets
+// adding up to utilization U run alongside BENCH_BACKGROUND ordinary processes for
+// BENCH_TICKS timer ticks. Reports the cost of a tick and the deadline misses, which EDF keeps
+// at zero up to U = 100%. Each set also checks that admission refuses a task beyond 100%.
+
+#define BENCH_TICKS 200000L
+#define BENCH_BACKGROUND 4
+#define BENCH_MAX_TASKS 512
+
+int main()
+{
+    if (!Bench_boot(BENCH_MAX_TASKS + BENCH_BACKGROUND + 2))
+    {
+        fprintf(stderr, "Failed to start the simulator.\n");
+        return 1;
+    }
+    for (int i = 0; i < BENCH_BACKGROUND; i++)
+    {
+        Scheduler_scheduleProcess(Bench_newProcess(1));
+    }
+    static int pids[BENCH_MAX_TASKS];
+    char label[64];
+
+    static const int taskCounts[] = {8, 64, BENCH_MAX_TASKS};
+    static const int utilizations[] = {50, 90, 100};
+    for (int t = 0; t < (int)(sizeof(taskCounts) / sizeof(taskCounts[0])); t++)
+    {
+        for (int u = 0; u < (int)(sizeof(utilizations) / sizeof(utilizations[0])); u++)
+        {
+            int tasks = taskCounts[t];
+            int percent = utilizations[u];
+            for (int i = 0; i < tasks; i++)
+            {
+                // Periods of 2 to 9 times the task count keep every budget at least one quantum
+                int period = tasks * (2 + i % 8);
+                int budget = percent * period / (100 * tasks);
+                pids[i] = Commands_CreateRealTimeProcess(budget, period);
+                if (pids[i] < 0)
+                {
+                    fprintf(stderr, "N=%d U=%d%%: task %d was not admitted.\n", tasks, percent, i);
+                    return 1;
+                }
+            }
+            long utilization = Edf_utilization();
+            if (utilization + EDF_FULL_UTILIZATION / tasks > EDF_FULL_UTILIZATION &&
+                Commands_CreateRealTimeProcess(1, tasks) >= 0)
+            {
+                fprintf(stderr, "N=%d U=%d%%: a task beyond 100%% utilization was admitted.\n", tasks, percent);
+                return 1;
+            }
+
+            long missesBefore = Edf_deadlineMisses();
+            double start = Bench_now();
+            for (long tick = 0; tick < BENCH_TICKS; tick++)
+            {
+                Commands_Quantum();
+            }
+            double seconds = Bench_now() - start;
+            long misses = Edf_deadlineMisses() - missesBefore;
+
+            snprintf(label, sizeof(label), "N=%d U=%ld.%ld%% tick, %ld deadline misses", tasks,
+                     utilization / 10000, utilization / 1000 % 10, misses);
+            Bench_report(label, BENCH_TICKS, seconds);
+            if (misses > 0)
+            {
+                fprintf(stderr, "EDF missed deadlines at or below 100%% utilization.\n");
+                return 1;
+            }
+            for (int i = 0; i < tasks; i++)
+            {
+                Commands_Kill(pids[i]);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "bench.h"
+#include "commands.h"
+#include <stdio.h>
+
+// Send/Reply round trips between a client and a server, through the same commands the shell
+// runs. With equal priorities the server is blocked in Receive when the client sends, so the
+// message and the CPU are handed to it directly; the reply then goes through the ready queue
+// and the server's next Receive switches back. With a more urgent client the request goes
+// through the server's mailbox and ready queue instead, and the reply hands the CPU straight
+// back. Each round trip is Send, Reply and Receive.
+
+#define BENCH_ROUND_TRIPS 2000000L
+
+// Runs round trips from client to server, checking the client runs again after each.
+// Returns false if a round trip went wrong.
+static bool ping_pong(PCB *client, PCB *server, bool serverWaits, double *seconds)
+{
+    double start = Bench_now();
+    for (long i = 0; i < BENCH_ROUND_TRIPS; i++)
+    {
+        if (Commands_Send(server->pid, "ping") != 0 || Scheduler_getCurrentProcess() != server)
+        {
+            return false;
+        }
+        if (!serverWaits && Commands_Receive() != 0)
+        {
+            return false;
+        }
+        Commands_Reply(client->pid, "pong");
+        if (serverWaits)
+        {
+            Commands_Receive(); // Blocks the server; the client runs
+        }
+        if (Scheduler_getCurrentProcess() != client)
+        {
+            return false;
+        }
+    }
+    *seconds = Bench_now() - start;
+    return true;
+}
+
+int main()
+{
+    if (!Bench_boot(64))
+    {
+        fprintf(stderr, "Failed to start the simulator.\n");
+        return 1;
+    }
+    double seconds;
+
+    // Equal priorities: the server waits in Receive for every request
+    PCB *client = Bench_newProcess(1);
+    PCB *server = Bench_newProcess(1);
+    Scheduler_setCurrentProcess(server);
+    Commands_Receive();
+    Scheduler_setCurrentProcess(client);
+    if (!ping_pong(client, server, true, &seconds))
+    {
+        fprintf(stderr, "A direct handoff round trip went wrong.\n");
+        return 1;
+    }
+    Bench_report("round trip, server waiting in Receive", BENCH_ROUND_TRIPS, seconds);
+
+    // A more urgent client: the server is ready, not receiving, when each request arrives
+    Commands_Kill(server->pid);
+    Commands_Exit();
+    client = Bench_newProcess(0);
+    server = Bench_newProcess(1);
+    Scheduler_scheduleProcess(server);
+    Scheduler_setCurrentProcess(client);
+    if (!ping_pong(client, server, false, &seconds))
+    {
+        fprintf(stderr, "A queued round trip went wrong.\n");
+        return 1;
+    }
+    Bench_report("round trip, request queued for a ready server", BENCH_ROUND_TRIPS, seconds);
+    return 0;
+}
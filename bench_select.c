@@ -0,0 +1,120 @@
+#include "bench.h"
+#include <stdio.h>
+
+// Selective receive from a deep mailbox: D messages from S senders, with S/8 tags, are kept
+// queued in one mailbox while the oldest message from one sender (receiveMessageFrom), or with
+// one tag (receiveTaggedMessage), is taken and replaced by sendTaggedMessage. The indexes make
+// each take independent of D and S; receiving the oldest message overall is the baseline.
+
+#define BENCH_RECEIVES 1000000L
+#define BENCH_MAX_DEPTH 16384
+
+// Sender PIDs are only keys in the mailbox here, so they need no processes
+#define BENCH_FIRST_SENDER 1000
+
+static int tag_of(int sender, int senders)
+{
+    return sender % (senders / 8 > 0 ? senders / 8 : 1);
+}
+
+// Fills the mailbox with depth messages from senders senders in turn
+static void fill(PCB *receiver, int depth, int senders)
+{
+    for (int i = 0; i < depth; i++)
+    {
+        int sender = i % senders;
+        sendTaggedMessage(receiver, "queued message", BENCH_FIRST_SENDER + sender, tag_of(sender, senders));
+    }
+}
+
+static void drain(PCB *receiver)
+{
+    char buffer[MAX_MESSAGE_LENGTH];
+    int senderPid;
+    while (receiveMessage(receiver, buffer, &senderPid))
+    {
+    }
+}
+
+int main()
+{
+    if (!Bench_boot(64))
+    {
+        fprintf(stderr, "Failed to start the simulator.\n");
+        return 1;
+    }
+    PCB *receiver = Bench_newProcess(1);
+    setMailboxCapacity(receiver, BENCH_MAX_DEPTH);
+
+    char buffer[MAX_MESSAGE_LENGTH];
+    int senderPid;
+    char label[64];
+
+    static const int depths[] = {64, 1024, BENCH_MAX_DEPTH};
+    static const int senderCounts[] = {8, 512};
+    for (int d = 0; d < (int)(sizeof(depths) / sizeof(depths[0])); d++)
+    {
+        for (int s = 0; s < (int)(sizeof(senderCounts) / sizeof(senderCounts[0])); s++)
+        {
+            int depth = depths[d];
+            int senders = senderCounts[s];
+            long missed = 0;
+            if (depth < senders)
+            {
+                continue; // Every sender needs a message queued
+            }
+
+            fill(receiver, depth, senders);
+            double start = Bench_now();
+            for (long i = 0; i < BENCH_RECEIVES; i++)
+            {
+                int sender = (int)(i % senders);
+                if (!receiveMessage(receiver, buffer, &senderPid))
+                {
+                    missed++;
+                }
+                sendTaggedMessage(receiver, "queued message", BENCH_FIRST_SENDER + sender, tag_of(sender, senders));
+            }
+            snprintf(label, sizeof(label), "D=%d S=%d oldest message", depth, senders);
+            Bench_report(label, BENCH_RECEIVES, Bench_now() - start);
+            drain(receiver);
+
+            fill(receiver, depth, senders);
+            start = Bench_now();
+            for (long i = 0; i < BENCH_RECEIVES; i++)
+            {
+                int sender = (int)((i * 7) % senders); // Not the order they were queued in
+                if (!receiveMessageFrom(receiver, BENCH_FIRST_SENDER + sender, buffer))
+                {
+                    missed++;
+                }
+                sendTaggedMessage(receiver, "queued message", BENCH_FIRST_SENDER + sender, tag_of(sender, senders));
+            }
+            snprintf(label, sizeof(label), "D=%d S=%d from one sender", depth, senders);
+            Bench_report(label, BENCH_RECEIVES, Bench_now() - start);
+            drain(receiver);
+
+            fill(receiver, depth, senders);
+            start = Bench_now();
+            for (long i = 0; i < BENCH_RECEIVES; i++)
+            {
+                int tag = tag_of((int)((i * 7) % senders), senders);
+                if (!receiveTaggedMessage(receiver, tag, buffer, &senderPid))
+                {
+                    missed++;
+                }
+                sendTaggedMessage(receiver, "queued message", senderPid, tag);
+            }
+            snprintf(label, sizeof(label), "D=%d S=%d with one tag", depth, senders);
+            Bench_report(label, BENCH_RECEIVES, Bench_now() - start);
+            drain(receiver);
+
+            if (missed > 0)
+            {
+                fprintf(stderr, "D=%d S=%d: %ld receives found no message.\n", depth, senders, missed);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "bench.h"
+#include "commands.h"
+#include "device.h"
+#include "pidtable.h"
+#include "scheduler.h"
+#include "snapshot.h"
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Saving and restoring a snapshot of BENCH_PROCESSES ready processes. A child process creates
+// them through the same command the shell runs and saves the snapshot; this process then starts
+// the way the simulator does with -r and restores it, as a fresh simulator would.
+
+#define BENCH_PROCESSES 1000000
+
+// Creates the processes and saves them to path. Returns false on failure.
+static bool save_processes(const char *path)
+{
+    if (!Bench_boot(BENCH_PROCESSES + 8))
+    {
+        return false;
+    }
+    for (int i = 0; i < BENCH_PROCESSES; i++)
+    {
+        if (Commands_CreateProcess(i % NUM_PRIORITIES) < 0)
+        {
+            return false;
+        }
+    }
+    double start = Bench_now();
+    if (!Snapshot_save(path, -1))
+    {
+        return false;
+    }
+    Bench_report("Save (per process)", BENCH_PROCESSES, Bench_now() - start);
+    return true;
+}
+
+int main()
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/bench_snapshot.%d", (int)getpid());
+
+    pid_t child = fork();
+    if (child == 0)
+    {
+        _exit(save_processes(path) ? 0 : 1);
+    }
+    int status;
+    if (child < 0 || waitpid(child, &status, 0) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "Failed to save the snapshot.\n");
+        unlink(path);
+        return 1;
+    }
+
+    Scheduler_init();
+    Device_init();
+    long logOffset;
+    double start = Bench_now();
+    bool restored = Snapshot_restore(path, &logOffset);
+    double seconds = Bench_now() - start;
+    unlink(path);
+    if (!restored || PidTable_count() != BENCH_PROCESSES + 1)
+    {
+        fprintf(stderr, "Failed to restore the snapshot.\n");
+        return 1;
+    }
+    Bench_report("Restore (per process)", BENCH_PROCESSES, seconds);
+    fprintf(stderr, "%-48s %10.3f s\n", "Restore (total)", seconds);
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "bench.h"
+#include "commands.h"
+#include "coroutine.h"
+#include <stdio.h>
+
+// Context switches between process bodies (program.h): a bare coroutine resumed and yielding
+// back, a coroutine created, run to its end and freed again, which should keep reusing one
+// pooled stack, and a full program step of two processes taking turns, where each switch also
+// goes through a timer tick and the scheduler.
+
+#define BENCH_SWITCHES 20000000L
+#define BENCH_CREATES 2000000L
+#define BENCH_STEPS 2000000L
+
+static void yield_forever(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        Coroutine_yield();
+    }
+}
+
+static void return_at_once(void *arg)
+{
+    (void)arg;
+}
+
+int main()
+{
+    if (!Bench_boot(64))
+    {
+        fprintf(stderr, "Failed to start the simulator.\n");
+        return 1;
+    }
+
+    Coroutine *coroutine = Coroutine_create(yield_forever, NULL);
+    if (coroutine == NULL)
+    {
+        fprintf(stderr, "Failed to create a coroutine.\n");
+        return 1;
+    }
+    double start = Bench_now();
+    for (long i = 0; i < BENCH_SWITCHES / 2; i++)
+    {
+        Coroutine_resume(coroutine);
+    }
+    Bench_report("coroutine switch (resume or yield)", BENCH_SWITCHES, Bench_now() - start);
+    Coroutine_free(coroutine);
+
+    long mappedBefore = Coroutine_getStats().stacksMapped;
+    start = Bench_now();
+    for (long i = 0; i < BENCH_CREATES; i++)
+    {
+        coroutine = Coroutine_create(return_at_once, NULL);
+        Coroutine_resume(coroutine);
+        Coroutine_free(coroutine);
+    }
+    Bench_report("coroutine create + run to end + free", BENCH_CREATES, Bench_now() - start);
+    if (Coroutine_getStats().stacksMapped != mappedBefore)
+    {
+        fprintf(stderr, "Freed stacks were not reused from the pool.\n");
+        return 1;
+    }
+
+    // Two bodies that only yield; the tick after each yield hands the CPU to the other one
+    Commands_CreateProgramProcess(1, "spin", 1 << 30, 0);
+    Commands_CreateProgramProcess(1, "spin", 1 << 30, 0);
+    Commands_Quantum();
+    start = Bench_now();
+    int steps = Commands_RunPrograms(BENCH_STEPS);
+    Bench_report("program step (body to yield, tick, next body)", steps, Bench_now() - start);
+    if (steps != BENCH_STEPS)
+    {
+        fprintf(stderr, "Programs stopped after %d of %ld steps.\n", steps, BENCH_STEPS);
+        return 1;
+    }
+    return 0;
+}
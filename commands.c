@@ -1,10 +1,26 @@
 #include "commands.h"
 #include "scheduler.h"
+#include "pidtable.h"
+#include "deadlock.h"
+#include "semaphore.h"
+#include "condition.h"
+#include "futex.h"
+#include "edf.h"
+#include "group.h"
+#include "workload.h"
+#include "device.h"
+#include "stats.h"
+#include "dump.h"
+#include "signals.h"
+#include "program.h"
+#include "coroutine.h"
+#include "snapshot.h"
 #include <stdio.h>
 #include <stdlib.h> // for malloc and free
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
 
-// Global variable to keep track of the next PID to assign
-int nextPid = 1;
 // Assuming the PID for the 'init' process is defined globally
 extern const int INIT_PROCESS_PID;
 // Assuming there is a function to get the currently running process
@@ -21,20 +37,36 @@ extern int Scheduler_removeProcess(PCB *process);
 static PCB *duplicate_pcb(const PCB *pcb);
 int get_next_pid();
 
-// Function that handles creating a new process
-int Commands_CreateProcess(int priority)
+// Creates a process that is not scheduled yet, printing why if it can't
+static PCB *new_process(int priority)
 {
     if (priority < 0 || priority >= NUM_PRIORITIES)
     {
         printf("Invalid priority level. Must be between 0 (high) and 2 (low).\n");
-        return -1;
+        return NULL;
     }
 
-    int pid = get_next_pid();               // Correctly generate and increment PID
+    int pid = get_next_pid();               // Reserve a PID from the process table
+    if (pid < 0)
+    {
+        printf("Process table is full (%d processes).\n", PidTable_capacity());
+        return NULL;
+    }
     PCB *newPcb = createPCB(pid, priority); // Use the generated PID
     if (newPcb == NULL)
     {
+        PidTable_release(pid);
         printf("Failed to create a new process.\n");
+    }
+    return newPcb;
+}
+
+// Function that handles creating a new process
+int Commands_CreateProcess(int priority)
+{
+    PCB *newPcb = new_process(priority);
+    if (newPcb == NULL)
+    {
         return -1;
     }
 
@@ -44,6 +76,100 @@ int Commands_CreateProcess(int priority)
     return newPcb->pid;
 }
 
+// Function that handles creating a process that runs a burst script: CPU, I/O, CPU, ... ticks
+int Commands_CreateScriptedProcess(int priority, int device, const char *script)
+{
+    int phases[WORKLOAD_MAX_PHASES];
+    int count = 0;
+    char *end;
+    for (long length = strtol(script, &end, 10); end != script; length = strtol(script, &end, 10))
+    {
+        if (count == WORKLOAD_MAX_PHASES)
+        {
+            count++; // Too long; rejected below
+            break;
+        }
+        phases[count++] = (int)length;
+        script = end;
+    }
+
+    PCB *newPcb = new_process(priority);
+    if (newPcb == NULL)
+    {
+        return -1;
+    }
+    if (!Workload_attach(newPcb, phases, count, device))
+    {
+        printf("Invalid workload. Need device -1 to %d and an odd number (up to %d) of positive burst lengths.\n",
+               NUM_DEVICES - 1, WORKLOAD_MAX_PHASES);
+        destroyPCB(newPcb);
+        return -1;
+    }
+    Scheduler_scheduleProcess(newPcb);
+    printf("Process created successfully with PID: %d (%d bursts)\n", newPcb->pid, (count + 1) / 2);
+    return newPcb->pid;
+}
+
+// Function that handles creating count processes with random bursts from a seeded generator
+int Commands_CreateRandomProcesses(int count, int priority, int cpuMean, int ioMean, int bursts, int device, unsigned seed)
+{
+    Workload_seed(seed);
+    for (int i = 0; i < count; i++)
+    {
+        PCB *newPcb = new_process(priority);
+        if (newPcb == NULL)
+        {
+            return -1;
+        }
+        if (!Workload_attachRandom(newPcb, cpuMean, ioMean, bursts, device))
+        {
+            printf("Invalid workload. Need positive means, 1-%d bursts and device -1 to %d.\n",
+                   (WORKLOAD_MAX_PHASES + 1) / 2, NUM_DEVICES - 1);
+            destroyPCB(newPcb);
+            return -1;
+        }
+        Scheduler_scheduleProcess(newPcb);
+    }
+    printf("Created %d processes with random workloads.\n", count);
+    return 0;
+}
+
+// Function that handles creating a periodic real-time process scheduled by earliest deadline
+int Commands_CreateRealTimeProcess(int budget, int period)
+{
+    if (budget <= 0 || period <= 0 || budget > period)
+    {
+        printf("Invalid real-time parameters. Need 0 < budget <= period.\n");
+        return -1;
+    }
+
+    int pid = get_next_pid();
+    if (pid < 0)
+    {
+        printf("Process table is full (%d processes).\n", PidTable_capacity());
+        return -1;
+    }
+    PCB *newPcb = createPCB(pid, 0);
+    if (newPcb == NULL)
+    {
+        PidTable_release(pid);
+        printf("Failed to create a new process.\n");
+        return -1;
+    }
+    // The tick in progress belongs to the running process, so the first job starts at the next one
+    if (!Edf_admit(newPcb, budget, period, Scheduler_getTime() + 1))
+    {
+        printf("Real-time process rejected: utilization would exceed 100%% (currently %ld.%02ld%%).\n",
+               Edf_utilization() / 10000, Edf_utilization() / 100 % 100);
+        destroyPCB(newPcb);
+        return -1;
+    }
+
+    Scheduler_scheduleProcess(newPcb);
+    printf("Real-time process created successfully with PID: %d (budget %d every %d quanta)\n", newPcb->pid, budget, period);
+    return newPcb->pid;
+}
+
 // Function to handle forking of the current process
 int Commands_Fork()
 {
@@ -59,20 +185,52 @@ int Commands_Fork()
         return -1;
     }
 
-    // The createPCB function should assign a new unique PID for the new process.
-    PCB *childProcess = createPCB(get_next_pid(), parentProcess->priority);
+    int childPid = get_next_pid();
+    if (childPid < 0)
+    {
+        printf("Process table is full (%d processes).\n", PidTable_capacity());
+        return -1;
+    }
+    PCB *childProcess = createPCB(childPid, parentProcess->basePriority);
     if (childProcess == NULL)
     {
+        PidTable_release(childPid);
         printf("Failed to create a new process.\n");
         return -1;
     }
 
     // Duplicate the PCB's state, excluding the PID
+    Mailbox *childMailbox = childProcess->mailbox;
     *childProcess = *parentProcess;
-    childProcess->pid = get_next_pid(); // Ensure the child gets a unique PID
+    childProcess->pid = childPid;
+    childProcess->priority = parentProcess->basePriority; // An inherited priority boost stays with the holder
 
-    // Ensure the child's message queue is a new, empty list
-    childProcess->messageQueue = List_create();
+    // Ensure the child's message queue is a new, empty mailbox
+    childProcess->mailbox = childMailbox;
+
+    // The child starts outside every wait queue, with no senders waiting on it
+    processQueueInit(&childProcess->blockedSenders);
+    processQueueInit(&childProcess->replyWaiters);
+    childProcess->pendingMessage = NULL;
+    childProcess->queue = NULL;
+    childProcess->queueNext = NULL;
+    childProcess->queuePrev = NULL;
+    childProcess->waitsForPid = -1;
+    childProcess->waitsOnSemaphore = NULL;
+    childProcess->heldSemaphoreCount = 0; // Holds are the parent's to release
+
+    // A child of a real-time process is an ordinary process until admitted on its own
+    childProcess->rtPeriod = 0;
+    childProcess->rtBudget = 0;
+    childProcess->rtDeadlineMisses = 0;
+    childProcess->rtReadyIndex = -1;
+    childProcess->rtReleaseIndex = -1;
+    childProcess->workload = NULL; // The burst script belongs to the parent
+    childProcess->pendingSignals = 0; // Signal actions are inherited, signals sent to the parent are not
+    childProcess->program = NULL;     // So is the body; the child is an ordinary process
+
+    // Share the parent's per-process state copy-on-write instead of copying it eagerly
+    sharePCBState(childProcess, parentProcess);
 
     // Schedule the child process
     Scheduler_scheduleProcess(childProcess);
@@ -81,6 +239,65 @@ int Commands_Fork()
     return childProcess->pid;
 }
 
+static const char *stateBlockNames[PCB_NUM_STATE_BLOCKS] = {"address space", "environment", "resource table"};
+
+// The running process's state block which, checking the byte offset lies within it. A block
+// that has never been written is created with PCB_STATE_BLOCK_SIZE bytes if create is set.
+static PCB *find_state_byte(int which, int offset, bool create)
+{
+    PCB *process = Scheduler_getCurrentProcess();
+    if (process == NULL || which < 0 || which >= PCB_NUM_STATE_BLOCKS)
+    {
+        printf("Invalid state block. Must be between 0 and %d.\n", PCB_NUM_STATE_BLOCKS - 1);
+        return NULL;
+    }
+    const CowBlock *block = process->stateBlocks[which];
+    size_t size = block != NULL ? block->size : create ? PCB_STATE_BLOCK_SIZE : 0;
+    if (offset < 0 || (size_t)offset >= size)
+    {
+        printf("Offset %d is outside the %zu-byte %s of process with PID %d.\n", offset, size, stateBlockNames[which],
+               process->pid);
+        return NULL;
+    }
+    return process;
+}
+
+// Implementation of the Write State command: sets one byte of a state block of the running
+// process. A block still shared with a parent or child since fork is copied first.
+int Commands_WriteState(int which, int offset, int value)
+{
+    PCB *process = find_state_byte(which, offset, true);
+    if (process == NULL)
+    {
+        return -1;
+    }
+    bool shared = process->stateBlocks[which] != NULL && process->stateBlocks[which]->refCount > 1;
+    unsigned char *data = writePCBState(process, (PcbStateBlock)which, PCB_STATE_BLOCK_SIZE);
+    if (data == NULL)
+    {
+        printf("Failed to write the %s of process with PID %d.\n", stateBlockNames[which], process->pid);
+        return -1;
+    }
+    data[offset] = (unsigned char)value;
+    printf("Process with PID %d wrote %d at offset %d of its %s%s.\n", process->pid, data[offset], offset,
+           stateBlockNames[which], shared ? ", copying it from the shared block" : "");
+    return 0;
+}
+
+// Implementation of the Read State command: prints one byte of a state block of the running process
+int Commands_ReadState(int which, int offset)
+{
+    PCB *process = find_state_byte(which, offset, false);
+    if (process == NULL)
+    {
+        return -1;
+    }
+    const unsigned char *data = readPCBState(process, (PcbStateBlock)which);
+    printf("Process with PID %d has %d at offset %d of its %s (%s copy).\n", process->pid, data[offset], offset,
+           stateBlockNames[which], process->stateBlocks[which]->refCount > 1 ? "shared" : "private");
+    return 0;
+}
+
 // Helper function that duplicates the given PCB
 static PCB *duplicate_pcb(const PCB *pcb)
 {
@@ -109,34 +326,17 @@ static PCB *duplicate_pcb(const PCB *pcb)
 
 int get_next_pid()
 {
-    return nextPid++; // Return the current value of nextPid, then increment it
+    return PidTable_alloc(); // Reuses freed PIDs under a new generation, -1 if the table is full
 }
 
-// Helper function to find a process by PID in the scheduler's queues
+// Helper function to find a process by PID; stale PIDs of killed processes are rejected
 static PCB *find_process_by_pid(int pid)
 {
-    List **priorityQueues = Scheduler_getPriorityQueues();
-    PCB *foundProcess = NULL;
-    for (int i = 0; i < NUM_PRIORITIES; i++)
-    {
-        List *queue = priorityQueues[i];
-        for (Node *node = queue->head; node != NULL; node = node->next)
-        {
-            PCB *process = (PCB *)node->item;
-            if (process->pid == pid)
-            {
-                foundProcess = process;
-                break;
-            }
-        }
-        if (foundProcess != NULL)
-        {
-            break;
-        }
-    }
-    return foundProcess;
+    return PidTable_lookup(pid);
 }
 
+static void cancel_lock_wait(PCB *process);
+
 // Implementation of the Kill command
 int Commands_Kill(int pid)
 {
@@ -147,12 +347,22 @@ int Commands_Kill(int pid)
         return -1;
     }
 
-    // Additional checks and cleanup (e.g., semaphore queues) before killing the process
-    // ...
+    // Killing the running process is the same as having it exit
+    if (processToKill == Scheduler_getCurrentProcess())
+    {
+        return Commands_Exit();
+    }
 
-    // Remove the process from the scheduler
-    int result = Scheduler_removeProcess(processToKill);
-    if (result != 0)
+    // A process killed while waiting on a semaphore gives back its place in the count
+    semaphoreCancelWait(processToKill);
+    Futex_cancelWait(processToKill);
+    cancel_lock_wait(processToKill);
+
+    // Remove the process from the scheduler; blocked processes are not in a ready queue
+    // A real-time process out of budget is ready but in no queue; removing it also ends its
+    // real-time class, so that has to be checked first
+    bool queued = processToKill->state == READY && !Edf_isRealTime(processToKill);
+    if (Scheduler_removeProcess(processToKill) != 0 && queued)
     {
         printf("Failed to remove process with PID %d from scheduler.\n", pid);
         return -1;
@@ -165,6 +375,8 @@ int Commands_Kill(int pid)
     return 0;
 }
 
+static bool simulationOver = false;
+
 int Commands_Exit() {
     PCB *currentProcess = Scheduler_getCurrentProcess();
     if (currentProcess == NULL) {
@@ -172,17 +384,8 @@ int Commands_Exit() {
         return -1;
     }
 
-    List **priorityQueues = Scheduler_getPriorityQueues(); // Retrieve the array of priority queues
-    bool areOtherProcessesActive = false;
-
-    // Check if there are other processes ready to run or blocked
-    for (int i = 0; i < NUM_PRIORITIES; i++) {
-        List *queue = priorityQueues[i];
-        if (List_count(queue) > 0 && ((PCB *)List_first(queue))->pid != INIT_PROCESS_PID) {
-            areOtherProcessesActive = true;
-            break;
-        }
-    }
+    // Check if there are other processes ready to run (init itself is never queued)
+    bool areOtherProcessesActive = Scheduler_readyCount() > 0;
     
     // Check if the current process is the 'init' process and there are no other active processes
     if (currentProcess->pid == INIT_PROCESS_PID && !areOtherProcessesActive) {
@@ -194,29 +397,31 @@ int Commands_Exit() {
         return -1;
     }
 
-    // Remove the currently running process
-    int result = Scheduler_removeProcess(currentProcess);
-    if (result != 0) {
-        printf("Failed to remove the current process with PID %d.\n", currentProcess->pid);
-        return -1;
+    // The running process is not in a ready queue, but a real-time one still leaves the EDF class
+    if (currentProcess->pid == INIT_PROCESS_PID) {
+        Scheduler_setInitProcess(NULL);
     }
+    Edf_release(currentProcess);
 
-    // Free the resources of the current process
+    // Take the process off the CPU before freeing it so the scheduler never touches the freed PCB
+    PCB *nextProcess = Scheduler_descheduleCurrentProcess(TERMINATED);
     destroyPCB(currentProcess);
 
     // Now, decide the next course of action based on the state of the system
-    PCB *nextProcess = Scheduler_getNextProcess();
     if (nextProcess) {
-        // If there's another process ready to run, schedule it
-        Scheduler_setCurrentProcess(nextProcess);
+        // If there's another process ready to run, it is already running
         printf("Process with PID %d is now running.\n", nextProcess->pid);
     } else {
         // If no other processes are ready to run, the system is idle or the simulation should terminate
         if (!areOtherProcessesActive) {
             printf("No other processes are active. Terminating simulation.\n");
-            exit(0); // Or handle the end of simulation without exiting the entire program
+            simulationOver = true; // The front end ends the program once it has closed its log
         } else {
             printf("No more processes to run; the system is idle.\n");
+            if (Deadlock_cycleCount() > 0)
+            {
+                Deadlock_printLastCycle();
+            }
             // Here you might want to handle the case where all processes are blocked and cannot proceed
             // For example, detect deadlock or wait for an event to unblock processes
         }
@@ -224,3 +429,1274 @@ int Commands_Exit() {
 
     return 0; // Return success
 }
+
+bool Commands_isSimulationOver()
+{
+    return simulationOver;
+}
+
+// Implementation of the Signal command. SIGKILL is the Kill command; any other signal is posted
+// and, if the target is the running process, delivered at once.
+int Commands_Signal(int pid, int signal)
+{
+    if (signal < 0 || signal >= NUM_SIGNALS)
+    {
+        printf("Invalid signal. Need 0-%d.\n", NUM_SIGNALS - 1);
+        return -1;
+    }
+    PCB *process = find_process_by_pid(pid);
+    if (process == NULL)
+    {
+        printf("Process with PID %d not found.\n", pid);
+        return -1;
+    }
+    if (process->pid == INIT_PROCESS_PID)
+    {
+        printf("The 'init' process does not take signals.\n");
+        return -1;
+    }
+    if (signal == SIGNAL_KILL)
+    {
+        return Commands_Kill(pid);
+    }
+
+    const char *name = Signal_name(signal);
+    switch (Signal_post(process, signal))
+    {
+    case SIGNAL_DROPPED:
+        printf("Process with PID %d ignores %s.\n", pid, name);
+        return 0;
+    case SIGNAL_WOKE:
+        printf("Process with PID %d woken early by %s.\n", pid, name);
+        return 0;
+    case SIGNAL_PENDING:
+        break;
+    }
+    if (process != Scheduler_getCurrentProcess())
+    {
+        printf("%s pending for process with PID %d.\n", name, pid);
+        return 0;
+    }
+    if (!Signal_deliver(process))
+    {
+        return Commands_Exit();
+    }
+    return 0;
+}
+
+// Function that handles choosing how a process responds to a signal
+int Commands_SetSignalAction(int pid, int signal, int action)
+{
+    static const char *actionNames[] = {"take the default action for", "handle", "ignore"};
+    PCB *process = find_process_by_pid(pid);
+    if (process == NULL)
+    {
+        printf("Process with PID %d not found.\n", pid);
+        return -1;
+    }
+    if (action < SIGNAL_DEFAULT || action > SIGNAL_IGNORE || !Signal_setAction(process, signal, action))
+    {
+        printf("Invalid signal action. Need a signal 0-%d other than %d (%s) and action 0 (default), 1 (handle) "
+               "or 2 (ignore).\n", NUM_SIGNALS - 1, SIGNAL_KILL, Signal_name(SIGNAL_KILL));
+        return -1;
+    }
+    printf("Process with PID %d will %s %s.\n", pid, actionNames[action], Signal_name(signal));
+    return 0;
+}
+
+void Commands_SignalStats()
+{
+    SignalStats stats = Signal_getStats();
+    printf("Signals: %ld posted, %ld ignored, %ld early wake-ups, %ld delivered, %ld handled, %ld terminations.\n",
+           stats.posted, stats.dropped, stats.wakeups, stats.delivered, stats.handled, stats.terminations);
+}
+
+// Counts of messages and replies delivered by direct handoff versus through the ready queues
+static long ipcHandoffCount = 0;
+static long ipcQueuedCount = 0;
+
+// Takes the running process off the CPU in the given blocked state and reports who runs next
+static void block_current_process(PCB *process, ProcessState reason)
+{
+    PCB *nextProcess = Scheduler_descheduleCurrentProcess(reason);
+    if (nextProcess)
+    {
+        printf("Process with PID %d is blocked; process with PID %d is now running.\n", process->pid, nextProcess->pid);
+    }
+    else
+    {
+        printf("Process with PID %d is blocked; no more processes to run, the system is idle.\n", process->pid);
+    }
+}
+
+int Commands_Send(int pid, const char *message)
+{
+    return Commands_SendTagged(pid, 0, message);
+}
+
+// Implementation of the Send command. The sender blocks until the receiver replies.
+// If the receiver is already blocked in a Receive that selects the message and is at least as
+// urgent as the sender, the message and the CPU are handed straight to it without a pass
+// through the ready queues.
+int Commands_SendTagged(int pid, int tag, const char *message)
+{
+    PCB *sender = Scheduler_getCurrentProcess();
+    if (sender == NULL)
+    {
+        printf("No current process to send from.\n");
+        return -1;
+    }
+    PCB *receiver = find_process_by_pid(pid);
+    if (receiver == NULL)
+    {
+        printf("Process with PID %d not found.\n", pid);
+        return -1;
+    }
+    if (receiver == sender)
+    {
+        printf("A process cannot send a message to itself.\n");
+        return -1;
+    }
+
+    bool senderBlocks = sender->pid != INIT_PROCESS_PID; // init never blocks
+    bool received = waitsForMessage(receiver, sender->pid, tag);
+    if (received && senderBlocks && receiver->priority <= sender->priority)
+    {
+        // Fast path: deliver in place and switch directly to the receiver
+        sender->senderPid = receiver->pid;
+        sender->state = BLOCKED_ON_SEND;
+        processQueueAppend(&receiver->replyWaiters, sender);
+        Deadlock_clearWait(receiver);
+        Deadlock_waitForProcess(sender, receiver->pid);
+        PCB *running = Scheduler_switchTo(receiver);
+        if (running != receiver)
+        {
+            // A pending signal terminated the receiver as it was dispatched, failing the send
+            printf("Process with PID %d is now running.\n", running->pid);
+            return -1;
+        }
+        ipcHandoffCount++;
+        Program_deliver(receiver, sender->pid, message);
+        printf("Process with PID %d received message from PID %d: %s\n", receiver->pid, sender->pid, message);
+        printf("Process with PID %d is blocked; process with PID %d is now running.\n", sender->pid, receiver->pid);
+        return 0;
+    }
+
+    if (received)
+    {
+        // The receiver is less urgent than the sender, so it has to wait for its turn
+        Deadlock_clearWait(receiver);
+        Scheduler_scheduleProcess(receiver);
+        Program_deliver(receiver, sender->pid, message);
+        printf("Process with PID %d received message from PID %d: %s\n", receiver->pid, sender->pid, message);
+    }
+    else
+    {
+        SendResult result = trySendMessage(receiver, message, sender->pid, tag);
+        if (result == SEND_MAILBOX_FULL && senderBlocks && waitForMailboxSpace(receiver, sender, message, tag))
+        {
+            // Backpressure: the sender stays blocked until the receiver drains its mailbox
+            printf("Mailbox of process with PID %d is full; message held until there is room.\n", pid);
+        }
+        else if (result != SEND_OK)
+        {
+            printf("Failed to send message to process with PID %d%s.\n", pid, result == SEND_MAILBOX_FULL ? " (mailbox full)" : "");
+            return -1;
+        }
+        else
+        {
+            printf("Message queued for process with PID %d.\n", pid);
+        }
+    }
+    ipcQueuedCount++;
+
+    if (senderBlocks)
+    {
+        // A held-back sender is already queued on the receiver and moves to its reply waiters
+        // once its message is admitted. If the receiver is destroyed, even by a signal as it is
+        // dispatched below, the send fails and the sender is rescheduled.
+        sender->senderPid = receiver->pid;
+        if (sender->queue == NULL)
+        {
+            processQueueAppend(&receiver->replyWaiters, sender);
+        }
+        Deadlock_waitForProcess(sender, pid);
+        block_current_process(sender, BLOCKED_ON_SEND);
+        if (sender->state != BLOCKED_ON_SEND)
+        {
+            return -1; // The receiver was terminated by a signal as it was dispatched
+        }
+    }
+    return 0;
+}
+
+// Takes the oldest message matching filter (see receiveMatchingMessage), blocking the running
+// process until one arrives if there is none. A receive from one sender waits for that process.
+static int receive_matching(int filter, int key)
+{
+    PCB *process = Scheduler_getCurrentProcess();
+    if (process == NULL)
+    {
+        printf("No current process to receive.\n");
+        return -1;
+    }
+    if (filter == MAILBOX_BY_SENDER && find_process_by_pid(key) == NULL)
+    {
+        printf("Process with PID %d not found.\n", key);
+        return -1;
+    }
+
+    char buffer[MAX_MESSAGE_LENGTH];
+    int senderPid;
+    if (receiveMatchingMessage(process, filter, key, buffer, &senderPid))
+    {
+        printf("Process with PID %d received message from PID %d: %s\n", process->pid, senderPid, buffer);
+        return 0;
+    }
+
+    if (process->pid == INIT_PROCESS_PID)
+    {
+        printf("No messages for the 'init' process.\n");
+        return -1;
+    }
+    process->receiveFilter = filter;
+    process->receiveKey = key;
+    if (filter == MAILBOX_BY_SENDER)
+    {
+        Deadlock_waitForProcess(process, key);
+    }
+    block_current_process(process, BLOCKED_ON_RECEIVE);
+    return 0;
+}
+
+// Implementation of the Receive command. Blocks the running process if its mailbox is empty.
+int Commands_Receive()
+{
+    return receive_matching(-1, 0);
+}
+
+// Implementation of the selective Receive commands. Messages from other senders, or with other
+// tags, stay queued for later receives.
+int Commands_ReceiveFrom(int senderPid)
+{
+    return receive_matching(MAILBOX_BY_SENDER, senderPid);
+}
+
+int Commands_ReceiveTagged(int tag)
+{
+    return receive_matching(MAILBOX_BY_TAG, tag);
+}
+
+// Implementation of the Reply command. Unblocks a sender waiting on the running process.
+// A sender more urgent than the replier gets the CPU straight away; the replier goes back to
+// the front of its ready queue.
+int Commands_Reply(int pid, const char *message)
+{
+    PCB *replier = Scheduler_getCurrentProcess();
+    if (replier == NULL)
+    {
+        printf("No current process to reply from.\n");
+        return -1;
+    }
+    PCB *sender = find_process_by_pid(pid);
+    if (sender == NULL || sender->state != BLOCKED_ON_SEND || sender->senderPid != replier->pid)
+    {
+        printf("Process with PID %d is not waiting for a reply from PID %d.\n", pid, replier->pid);
+        return -1;
+    }
+
+    sender->senderPid = -1;
+    processQueueRemove(sender);
+    Deadlock_clearWait(sender);
+    Program_deliver(sender, replier->pid, message);
+    printf("Process with PID %d received reply from PID %d: %s\n", sender->pid, replier->pid, message);
+
+    if (sender->priority < replier->priority)
+    {
+        Scheduler_preemptCurrentProcess();
+        PCB *running = Scheduler_switchTo(sender); // Not the sender if a pending signal terminated it
+        ipcHandoffCount++;
+        printf("Process with PID %d is now running.\n", running->pid);
+    }
+    else
+    {
+        Scheduler_scheduleProcess(sender);
+        ipcQueuedCount++;
+    }
+    return 0;
+}
+
+typedef struct BroadcastContext
+{
+    PCB *sender;
+    const char *message;
+    int groupId;     // Only members of this group get the message, -1 for every process
+    PCB **receivers; // Processes whose mailbox the message is queued in
+    int count;
+    int woken;       // Number of receivers unblocked with the message
+} BroadcastContext;
+
+static void broadcast_to(PCB *process, void *arg)
+{
+    BroadcastContext *context = (BroadcastContext *)arg;
+    if (process == context->sender || (context->groupId != -1 && process->groupId != context->groupId))
+    {
+        return;
+    }
+    if (waitsForMessage(process, context->sender->pid, 0))
+    {
+        printf("Process with PID %d received message from PID %d: %s\n", process->pid, context->sender->pid, context->message);
+        Deadlock_clearWait(process);
+        Scheduler_scheduleProcess(process);
+        Program_deliver(process, context->sender->pid, context->message);
+        context->woken++;
+    }
+    else
+    {
+        context->receivers[context->count++] = process;
+    }
+}
+
+// Sends the message to every other process in group groupId, or every other process if it is
+// -1. Receivers blocked in Receive get it at once; the others' mailboxes all share one copy of
+// it (multicastMessage). The sender does not block.
+static int multicast(int groupId, const char *message)
+{
+    PCB *sender = Scheduler_getCurrentProcess();
+    if (sender == NULL)
+    {
+        printf("No current process to broadcast from.\n");
+        return -1;
+    }
+
+    BroadcastContext context = {sender, message, groupId, malloc(PidTable_capacity() * sizeof(PCB *)), 0, 0};
+    if (context.receivers == NULL)
+    {
+        printf("Failed to broadcast message.\n");
+        return -1;
+    }
+    PidTable_forEach(broadcast_to, &context);
+    int queued = multicastMessage(context.receivers, context.count, message, sender->pid);
+    free(context.receivers);
+
+    printf("%s from PID %d queued for %d processes and woke %d; %d mailboxes were full.\n",
+           groupId == -1 ? "Broadcast" : "Multicast", sender->pid, queued, context.woken, context.count - queued);
+    return queued + context.woken;
+}
+
+// Implementation of the Broadcast command: every other process gets the message
+int Commands_Broadcast(const char *message)
+{
+    return multicast(-1, message);
+}
+
+// Implementation of the Multicast command: every other process in group groupId gets the message
+int Commands_Multicast(int groupId, const char *message)
+{
+    if (Group_get(groupId) == NULL)
+    {
+        printf("Invalid group ID. Must be between 0 and %d.\n", MAX_GROUPS - 1);
+        return -1;
+    }
+    return multicast(groupId, message);
+}
+
+// Function that handles changing how many messages a process's mailbox accepts. Raising it
+// lets held-back senders in; lowering it keeps the messages already queued.
+int Commands_SetMailboxCapacity(int pid, int capacity)
+{
+    PCB *process = find_process_by_pid(pid);
+    if (process == NULL)
+    {
+        printf("Process with PID %d not found.\n", pid);
+        return -1;
+    }
+    if (capacity < 1)
+    {
+        printf("Invalid mailbox capacity. Need at least 1.\n");
+        return -1;
+    }
+    setMailboxCapacity(process, capacity);
+    printf("Mailbox of process with PID %d holds up to %d messages; %d queued, %d senders held back.\n", pid,
+           capacity, Mailbox_count(process->mailbox), process->blockedSenders.count);
+    return 0;
+}
+
+// Prints how many IPC deliveries skipped the ready queues
+void Commands_IpcStats()
+{
+    printf("IPC deliveries: %ld direct handoff, %ld through the ready queues.\n", ipcHandoffCount, ipcQueuedCount);
+}
+
+// Semaphores available to processes, addressed by ID
+static Semaphore semaphores[NUM_SEMAPHORES];
+static bool semaphoreCreated[NUM_SEMAPHORES];
+
+static Semaphore *find_semaphore(int id)
+{
+    if (id < 0 || id >= NUM_SEMAPHORES || !semaphoreCreated[id])
+    {
+        printf("Semaphore %d does not exist.\n", id);
+        return NULL;
+    }
+    return &semaphores[id];
+}
+
+const Semaphore *Commands_getSemaphore(int id)
+{
+    return id >= 0 && id < NUM_SEMAPHORES && semaphoreCreated[id] ? &semaphores[id] : NULL;
+}
+
+// Implementation of the New Semaphore command
+int Commands_NewSemaphore(int id, int value)
+{
+    if (id < 0 || id >= NUM_SEMAPHORES)
+    {
+        printf("Invalid semaphore ID. Must be between 0 and %d.\n", NUM_SEMAPHORES - 1);
+        return -1;
+    }
+    if (semaphoreCreated[id] || value < 0)
+    {
+        printf("Semaphore %d %s.\n", id, semaphoreCreated[id] ? "already exists" : "needs a non-negative value");
+        return -1;
+    }
+    initializeSemaphore(&semaphores[id], value);
+    semaphoreCreated[id] = true;
+    printf("Semaphore %d created with value %d.\n", id, value);
+    return 0;
+}
+
+// Implementation of the P command on the running process
+int Commands_P(int id)
+{
+    Semaphore *semaphore = find_semaphore(id);
+    PCB *process = Scheduler_getCurrentProcess();
+    if (semaphore == NULL || process == NULL)
+    {
+        return -1;
+    }
+    if (semaphore->value <= 0 && process->pid == INIT_PROCESS_PID)
+    {
+        printf("The 'init' process cannot block on semaphore %d.\n", id);
+        return -1;
+    }
+
+    semaphoreP(semaphore, process);
+    if (process->state == BLOCKED_ON_SEMAPHORE)
+    {
+        block_current_process(process, BLOCKED_ON_SEMAPHORE);
+    }
+    else
+    {
+        printf("Process with PID %d acquired semaphore %d.\n", process->pid, id);
+    }
+    return 0;
+}
+
+// Implementation of the V command on the running process
+int Commands_V(int id)
+{
+    Semaphore *semaphore = find_semaphore(id);
+    if (semaphore == NULL)
+    {
+        return -1;
+    }
+    PCB *woken = semaphore->queue.head;
+    semaphoreV(semaphore, Scheduler_getCurrentProcess());
+    if (woken != NULL && woken->state == READY)
+    {
+        printf("Semaphore %d released; process with PID %d is ready.\n", id, woken->pid);
+    }
+    else
+    {
+        printf("Semaphore %d released.\n", id);
+    }
+    return 0;
+}
+
+// Condition variables and reader-writer locks, addressed by ID. They need no creating; all of
+// them are set up on first use.
+static Condition conditions[NUM_CONDITIONS];
+static RWLock rwlocks[NUM_RWLOCKS];
+static bool locksInitialized = false;
+
+static void initialize_locks()
+{
+    if (!locksInitialized)
+    {
+        for (int id = 0; id < NUM_CONDITIONS; id++)
+        {
+            initializeCondition(&conditions[id]);
+        }
+        for (int id = 0; id < NUM_RWLOCKS; id++)
+        {
+            initializeRWLock(&rwlocks[id]);
+        }
+        locksInitialized = true;
+    }
+}
+
+static Condition *find_condition(int id)
+{
+    if (id < 0 || id >= NUM_CONDITIONS)
+    {
+        printf("Invalid condition ID. Must be between 0 and %d.\n", NUM_CONDITIONS - 1);
+        return NULL;
+    }
+    initialize_locks();
+    return &conditions[id];
+}
+
+static RWLock *find_rwlock(int id)
+{
+    if (id < 0 || id >= NUM_RWLOCKS)
+    {
+        printf("Invalid lock ID. Must be between 0 and %d.\n", NUM_RWLOCKS - 1);
+        return NULL;
+    }
+    initialize_locks();
+    return &rwlocks[id];
+}
+
+// A process killed while waiting on a condition or a lock leaves its queue, so the waiter
+// counts stay right and readers held back by a killed writer are let in
+static void cancel_lock_wait(PCB *process)
+{
+    if (!locksInitialized)
+    {
+        return;
+    }
+    for (int id = 0; id < NUM_CONDITIONS; id++)
+    {
+        if (conditionCancelWait(&conditions[id], process))
+        {
+            return;
+        }
+    }
+    for (int id = 0; id < NUM_RWLOCKS; id++)
+    {
+        if (rwlockCancelWait(&rwlocks[id], process))
+        {
+            return;
+        }
+    }
+}
+
+// Implementation of the condition Wait command on the running process. The semaphore mutexId
+// is released as the process blocks; once woken it must P the semaphore again.
+int Commands_ConditionWait(int id, int mutexId)
+{
+    Condition *condition = find_condition(id);
+    Semaphore *mutex = mutexId == -1 ? NULL : find_semaphore(mutexId);
+    PCB *process = Scheduler_getCurrentProcess();
+    if (condition == NULL || (mutex == NULL && mutexId != -1) || process == NULL)
+    {
+        return -1;
+    }
+    if (process->pid == INIT_PROCESS_PID)
+    {
+        printf("The 'init' process cannot wait on condition %d.\n", id);
+        return -1;
+    }
+    conditionWait(condition, mutex, process);
+    block_current_process(process, BLOCKED_ON_CONDITION);
+    return 0;
+}
+
+// Implementation of the condition Signal command
+int Commands_ConditionSignal(int id)
+{
+    Condition *condition = find_condition(id);
+    if (condition == NULL)
+    {
+        return -1;
+    }
+    if (conditionSignal(condition))
+    {
+        printf("Condition %d signalled; one waiter is ready, %d still waiting.\n", id, condition->waiterCount);
+    }
+    else
+    {
+        printf("Condition %d signalled with nobody waiting.\n", id);
+    }
+    return 0;
+}
+
+// Implementation of the condition Broadcast command
+int Commands_ConditionBroadcast(int id)
+{
+    Condition *condition = find_condition(id);
+    if (condition == NULL)
+    {
+        return -1;
+    }
+    printf("Condition %d broadcast; %d waiters are ready.\n", id, conditionBroadcast(condition));
+    return 0;
+}
+
+// Takes lock id for the running process, blocking it until the lock is granted
+static int lock_rwlock(int id, bool write)
+{
+    RWLock *lock = find_rwlock(id);
+    PCB *process = Scheduler_getCurrentProcess();
+    if (lock == NULL || process == NULL)
+    {
+        return -1;
+    }
+    if (process->pid == INIT_PROCESS_PID && !rwlockAvailable(lock, write))
+    {
+        printf("The 'init' process cannot block on lock %d.\n", id);
+        return -1;
+    }
+    bool acquired = write ? rwlockAcquireWrite(lock, process) : rwlockAcquireRead(lock, process);
+    if (acquired)
+    {
+        printf("Process with PID %d acquired lock %d for %s.\n", process->pid, id, write ? "writing" : "reading");
+    }
+    else
+    {
+        block_current_process(process, BLOCKED_ON_RWLOCK);
+    }
+    return 0;
+}
+
+int Commands_LockRead(int id)
+{
+    return lock_rwlock(id, false);
+}
+
+int Commands_LockWrite(int id)
+{
+    return lock_rwlock(id, true);
+}
+
+// Implementation of the lock Release command on the running process
+int Commands_Unlock(int id)
+{
+    RWLock *lock = find_rwlock(id);
+    PCB *process = Scheduler_getCurrentProcess();
+    if (lock == NULL || process == NULL)
+    {
+        return -1;
+    }
+    if (lock->writerPid != process->pid && lock->readers == 0)
+    {
+        printf("Process with PID %d does not hold lock %d.\n", process->pid, id);
+        return -1;
+    }
+    rwlockRelease(lock, process);
+    printf("Lock %d released; %d readers%s hold it now.\n", id, lock->readers,
+           lock->writerPid != -1 ? " and a writer" : "");
+    return 0;
+}
+
+// Futex words, one per key: plain integers processes set and wait on. A process waits only
+// while the word holds the value it expects, so a wake between its check and its wait is not lost.
+static int futexWords[NUM_FUTEX_WORDS];
+
+static int *find_futex_word(int key)
+{
+    if (key < 0 || key >= NUM_FUTEX_WORDS)
+    {
+        printf("Invalid futex key. Must be between 0 and %d.\n", NUM_FUTEX_WORDS - 1);
+        return NULL;
+    }
+    return &futexWords[key];
+}
+
+int Commands_getFutexWord(int key)
+{
+    return key >= 0 && key < NUM_FUTEX_WORDS ? futexWords[key] : 0;
+}
+
+// Implementation of the futex Wait command on the running process
+int Commands_FutexWait(int key, int expected)
+{
+    int *word = find_futex_word(key);
+    PCB *process = Scheduler_getCurrentProcess();
+    if (word == NULL || process == NULL)
+    {
+        return -1;
+    }
+    if (*word != expected)
+    {
+        printf("Futex %d holds %d, not %d; process with PID %d does not wait.\n", key, *word, expected, process->pid);
+        return -1;
+    }
+    if (process->pid == INIT_PROCESS_PID)
+    {
+        printf("The 'init' process cannot wait on futex %d.\n", key);
+        return -1;
+    }
+    if (!Futex_wait(process, key, word, expected))
+    {
+        printf("Process with PID %d could not wait on futex %d.\n", process->pid, key);
+        return -1;
+    }
+    block_current_process(process, BLOCKED_ON_FUTEX);
+    return 0;
+}
+
+// Implementation of the futex Wake command
+int Commands_FutexWake(int key, int count)
+{
+    if (find_futex_word(key) == NULL)
+    {
+        return -1;
+    }
+    if (count < 1)
+    {
+        printf("A futex wake needs a count of at least 1.\n");
+        return -1;
+    }
+    int woken = Futex_wake(key, count);
+    printf("Futex %d woke %d processes; %d still waiting.\n", key, woken, Futex_waiterCount(key));
+    return 0;
+}
+
+// Implementation of the futex Set command
+int Commands_FutexSet(int key, int value)
+{
+    int *word = find_futex_word(key);
+    if (word == NULL)
+    {
+        return -1;
+    }
+    *word = value;
+    printf("Futex %d set to %d.\n", key, value);
+    return 0;
+}
+
+// Implementation of the timer tick: the running process does a tick of its workload, and goes
+// to the back of its queue once its quantum is used up
+int Commands_Quantum()
+{
+    PCB *running = Scheduler_getCurrentProcess();
+    if (running != NULL && running->pid == INIT_PROCESS_PID)
+    {
+        running = NULL; // Init is the idle process
+    }
+    ProcessState leaving = Workload_runTick(running);
+    if (leaving == TERMINATED)
+    {
+        Scheduler_tick(TERMINATED);
+        Edf_release(running);
+        printf("Process with PID %d finished its workload.\n", running->pid);
+        destroyPCB(running);
+    }
+    else
+    {
+        Scheduler_tick(leaving);
+    }
+    PCB *process = Scheduler_getCurrentProcess();
+    if (process == NULL)
+    {
+        printf("No processes to run; the system is idle.\n");
+        return -1;
+    }
+    printf("Process with PID %d is now running.\n", process->pid);
+    return 0;
+}
+
+// Function that handles setting the quantum of a priority level
+int Commands_SetQuantum(int priority, int ticks)
+{
+    if (!Scheduler_setQuantum(priority, ticks))
+    {
+        printf("Invalid quantum. Need priority 0-%d and 1-%d ticks.\n", NUM_PRIORITIES - 1, SCHEDULER_MAX_QUANTUM);
+        return -1;
+    }
+    printf("Priority %d now has a quantum of %d ticks.\n", priority, ticks);
+    return 0;
+}
+
+// Function that handles turning adaptive quanta on or off
+void Commands_AdaptiveQuantum(bool enabled)
+{
+    Scheduler_setAdaptiveQuantum(enabled);
+    printf("Adaptive quanta %s.\n", enabled ? "enabled" : "disabled");
+}
+
+// Prints the quantum settings with the context switches and response times they produced
+void Commands_SchedulerStats()
+{
+    SchedulerStats stats = Scheduler_getStats();
+    printf("Quanta (ticks): %d/%d/%d%s.\n", Scheduler_getQuantum(0), Scheduler_getQuantum(1), Scheduler_getQuantum(2),
+           Scheduler_isAdaptiveQuantum() ? ", adaptive" : "");
+    printf("Context switches: %ld, %ld at quantum expiry.\n", stats.contextSwitches, stats.quantaExpired);
+    if (stats.responses > 0)
+    {
+        printf("Response time: %ld.%02ld ticks average, %ld max over %ld wake-ups.\n", stats.responseTotal / stats.responses,
+               stats.responseTotal * 100 / stats.responses % 100, stats.responseMax, stats.responses);
+    }
+}
+
+static void print_workload_report(const char *label)
+{
+    WorkloadReport report;
+    Workload_getReport(&report);
+    if (report.completed == 0 && Workload_activeCount() == 0)
+    {
+        return;
+    }
+    long completed = report.completed > 0 ? report.completed : 1;
+    long elapsed = report.elapsed > 0 ? report.elapsed : 1;
+    SchedulerStats stats = Scheduler_getStats();
+    printf("%s%ld finished (%d unfinished) in %ld ticks: throughput %ld.%02ld per 100 ticks, turnaround %ld.%02ld avg "
+           "%ld p99, waiting %ld.%02ld avg, CPU %ld%%, %ld switches.\n",
+           label, report.completed, Workload_activeCount(), report.elapsed, report.completed * 100 / elapsed,
+           report.completed * 10000 / elapsed % 100, report.turnaroundTotal / completed,
+           report.turnaroundTotal * 100 / completed % 100, report.turnaroundP99, report.waitingTotal / completed,
+           report.waitingTotal * 100 / completed % 100, report.busyTicks * 100 / elapsed, stats.contextSwitches);
+}
+
+// Prints throughput, turnaround, waiting time and utilization of the workloads run so far
+void Commands_WorkloadStats()
+{
+    print_workload_report("Workloads: ");
+}
+
+// Scheduling policies compared by Commands_ComparePolicies
+typedef struct SchedulingPolicy
+{
+    const char *name;
+    int quantum; // Ticks at every priority level, 0 to keep the current settings
+    bool adaptive;
+} SchedulingPolicy;
+
+static const SchedulingPolicy comparedPolicies[] = {
+    {"current", 0, false},
+    {"quantum 1", 1, false},
+    {"quantum 4", 4, false},
+    {"quantum 16", 16, false},
+    {"adaptive", 1, true},
+};
+
+// Runs the current workloads to completion under each policy and reports how each did. Each run
+// happens in a forked copy of the simulator, so they all start from this exact state and the
+// state itself is left untouched.
+void Commands_ComparePolicies()
+{
+    if (Workload_activeCount() == 0)
+    {
+        printf("There are no unfinished workloads to compare policies on.\n");
+        return;
+    }
+    for (size_t i = 0; i < sizeof(comparedPolicies) / sizeof(comparedPolicies[0]); i++)
+    {
+        const SchedulingPolicy *policy = &comparedPolicies[i];
+        fflush(stdout);
+        pid_t child = fork();
+        if (child < 0)
+        {
+            perror("fork");
+            return;
+        }
+        if (child == 0)
+        {
+            // Run silently, then put stdout back for the report
+            int savedStdout = dup(STDOUT_FILENO);
+            int devNull = open("/dev/null", O_WRONLY);
+            if (savedStdout >= 0 && devNull >= 0)
+            {
+                dup2(devNull, STDOUT_FILENO);
+            }
+            if (policy->quantum > 0)
+            {
+                for (int priority = 0; priority < NUM_PRIORITIES; priority++)
+                {
+                    Scheduler_setQuantum(priority, policy->quantum);
+                }
+                Scheduler_setAdaptiveQuantum(policy->adaptive);
+            }
+            for (long tick = 0; tick < WORKLOAD_COMPARE_MAX_TICKS && Workload_activeCount() > 0; tick++)
+            {
+                Commands_Quantum();
+            }
+            fflush(stdout);
+            if (savedStdout >= 0 && devNull >= 0)
+            {
+                dup2(savedStdout, STDOUT_FILENO);
+            }
+            char label[32];
+            snprintf(label, sizeof(label), "%-11s ", policy->name);
+            print_workload_report(label);
+            Commands_DeviceStats();
+            fflush(stdout);
+            _exit(0);
+        }
+        waitpid(child, NULL, 0);
+    }
+}
+
+// Implementation of the I/O command: the running process reads a track and blocks until it is done
+int Commands_Io(int device, int track, int length)
+{
+    PCB *process = Scheduler_getCurrentProcess();
+    if (process == NULL || process->pid == INIT_PROCESS_PID)
+    {
+        printf("Only a running process other than init can do I/O.\n");
+        return -1;
+    }
+    if (!Device_submit(process, device, track, length, Scheduler_getTime()))
+    {
+        printf("Invalid I/O request. Need device 0-%d, track 0-%d and a positive length.\n", NUM_DEVICES - 1,
+               DEVICE_TRACKS - 1);
+        return -1;
+    }
+    block_current_process(process, BLOCKED_ON_IO);
+    return 0;
+}
+
+// Function that handles choosing a device's disk-scheduling policy
+int Commands_SetDevicePolicy(int id, int policy)
+{
+    if (!Device_setPolicy(id, (DevicePolicy)policy))
+    {
+        printf("Invalid device policy. Need device 0-%d and policy 0 (FIFO), 1 (SCAN) or 2 (DEADLINE).\n",
+               NUM_DEVICES - 1);
+        return -1;
+    }
+    printf("Device %d now uses %s.\n", id, Device_policyName((DevicePolicy)policy));
+    return 0;
+}
+
+// Prints throughput, service and response times and queue depth of every device that has been used
+void Commands_DeviceStats()
+{
+    long now = Scheduler_getTime();
+    long elapsed = now > 0 ? now : 1;
+    for (int id = 0; id < NUM_DEVICES; id++)
+    {
+        const Device *device = Device_get(id);
+        if (device->completed == 0 && device->active == NULL)
+        {
+            continue;
+        }
+        long completed = device->completed > 0 ? device->completed : 1;
+        long depthArea = device->depthArea + (long)device->depth * (now - device->depthChanged);
+        printf("Device %d (%s): %ld requests, %ld.%02ld per 100 ticks, service %ld.%02ld avg, response %ld.%02ld avg "
+               "%ld max, queue depth %ld.%02ld avg %d max, %ld%% busy.\n",
+               id, Device_policyName(device->policy), device->completed, device->completed * 100 / elapsed,
+               device->completed * 10000 / elapsed % 100, device->serviceTotal / completed,
+               device->serviceTotal * 100 / completed % 100, device->responseTotal / completed,
+               device->responseTotal * 100 / completed % 100, device->responseMax, depthArea / elapsed,
+               depthArea * 100 / elapsed % 100, device->depthMax, device->serviceTotal * 100 / elapsed);
+    }
+}
+
+// Implementation of the sampler command: writes every queue length to path each period ticks
+int Commands_StartSampler(int period, const char *path)
+{
+    if (!Stats_startSampler(path, period))
+    {
+        printf("Failed to open sample file %s.\n", path);
+        return -1;
+    }
+    if (period > 0)
+    {
+        printf("Sampling queue lengths to %s every %d ticks.\n", path, period);
+    }
+    else
+    {
+        printf("Queue sampling stopped.\n");
+    }
+    return 0;
+}
+
+// Prints the time-weighted average length of every queue that has been used, and the average
+// time an item spent in it by Little's law
+void Commands_QueueStats()
+{
+    long now = Scheduler_getTime();
+    long elapsed = now > 0 ? now : 1;
+    for (int id = 0; id < STATS_NUM_GAUGES; id++)
+    {
+        const StatsGauge *gauge = Stats_get(id);
+        if (gauge->entries == 0)
+        {
+            continue;
+        }
+        long area = Stats_area(id, now);
+        printf("Queue %s: length %ld.%02ld avg %ld max, %ld entries, %ld.%02ld ticks avg wait.\n", Stats_name(id),
+               area / elapsed, area * 100 / elapsed % 100, gauge->max, gauge->entries, area / gauge->entries,
+               area * 100 / gauge->entries % 100);
+    }
+}
+
+// Implementation of the Procinfo command
+int Commands_Procinfo(int pid, bool json)
+{
+    if (!Dump_process(pid, json ? DUMP_JSON : DUMP_TEXT))
+    {
+        printf("Process with PID %d not found.\n", pid);
+        return -1;
+    }
+    return 0;
+}
+
+// Implementation of the Totalinfo command
+void Commands_Totalinfo(bool json)
+{
+    Dump_system(json ? DUMP_JSON : DUMP_TEXT);
+}
+
+// Function that handles creating a process whose body is a built-in C function (program.h)
+int Commands_CreateProgramProcess(int priority, const char *name, int arg1, int arg2)
+{
+    PCB *newPcb = new_process(priority);
+    if (newPcb == NULL)
+    {
+        return -1;
+    }
+    if (!Program_start(newPcb, name, arg1, arg2))
+    {
+        printf("Unknown program %s. Need one of %s.\n", name, Program_names());
+        destroyPCB(newPcb);
+        return -1;
+    }
+    Scheduler_scheduleProcess(newPcb);
+    printf("Process created successfully with PID: %d (program %s)\n", newPcb->pid, name);
+    return newPcb->pid;
+}
+
+// Runs the bodies of running processes for up to steps system calls, stopping early once the
+// running process has no body
+int Commands_RunPrograms(int steps)
+{
+    int step = 0;
+    for (; step < steps; step++)
+    {
+        PCB *process = Scheduler_getCurrentProcess();
+        if (process == NULL || process->program == NULL)
+        {
+            break;
+        }
+        Program_step(process);
+    }
+    PCB *process = Scheduler_getCurrentProcess();
+    if (step < steps)
+    {
+        if (process != NULL)
+        {
+            printf("Process with PID %d has no program; stopped after %d steps.\n", process->pid, step);
+        }
+        else
+        {
+            printf("No process is running; stopped after %d steps.\n", step);
+        }
+    }
+    return step;
+}
+
+void Commands_ProgramStats()
+{
+    CoroutineStats stats = Coroutine_getStats();
+    if (stats.created == 0)
+    {
+        return;
+    }
+    printf("Programs: %d running, %ld started on %ld stacks (%ld pooled), %ld coroutine switches.\n",
+           Program_count(), stats.created, stats.stacksMapped, stats.pooled, stats.switches);
+}
+
+// Function that handles setting a process group's CPU weight and cap
+int Commands_ConfigureGroup(int id, int weight, int capPercent)
+{
+    if (!Group_configure(id, weight, capPercent))
+    {
+        printf("Invalid group. Need ID 0-%d, weight 1-10000 and cap 0-100%%.\n", MAX_GROUPS - 1);
+        return -1;
+    }
+    printf("Group %d now has weight %d and %s.\n", id, weight, capPercent > 0 ? "a cap" : "no cap");
+    return 0;
+}
+
+// Function that handles moving a process into a group; its children follow it there
+int Commands_JoinGroup(int pid, int id)
+{
+    PCB *process = PidTable_lookup(pid);
+    if (process == NULL)
+    {
+        printf("Process with PID %d not found.\n", pid);
+        return -1;
+    }
+    if (Edf_isRealTime(process) || !Group_join(process, id))
+    {
+        printf("Cannot move process %d to group %d.\n", pid, id);
+        return -1;
+    }
+    printf("Process %d moved to group %d.\n", pid, id);
+    return 0;
+}
+
+static void count_group_member(PCB *process, void *arg)
+{
+    if (!Edf_isRealTime(process) && process->pid != INIT_PROCESS_PID)
+    {
+        ((int *)arg)[process->groupId]++;
+    }
+}
+
+// Prints CPU usage per process group, for groups that have members or have used the CPU
+void Commands_GroupStats()
+{
+    int members[MAX_GROUPS] = {0};
+    long total = 0;
+    PidTable_forEach(count_group_member, members);
+    for (int id = 0; id < MAX_GROUPS; id++)
+    {
+        total += Group_get(id)->usage;
+    }
+    for (int id = 0; id < MAX_GROUPS; id++)
+    {
+        ProcessGroup *group = Group_get(id);
+        if (members[id] == 0 && group->usage == 0)
+        {
+            continue;
+        }
+        printf("Group %d: weight %d, cap %d%%, %d processes, %ld quanta (%ld%%).\n", id, group->weight,
+               group->capPercent, members[id], group->usage, total > 0 ? group->usage * 100 / total : 0);
+    }
+}
+
+// Prints real-time utilization and deadline misses
+void Commands_RealTimeStats()
+{
+    printf("Real-time: %ld.%02ld%% utilization, %ld deadline misses.\n",
+           Edf_utilization() / 10000, Edf_utilization() / 100 % 100, Edf_deadlineMisses());
+}
+
+// Prints the last wait-for cycle the detector found
+void Commands_DeadlockStats()
+{
+    Deadlock_printLastCycle();
+}
+
+// Function that handles turning priority inheritance on semaphores on or off
+void Commands_PriorityInheritance(bool enabled)
+{
+    semaphoreSetPriorityInheritance(enabled);
+    printf("Priority inheritance %s.\n", enabled ? "enabled" : "disabled");
+}
+
+// Prints how many quanta were lost to priority inversion
+void Commands_InversionStats()
+{
+    printf("Priority inversion: %ld of %ld quanta.\n", semaphoreInversionQuanta(), Scheduler_getTime());
+}
+
+static void save_semaphore_wait(PCB *process, void *arg)
+{
+    if (process->waitsOnSemaphore != NULL)
+    {
+        SnapshotWriter *writer = (SnapshotWriter *)arg;
+        Snapshot_putPid(writer, process);
+        Snapshot_putInt(writer, (int)(process->waitsOnSemaphore - semaphores));
+    }
+}
+
+static void save_semaphore_holds(PCB *process, void *arg)
+{
+    if (process->heldSemaphoreCount > 0)
+    {
+        SnapshotWriter *writer = (SnapshotWriter *)arg;
+        Snapshot_putPid(writer, process);
+        Snapshot_putInt(writer, process->heldSemaphoreCount);
+        for (int i = 0; i < process->heldSemaphoreCount; i++)
+        {
+            Snapshot_putInt(writer, (int)(process->heldSemaphores[i] - semaphores));
+        }
+    }
+}
+
+void Commands_save(SnapshotWriter *writer)
+{
+    Snapshot_putLong(writer, ipcHandoffCount);
+    Snapshot_putLong(writer, ipcQueuedCount);
+    for (int id = 0; id < NUM_SEMAPHORES; id++)
+    {
+        Snapshot_putInt(writer, semaphoreCreated[id]);
+        if (semaphoreCreated[id])
+        {
+            semaphoreSave(writer, &semaphores[id]);
+        }
+    }
+    // Wait-for edges through a semaphore, as (PID, semaphore ID) pairs ending with -1
+    PidTable_forEach(save_semaphore_wait, writer);
+    Snapshot_putInt(writer, -1);
+    // Semaphores each process holds, as a PID and its semaphore IDs, ending with -1
+    PidTable_forEach(save_semaphore_holds, writer);
+    Snapshot_putInt(writer, -1);
+    initialize_locks();
+    for (int id = 0; id < NUM_CONDITIONS; id++)
+    {
+        conditionSave(writer, &conditions[id]);
+    }
+    for (int id = 0; id < NUM_RWLOCKS; id++)
+    {
+        rwlockSave(writer, &rwlocks[id]);
+    }
+    for (int key = 0; key < NUM_FUTEX_WORDS; key++)
+    {
+        Snapshot_putInt(writer, futexWords[key]);
+    }
+}
+
+void Commands_restore(SnapshotReader *reader)
+{
+    ipcHandoffCount = Snapshot_getLong(reader);
+    ipcQueuedCount = Snapshot_getLong(reader);
+    for (int id = 0; id < NUM_SEMAPHORES; id++)
+    {
+        semaphoreCreated[id] = Snapshot_getInt(reader) != 0;
+        if (semaphoreCreated[id])
+        {
+            semaphoreRestore(reader, &semaphores[id]);
+        }
+    }
+    PCB *process;
+    while ((process = Snapshot_getPcb(reader)) != NULL)
+    {
+        int id = Snapshot_getInt(reader);
+        if (id < 0 || id >= NUM_SEMAPHORES)
+        {
+            reader->failed = true;
+            return;
+        }
+        process->waitsOnSemaphore = &semaphores[id];
+    }
+    while ((process = Snapshot_getPcb(reader)) != NULL)
+    {
+        int count = Snapshot_getInt(reader);
+        if (count < 0 || count > PCB_MAX_HELD_SEMAPHORES)
+        {
+            reader->failed = true;
+            return;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            int id = Snapshot_getInt(reader);
+            if (id < 0 || id >= NUM_SEMAPHORES)
+            {
+                reader->failed = true;
+                return;
+            }
+            process->heldSemaphores[i] = &semaphores[id];
+        }
+        process->heldSemaphoreCount = count;
+    }
+    initialize_locks();
+    for (int id = 0; id < NUM_CONDITIONS; id++)
+    {
+        conditionRestore(reader, &conditions[id]);
+    }
+    for (int id = 0; id < NUM_RWLOCKS; id++)
+    {
+        rwlockRestore(reader, &rwlocks[id]);
+    }
+    for (int key = 0; key < NUM_FUTEX_WORDS; key++)
+    {
+        futexWords[key] = Snapshot_getInt(reader);
+    }
+}
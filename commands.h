@@ -8,9 +8,109 @@
 // Function to handle the 'Create' command which creates a new process
 int Commands_CreateProcess(int priority);
 
+int Commands_CreateRealTimeProcess(int budget, int period);
+
 int Commands_Fork();
+// Per-process state blocks (PcbStateBlock), shared copy-on-write with a forked child until
+// either one writes to them. Blocks are created with PCB_STATE_BLOCK_SIZE bytes on first write.
+#define PCB_STATE_BLOCK_SIZE 4096
+int Commands_WriteState(int which, int offset, int value);
+int Commands_ReadState(int which, int offset);
 
 
 int Commands_Kill(int pid);
 int Commands_Exit();
+// Whether the last process has exited, which ends the simulation. The front end then closes
+// its command log and ends the program.
+bool Commands_isSimulationOver();
+
+// Signals (signals.h): signal numbers 0 to NUM_SIGNALS - 1, actions 0 default, 1 handle, 2 ignore
+int Commands_Signal(int pid, int signal);
+int Commands_SetSignalAction(int pid, int signal, int action);
+void Commands_SignalStats();
+
+// Message passing between processes
+int Commands_Send(int pid, const char *message); // Untagged: tag 0
+int Commands_SendTagged(int pid, int tag, const char *message);
+int Commands_Receive();
+// Selective receive: the oldest message from one sender, or with one tag
+int Commands_ReceiveFrom(int senderPid);
+int Commands_ReceiveTagged(int tag);
+int Commands_Reply(int pid, const char *message);
+int Commands_Broadcast(const char *message);
+int Commands_Multicast(int groupId, const char *message); // To the members of one group (group.h)
+int Commands_SetMailboxCapacity(int pid, int capacity);
+void Commands_IpcStats();
+
+// Semaphores, IDs 0 to NUM_SEMAPHORES - 1
+#define NUM_SEMAPHORES 5
+int Commands_NewSemaphore(int id, int value);
+int Commands_P(int id);
+int Commands_V(int id);
+// The semaphore with this ID, NULL if it has not been created
+const struct Semaphore *Commands_getSemaphore(int id);
+
+// Condition variables and reader-writer locks (condition.h), IDs 0 to NUM_CONDITIONS - 1 and
+// 0 to NUM_RWLOCKS - 1. A condition wait first releases the semaphore mutexId, unless it is -1.
+#define NUM_CONDITIONS 5
+#define NUM_RWLOCKS 5
+int Commands_ConditionWait(int id, int mutexId);
+int Commands_ConditionSignal(int id);
+int Commands_ConditionBroadcast(int id);
+int Commands_LockRead(int id);
+int Commands_LockWrite(int id);
+int Commands_Unlock(int id);
+
+// Futexes (futex.h) on keys 0 to NUM_FUTEX_WORDS - 1, each with a shared word. A wait blocks
+// only while the word holds the expected value, and fails at once otherwise.
+#define NUM_FUTEX_WORDS 16
+int Commands_FutexWait(int key, int expected);
+int Commands_FutexWake(int key, int count);
+int Commands_FutexSet(int key, int value);
+int Commands_getFutexWord(int key);
+
+int Commands_Quantum();
+void Commands_PriorityInheritance(bool enabled);
+void Commands_InversionStats();
+void Commands_DeadlockStats();
+void Commands_RealTimeStats();
+
+int Commands_SetQuantum(int priority, int ticks);
+void Commands_AdaptiveQuantum(bool enabled);
+void Commands_SchedulerStats();
+
+int Commands_ConfigureGroup(int id, int weight, int capPercent);
+int Commands_JoinGroup(int pid, int id);
+void Commands_GroupStats();
+
+// Longest a policy comparison runs the workloads for, in ticks
+#define WORKLOAD_COMPARE_MAX_TICKS 1000000L
+
+int Commands_CreateScriptedProcess(int priority, int device, const char *script);
+int Commands_CreateRandomProcesses(int count, int priority, int cpuMean, int ioMean, int bursts, int device, unsigned seed);
+void Commands_WorkloadStats();
+void Commands_ComparePolicies();
+
+int Commands_Io(int device, int track, int length);
+int Commands_SetDevicePolicy(int id, int policy);
+void Commands_DeviceStats();
+
+int Commands_StartSampler(int period, const char *path);
+void Commands_QueueStats();
+
+// Processes whose body is a built-in C function run as a coroutine (program.h)
+int Commands_CreateProgramProcess(int priority, const char *name, int arg1, int arg2);
+int Commands_RunPrograms(int steps);
+void Commands_ProgramStats();
+
+// Procinfo and Totalinfo: dump one process or the whole system as text or NDJSON (dump.h)
+int Commands_Procinfo(int pid, bool json);
+void Commands_Totalinfo(bool json);
+// Snapshot support (snapshot.h): semaphores, which process waits on which, conditions, locks,
+// futex words and IPC counters.
+struct SnapshotWriter;
+struct SnapshotReader;
+void Commands_save(struct SnapshotWriter *writer);
+void Commands_restore(struct SnapshotReader *reader);
+
 #endif // COMMANDS_H
@@ -0,0 +1,251 @@
+#include "condition.h"
+#include "scheduler.h"
+#include "snapshot.h"
+
+void initializeCondition(Condition *condition)
+{
+    if (condition != NULL)
+    {
+        for (int i = 0; i < NUM_PRIORITIES; i++)
+        {
+            processQueueInit(&condition->waiters[i]);
+        }
+        condition->waiterCount = 0;
+    }
+}
+
+void conditionWait(Condition *condition, Semaphore *mutex, PCB *process)
+{
+    if (condition == NULL || process == NULL)
+    {
+        return;
+    }
+    processQueueAppend(&condition->waiters[process->priority], process);
+    condition->waiterCount++;
+    process->state = BLOCKED_ON_CONDITION;
+    if (mutex != NULL)
+    {
+        semaphoreV(mutex, process);
+    }
+}
+
+bool conditionSignal(Condition *condition)
+{
+    if (condition == NULL || condition->waiterCount == 0)
+    {
+        return false;
+    }
+    for (int i = 0; i < NUM_PRIORITIES; i++)
+    {
+        PCB *process = processQueuePop(&condition->waiters[i]);
+        if (process != NULL)
+        {
+            condition->waiterCount--;
+            Scheduler_scheduleProcess(process);
+            return true;
+        }
+    }
+    return false;
+}
+
+int conditionBroadcast(Condition *condition)
+{
+    if (condition == NULL)
+    {
+        return 0;
+    }
+    int woken = condition->waiterCount;
+    for (int i = 0; i < NUM_PRIORITIES; i++)
+    {
+        Scheduler_scheduleQueue(&condition->waiters[i]);
+    }
+    condition->waiterCount = 0;
+    return woken;
+}
+
+bool conditionCancelWait(Condition *condition, PCB *process)
+{
+    if (condition == NULL || process == NULL || process->state != BLOCKED_ON_CONDITION ||
+        process->queue < &condition->waiters[0] || process->queue >= &condition->waiters[NUM_PRIORITIES])
+    {
+        return false;
+    }
+    processQueueRemove(process);
+    condition->waiterCount--;
+    return true;
+}
+
+void initializeRWLock(RWLock *lock)
+{
+    if (lock != NULL)
+    {
+        lock->readers = 0;
+        lock->writerPid = -1;
+        for (int i = 0; i < NUM_PRIORITIES; i++)
+        {
+            processQueueInit(&lock->readWaiters[i]);
+        }
+        lock->readWaiterCount = 0;
+        processQueueInit(&lock->writeWaiters);
+    }
+}
+
+bool rwlockAvailable(const RWLock *lock, bool write)
+{
+    if (write)
+    {
+        return lock->writerPid == -1 && lock->readers == 0;
+    }
+    // Readers wait behind an active writer and behind any writer already queued
+    return lock->writerPid == -1 && lock->writeWaiters.head == NULL;
+}
+
+bool rwlockAcquireRead(RWLock *lock, PCB *process)
+{
+    if (lock == NULL || process == NULL)
+    {
+        return false;
+    }
+    if (rwlockAvailable(lock, false))
+    {
+        lock->readers++;
+        return true;
+    }
+    processQueueAppend(&lock->readWaiters[process->priority], process);
+    lock->readWaiterCount++;
+    process->state = BLOCKED_ON_RWLOCK;
+    return false;
+}
+
+bool rwlockAcquireWrite(RWLock *lock, PCB *process)
+{
+    if (lock == NULL || process == NULL)
+    {
+        return false;
+    }
+    if (rwlockAvailable(lock, true))
+    {
+        lock->writerPid = process->pid;
+        return true;
+    }
+    processQueueAppend(&lock->writeWaiters, process);
+    process->state = BLOCKED_ON_RWLOCK;
+    return false;
+}
+
+// Hands the lock to the next writer in line
+static bool grant_writer(RWLock *lock)
+{
+    PCB *writer = processQueuePop(&lock->writeWaiters);
+    if (writer == NULL)
+    {
+        return false;
+    }
+    lock->writerPid = writer->pid;
+    Scheduler_scheduleProcess(writer);
+    return true;
+}
+
+// Admits every queued reader at once
+static bool grant_readers(RWLock *lock)
+{
+    if (lock->readWaiterCount == 0)
+    {
+        return false;
+    }
+    lock->readers += lock->readWaiterCount;
+    lock->readWaiterCount = 0;
+    for (int i = 0; i < NUM_PRIORITIES; i++)
+    {
+        Scheduler_scheduleQueue(&lock->readWaiters[i]);
+    }
+    return true;
+}
+
+void rwlockRelease(RWLock *lock, PCB *process)
+{
+    if (lock == NULL || process == NULL)
+    {
+        return;
+    }
+    if (lock->writerPid == process->pid)
+    {
+        // Readers that queued during this write go next, then the following writer
+        lock->writerPid = -1;
+        if (!grant_readers(lock))
+        {
+            grant_writer(lock);
+        }
+    }
+    else if (lock->readers > 0 && --lock->readers == 0)
+    {
+        grant_writer(lock);
+    }
+}
+
+bool rwlockCancelWait(RWLock *lock, PCB *process)
+{
+    if (lock == NULL || process == NULL || process->state != BLOCKED_ON_RWLOCK)
+    {
+        return false;
+    }
+    if (process->queue == &lock->writeWaiters)
+    {
+        processQueueRemove(process);
+        // Readers queued behind this writer may now have nothing ahead of them
+        if (lock->writerPid == -1 && lock->writeWaiters.head == NULL)
+        {
+            grant_readers(lock);
+        }
+        return true;
+    }
+    if (process->queue >= &lock->readWaiters[0] && process->queue < &lock->readWaiters[NUM_PRIORITIES])
+    {
+        processQueueRemove(process);
+        lock->readWaiterCount--;
+        return true;
+    }
+    return false;
+}
+
+void conditionSave(SnapshotWriter *writer, const Condition *condition)
+{
+    Snapshot_putInt(writer, condition->waiterCount);
+    for (int i = 0; i < NUM_PRIORITIES; i++)
+    {
+        Snapshot_putQueue(writer, &condition->waiters[i]);
+    }
+}
+
+void conditionRestore(SnapshotReader *reader, Condition *condition)
+{
+    condition->waiterCount = Snapshot_getInt(reader);
+    for (int i = 0; i < NUM_PRIORITIES; i++)
+    {
+        Snapshot_getQueue(reader, &condition->waiters[i]);
+    }
+}
+
+void rwlockSave(SnapshotWriter *writer, const RWLock *lock)
+{
+    Snapshot_putInt(writer, lock->readers);
+    Snapshot_putInt(writer, lock->writerPid);
+    Snapshot_putInt(writer, lock->readWaiterCount);
+    for (int i = 0; i < NUM_PRIORITIES; i++)
+    {
+        Snapshot_putQueue(writer, &lock->readWaiters[i]);
+    }
+    Snapshot_putQueue(writer, &lock->writeWaiters);
+}
+
+void rwlockRestore(SnapshotReader *reader, RWLock *lock)
+{
+    lock->readers = Snapshot_getInt(reader);
+    lock->writerPid = Snapshot_getInt(reader);
+    lock->readWaiterCount = Snapshot_getInt(reader);
+    for (int i = 0; i < NUM_PRIORITIES; i++)
+    {
+        Snapshot_getQueue(reader, &lock->readWaiters[i]);
+    }
+    Snapshot_getQueue(reader, &lock->writeWaiters);
+}
@@ -0,0 +1,70 @@
+#ifndef CONDITION_H
+#define CONDITION_H
+
+#include "semaphore.h"
+
+// Condition variable. Waiters are kept in one FIFO per priority level so a broadcast can
+// splice each level onto the matching ready queue as a batch.
+typedef struct Condition
+{
+    ProcessQueue waiters[NUM_PRIORITIES];
+    int waiterCount;
+} Condition;
+
+// Reader-writer lock with writer preference: once a writer waits, new readers queue behind it.
+// When a writer releases, every reader that queued in the meantime is admitted as one batch
+// before the next writer, so neither side can starve the other.
+typedef struct RWLock
+{
+    int readers;   // Number of processes holding the lock for reading
+    int writerPid; // Process holding the lock for writing, -1 if none
+    ProcessQueue readWaiters[NUM_PRIORITIES];
+    int readWaiterCount;
+    ProcessQueue writeWaiters;
+} RWLock;
+
+void initializeCondition(Condition *condition);
+
+// Atomically releases mutex (if not NULL) and blocks process on the condition. Mesa semantics:
+// a woken process is only made ready, and must P the mutex again and re-check its condition.
+void conditionWait(Condition *condition, Semaphore *mutex, PCB *process);
+
+// Wakes the most urgent, longest-waiting process. Returns false if nobody was waiting.
+bool conditionSignal(Condition *condition);
+
+// Wakes every waiter with one queue splice per priority level. Each woken process is still
+// visited once to mark it ready, so this is O(waiters). Returns the number woken.
+int conditionBroadcast(Condition *condition);
+
+// Takes process out of the condition's queue if it waits there, as when it is killed. The
+// mutex it released is not taken back. Returns false if it was not waiting on condition.
+bool conditionCancelWait(Condition *condition, PCB *process);
+
+void initializeRWLock(RWLock *lock);
+
+// Whether an acquire for reading or writing would be granted at once.
+bool rwlockAvailable(const RWLock *lock, bool write);
+
+// Acquire the lock for reading or writing. Returns true if process got the lock; otherwise it
+// is left BLOCKED_ON_RWLOCK and is made ready once the lock has been granted to it.
+bool rwlockAcquireRead(RWLock *lock, PCB *process);
+bool rwlockAcquireWrite(RWLock *lock, PCB *process);
+
+// Releases whichever hold process has on the lock and grants it to the next waiters.
+void rwlockRelease(RWLock *lock, PCB *process);
+
+// Takes process out of the lock's queues if it waits there, as when it is killed. Readers that
+// were only held back by a cancelled writer are admitted. Returns false if it was not waiting
+// on lock.
+bool rwlockCancelWait(RWLock *lock, PCB *process);
+
+// Snapshot support (snapshot.h): counts, holders and wait queues of one object, restored into
+// an initialized one.
+struct SnapshotWriter;
+struct SnapshotReader;
+void conditionSave(struct SnapshotWriter *writer, const Condition *condition);
+void conditionRestore(struct SnapshotReader *reader, Condition *condition);
+void rwlockSave(struct SnapshotWriter *writer, const RWLock *lock);
+void rwlockRestore(struct SnapshotReader *reader, RWLock *lock);
+
+#endif // CONDITION_H
@@ -0,0 +1,214 @@
+#include "coroutine.h"
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#if defined(__x86_64__) && !defined(COROUTINE_UCONTEXT)
+#define COROUTINE_ASM 1
+#else
+#include <ucontext.h>
+#endif
+
+// A coroutine's control block sits at the top of its own stack mapping, so one mmap holds both
+// and a pooled stack comes back with its block ready to reuse
+struct Coroutine
+{
+#ifdef COROUTINE_ASM
+    void *stackPointer; // Saved while suspended; the callee-saved registers are on the stack below it
+#else
+    ucontext_t context;
+#endif
+    CoroutineEntry entry;
+    void *arg;
+    bool finished;
+    char *mapping;      // Start of the mapping, at the guard page
+    Coroutine *poolNext;
+};
+
+// Bytes at the top of each mapping taken by the control block, keeping the stack top aligned
+#define COROUTINE_BLOCK_SIZE ((sizeof(Coroutine) + 63) & ~(size_t)63)
+
+static Coroutine *current = NULL; // Coroutine running now, NULL on the caller's own stack
+static Coroutine *pool = NULL;
+static CoroutineStats stats;
+
+void coroutine_main(Coroutine *coroutine);
+
+#ifdef COROUTINE_ASM
+static void *callerStackPointer;
+
+// coroutine_switch(save, load) pushes the callee-saved registers, stores the stack pointer in
+// *save, then loads the stack pointer load and pops the registers saved there. Everything else
+// is caller-saved under the System V ABI, so the compiler has already spilled what it needs.
+// A new coroutine's stack is laid out to "return" into coroutine_trampoline with the coroutine
+// in r12.
+void coroutine_switch(void **save, void *load);
+void coroutine_trampoline(void);
+__asm__(".text\n"
+        ".p2align 4\n"
+        ".globl coroutine_switch\n"
+        ".hidden coroutine_switch\n"
+        ".type coroutine_switch, @function\n"
+        "coroutine_switch:\n"
+        "    pushq %rbp\n"
+        "    pushq %rbx\n"
+        "    pushq %r12\n"
+        "    pushq %r13\n"
+        "    pushq %r14\n"
+        "    pushq %r15\n"
+        "    movq %rsp, (%rdi)\n"
+        "    movq %rsi, %rsp\n"
+        "    popq %r15\n"
+        "    popq %r14\n"
+        "    popq %r13\n"
+        "    popq %r12\n"
+        "    popq %rbx\n"
+        "    popq %rbp\n"
+        "    ret\n"
+        ".size coroutine_switch, .-coroutine_switch\n"
+        ".p2align 4\n"
+        ".globl coroutine_trampoline\n"
+        ".hidden coroutine_trampoline\n"
+        ".type coroutine_trampoline, @function\n"
+        "coroutine_trampoline:\n"
+        "    movq %r12, %rdi\n"
+        "    call coroutine_main\n"
+        "    ud2\n"
+        ".size coroutine_trampoline, .-coroutine_trampoline\n");
+
+// Lays out the stack so that the first switch to it enters coroutine_trampoline. The six
+// register slots and the return address sit just below the top, with the stack 16-byte aligned
+// once the return address is popped, as coroutine_trampoline's call requires.
+static void prepare_stack(Coroutine *coroutine)
+{
+    void **top = (void **)((uintptr_t)coroutine & ~(uintptr_t)15);
+    void **frame = top - 9;
+    for (int i = 0; i < 9; i++)
+    {
+        frame[i] = NULL;
+    }
+    frame[3] = coroutine;                    // r12
+    frame[6] = (void *)coroutine_trampoline; // Return address
+    coroutine->stackPointer = frame;
+}
+#else
+static ucontext_t callerContext;
+
+static void coroutine_start()
+{
+    coroutine_main(current);
+}
+
+static void prepare_stack(Coroutine *coroutine)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    getcontext(&coroutine->context);
+    coroutine->context.uc_stack.ss_sp = coroutine->mapping + page;
+    coroutine->context.uc_stack.ss_size = (size_t)((char *)coroutine - coroutine->mapping - page);
+    coroutine->context.uc_link = NULL;
+    makecontext(&coroutine->context, coroutine_start, 0);
+}
+#endif
+
+// Entered on the coroutine's own stack; never returns
+__attribute__((used, visibility("hidden"))) void coroutine_main(Coroutine *coroutine)
+{
+    coroutine->entry(coroutine->arg);
+    coroutine->finished = true;
+    Coroutine_yield();
+}
+
+// Size of a whole mapping: the guard page, the stack and the control block
+static size_t mapping_size()
+{
+    return (size_t)sysconf(_SC_PAGESIZE) + COROUTINE_STACK_SIZE + COROUTINE_BLOCK_SIZE;
+}
+
+static Coroutine *map_coroutine()
+{
+    size_t size = mapping_size();
+    char *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (mapping == MAP_FAILED)
+    {
+        return NULL;
+    }
+    if (mprotect(mapping, (size_t)sysconf(_SC_PAGESIZE), PROT_NONE) != 0)
+    {
+        munmap(mapping, size);
+        return NULL;
+    }
+    Coroutine *coroutine = (Coroutine *)(mapping + size - COROUTINE_BLOCK_SIZE);
+    coroutine->mapping = mapping;
+    stats.stacksMapped++;
+    return coroutine;
+}
+
+Coroutine *Coroutine_create(CoroutineEntry entry, void *arg)
+{
+    Coroutine *coroutine = pool;
+    if (coroutine != NULL)
+    {
+        pool = coroutine->poolNext;
+        stats.pooled--;
+    }
+    else if ((coroutine = map_coroutine()) == NULL)
+    {
+        return NULL;
+    }
+    coroutine->entry = entry;
+    coroutine->arg = arg;
+    coroutine->finished = false;
+    coroutine->poolNext = NULL;
+    prepare_stack(coroutine);
+    stats.created++;
+    return coroutine;
+}
+
+void Coroutine_resume(Coroutine *coroutine)
+{
+    current = coroutine;
+    stats.switches++;
+#ifdef COROUTINE_ASM
+    coroutine_switch(&callerStackPointer, coroutine->stackPointer);
+#else
+    swapcontext(&callerContext, &coroutine->context);
+#endif
+    current = NULL;
+}
+
+void Coroutine_yield()
+{
+    Coroutine *coroutine = current;
+    stats.switches++;
+#ifdef COROUTINE_ASM
+    coroutine_switch(&coroutine->stackPointer, callerStackPointer);
+#else
+    swapcontext(&coroutine->context, &callerContext);
+#endif
+}
+
+bool Coroutine_finished(const Coroutine *coroutine)
+{
+    return coroutine->finished;
+}
+
+void Coroutine_free(Coroutine *coroutine)
+{
+    if (coroutine == NULL)
+    {
+        return;
+    }
+    if (stats.pooled >= COROUTINE_POOL_MAX)
+    {
+        munmap(coroutine->mapping, mapping_size());
+        return;
+    }
+    coroutine->poolNext = pool;
+    pool = coroutine;
+    stats.pooled++;
+}
+
+CoroutineStats Coroutine_getStats()
+{
+    return stats;
+}
@@ -0,0 +1,46 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Stackful coroutines. Each runs a C function on its own small stack and switches only where it
+// chooses to, by yielding back to whoever resumed it. On x86-64 a switch saves and restores just
+// the callee-saved registers and the stack pointer; other targets fall back to ucontext.
+
+// Usable bytes of each coroutine stack. Below it is a guard page, so an overflow faults at once.
+#define COROUTINE_STACK_SIZE (64 * 1024)
+// Freed stacks kept for reuse; beyond this they are unmapped
+#define COROUTINE_POOL_MAX 1024
+
+typedef struct Coroutine Coroutine;
+typedef void (*CoroutineEntry)(void *arg);
+
+typedef struct
+{
+    long created;      // Coroutines created
+    long stacksMapped; // Of those, how many needed a new stack rather than a pooled one
+    long pooled;       // Stacks in the pool now
+    long switches;     // Switches into and out of coroutines
+} CoroutineStats;
+
+// Creates a suspended coroutine that runs entry(arg) when first resumed, on a stack from the
+// pool. Returns NULL if no stack can be mapped.
+Coroutine *Coroutine_create(CoroutineEntry entry, void *arg);
+
+// Runs the coroutine until it yields or its function returns. Must not be called from inside
+// a coroutine.
+void Coroutine_resume(Coroutine *coroutine);
+
+// Called from inside a coroutine: suspends it and returns from the Coroutine_resume that ran it.
+void Coroutine_yield();
+
+// Whether the coroutine's function has returned; it must not be resumed again.
+bool Coroutine_finished(const Coroutine *coroutine);
+
+// Returns the coroutine's stack to the pool. A suspended coroutine is abandoned where it stands.
+void Coroutine_free(Coroutine *coroutine);
+
+CoroutineStats Coroutine_getStats();
+
+#endif // COROUTINE_H
@@ -0,0 +1,85 @@
+#include "cow.h"
+#include "snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+
+static long copyCount = 0;
+
+CowBlock *Cow_create(size_t size)
+{
+    CowBlock *block = (CowBlock *)calloc(1, sizeof(CowBlock) + size);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+    block->refCount = 1;
+    block->size = size;
+    return block;
+}
+
+CowBlock *Cow_share(CowBlock *block)
+{
+    if (block != NULL)
+    {
+        block->refCount++;
+    }
+    return block;
+}
+
+void *Cow_write(CowBlock **block)
+{
+    if (block == NULL || *block == NULL)
+    {
+        return NULL;
+    }
+
+    CowBlock *shared = *block;
+    if (shared->refCount == 1)
+    {
+        // Sole owner, write in place
+        return shared->data;
+    }
+
+    // First write since the block was shared: take a private copy
+    CowBlock *copy = (CowBlock *)malloc(sizeof(CowBlock) + shared->size);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    copy->refCount = 1;
+    copy->size = shared->size;
+    memcpy(copy->data, shared->data, shared->size);
+    shared->refCount--;
+    copyCount++;
+
+    *block = copy;
+    return copy->data;
+}
+
+const void *Cow_read(const CowBlock *block)
+{
+    return block != NULL ? block->data : NULL;
+}
+
+void Cow_release(CowBlock *block)
+{
+    if (block != NULL && --block->refCount == 0)
+    {
+        free(block);
+    }
+}
+
+long Cow_copyCount()
+{
+    return copyCount;
+}
+
+void Cow_save(SnapshotWriter *writer)
+{
+    Snapshot_putLong(writer, copyCount);
+}
+
+void Cow_restore(SnapshotReader *reader)
+{
+    copyCount = Snapshot_getLong(reader);
+}
@@ -0,0 +1,42 @@
+#ifndef COW_H
+#define COW_H
+
+#include <stddef.h>
+
+// Reference-counted copy-on-write block for per-process state that a forked child
+// shares with its parent until one of them writes to it.
+typedef struct CowBlock
+{
+    int refCount;        // Number of PCBs holding this block
+    size_t size;         // Size of data in bytes
+    unsigned char data[]; // Block contents
+} CowBlock;
+
+// Allocates a zero-filled block of size bytes with a single reference.
+// Returns NULL on failure.
+CowBlock *Cow_create(size_t size);
+
+// Adds a reference to block and returns it. O(1) regardless of block size.
+CowBlock *Cow_share(CowBlock *block);
+
+// Returns a writable pointer to the contents of *block. If the block is shared, it is first
+// replaced by a private copy and the shared one loses a reference.
+// Returns NULL if the private copy could not be allocated; *block is then left unchanged.
+void *Cow_write(CowBlock **block);
+
+// Returns a read-only pointer to the contents of block, or NULL for a NULL block.
+const void *Cow_read(const CowBlock *block);
+
+// Drops a reference to block, freeing it once no PCB holds it.
+void Cow_release(CowBlock *block);
+
+// Number of private copies made by Cow_write since startup.
+long Cow_copyCount();
+
+// Snapshot support (snapshot.h): the copy counter. Blocks are saved with the PCBs holding them.
+struct SnapshotWriter;
+struct SnapshotReader;
+void Cow_save(struct SnapshotWriter *writer);
+void Cow_restore(struct SnapshotReader *reader);
+
+#endif // COW_H
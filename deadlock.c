@@ -0,0 +1,154 @@
+#include "deadlock.h"
+#include "pidtable.h"
+#include "snapshot.h"
+#include <stdio.h>
+#include <string.h>
+
+static long cycleCount = 0;
+static long edgesVisited = 0;
+static int lastCycle[DEADLOCK_MAX_REPORTED];
+static int lastCycleLength = 0;
+static bool checkingEnabled = true;
+
+// Follows the single outgoing edge of a blocked process, or returns NULL at the end of a chain.
+// Stale PIDs of processes that have since died resolve to NULL through the process table.
+static PCB *waits_for(const PCB *pcb)
+{
+    if (pcb->waitsOnSemaphore != NULL)
+    {
+        return PidTable_lookup(pcb->waitsOnSemaphore->holderPid);
+    }
+    if (pcb->waitsForPid > 0)
+    {
+        return PidTable_lookup(pcb->waitsForPid);
+    }
+    return NULL;
+}
+
+// Walks from waiter's new edge and reports a cycle if the walk returns to waiter. The walk is
+// kept in a local buffer and only replaces the last reported cycle if it found a new one.
+static bool check_new_edge(PCB *waiter)
+{
+    if (!checkingEnabled)
+    {
+        return false;
+    }
+    // A walk longer than the number of processes is stuck in an older cycle not through waiter
+    int limit = PidTable_count();
+    int walk[DEADLOCK_MAX_REPORTED];
+    int length = 0;
+    walk[length++] = waiter->pid;
+
+    PCB *next = waits_for(waiter);
+    for (int steps = 0; next != NULL && steps < limit; steps++)
+    {
+        edgesVisited++;
+        if (next == waiter)
+        {
+            cycleCount++;
+            memcpy(lastCycle, walk, (size_t)length * sizeof(int));
+            lastCycleLength = length;
+            printf("Deadlock detected among processes:");
+            for (int i = 0; i < length; i++)
+            {
+                printf(" %d ->", walk[i]);
+            }
+            printf(" %d\n", waiter->pid);
+            return true;
+        }
+        if (length < DEADLOCK_MAX_REPORTED)
+        {
+            walk[length++] = next->pid;
+        }
+        next = waits_for(next);
+    }
+    return false;
+}
+
+bool Deadlock_waitForProcess(PCB *waiter, int targetPid)
+{
+    if (waiter == NULL)
+    {
+        return false;
+    }
+    waiter->waitsForPid = targetPid;
+    waiter->waitsOnSemaphore = NULL;
+    return check_new_edge(waiter);
+}
+
+bool Deadlock_waitForSemaphore(PCB *waiter, Semaphore *semaphore)
+{
+    if (waiter == NULL)
+    {
+        return false;
+    }
+    waiter->waitsForPid = -1;
+    waiter->waitsOnSemaphore = semaphore;
+    return check_new_edge(waiter);
+}
+
+void Deadlock_clearWait(PCB *waiter)
+{
+    if (waiter != NULL)
+    {
+        waiter->waitsForPid = -1;
+        waiter->waitsOnSemaphore = NULL;
+    }
+}
+
+void Deadlock_setChecking(bool enabled)
+{
+    checkingEnabled = enabled;
+}
+
+long Deadlock_cycleCount()
+{
+    return cycleCount;
+}
+
+long Deadlock_edgesVisited()
+{
+    return edgesVisited;
+}
+
+int Deadlock_lastCycle(int *pids)
+{
+    memcpy(pids, lastCycle, (size_t)lastCycleLength * sizeof(int));
+    return lastCycleLength;
+}
+
+void Deadlock_printLastCycle()
+{
+    if (lastCycleLength == 0)
+    {
+        printf("No deadlock has been detected.\n");
+        return;
+    }
+    printf("Last deadlock (%ld detected, %ld wait-for edges checked):", cycleCount, edgesVisited);
+    for (int i = 0; i < lastCycleLength; i++)
+    {
+        printf(" %d ->", lastCycle[i]);
+    }
+    printf(" %d\n", lastCycle[0]);
+}
+
+void Deadlock_save(SnapshotWriter *writer)
+{
+    Snapshot_putLong(writer, cycleCount);
+    Snapshot_putLong(writer, edgesVisited);
+    Snapshot_putInt(writer, lastCycleLength);
+    Snapshot_putBytes(writer, lastCycle, sizeof(lastCycle));
+}
+
+void Deadlock_restore(SnapshotReader *reader)
+{
+    cycleCount = Snapshot_getLong(reader);
+    edgesVisited = Snapshot_getLong(reader);
+    lastCycleLength = Snapshot_getInt(reader);
+    Snapshot_getBytes(reader, lastCycle, sizeof(lastCycle));
+    if (lastCycleLength < 0 || lastCycleLength > DEADLOCK_MAX_REPORTED)
+    {
+        reader->failed = true;
+        lastCycleLength = 0;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef DEADLOCK_H
+#define DEADLOCK_H
+
+#include <stdbool.h>
+#include "pcb.h"
+#include "semaphore.h"
+
+// Incremental wait-for graph. Every blocked process has at most one outgoing edge: the process
+// it waits for directly (a receiver it sent to) or the holder of the semaphore it waits on.
+// A new cycle must go through the edge just added, so each check only follows the chain from
+// that edge's target and touches no other part of the graph.
+
+// Longest cycle kept for reporting
+#define DEADLOCK_MAX_REPORTED 32
+
+// Records that waiter is blocked until the process targetPid acts, and reports a deadlock if
+// the new edge closes a cycle. Returns true if a cycle was found.
+bool Deadlock_waitForProcess(PCB *waiter, int targetPid);
+
+// Records that waiter is blocked on semaphore; the edge follows whoever holds it.
+// Returns true if a cycle was found.
+bool Deadlock_waitForSemaphore(PCB *waiter, Semaphore *semaphore);
+
+// Removes waiter's outgoing edge once it is unblocked.
+void Deadlock_clearWait(PCB *waiter);
+
+// Turns cycle checks on or off, to measure what they cost. Edges are still recorded while
+// checks are off, so a cycle closed then is not reported. On by default.
+void Deadlock_setChecking(bool enabled);
+
+// Number of cycles detected and wait-for edges followed since startup.
+long Deadlock_cycleCount();
+long Deadlock_edgesVisited();
+
+// Copies the PIDs in the most recently detected cycle into pids, which has room for
+// DEADLOCK_MAX_REPORTED, and returns how many there are; 0 if no cycle was detected.
+int Deadlock_lastCycle(int *pids);
+
+// Prints the PIDs in the most recently detected cycle, if any.
+void Deadlock_printLastCycle();
+
+// Snapshot support (snapshot.h): detection counters and the last cycle found. The edges
+// themselves live in the PCBs.
+struct SnapshotWriter;
+struct SnapshotReader;
+void Deadlock_save(struct SnapshotWriter *writer);
+void Deadlock_restore(struct SnapshotReader *reader);
+
+#endif // DEADLOCK_H
@@ -0,0 +1,409 @@
+#include "device.h"
+#include "scheduler.h"
+#include "workload.h"
+#include "snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Requests are carved from slabs of this many and recycled through a free list
+#define DEVICE_SLAB_SIZE 64
+
+static Device devices[NUM_DEVICES];
+static IoRequest *freeRequests = NULL; // Linked through fifoNext
+
+static IoRequest *request_alloc()
+{
+    if (freeRequests == NULL)
+    {
+        IoRequest *slab = (IoRequest *)malloc(DEVICE_SLAB_SIZE * sizeof(IoRequest));
+        if (slab == NULL)
+        {
+            return NULL;
+        }
+        for (int i = 0; i < DEVICE_SLAB_SIZE; i++)
+        {
+            slab[i].fifoNext = freeRequests;
+            freeRequests = &slab[i];
+        }
+    }
+    IoRequest *request = freeRequests;
+    freeRequests = request->fifoNext;
+    return request;
+}
+
+static void request_free(IoRequest *request)
+{
+    request->fifoNext = freeRequests;
+    freeRequests = request;
+}
+
+// Brings the time-weighted queue depth up to now before the depth changes
+static void account_depth(Device *device, long now)
+{
+    device->depthArea += (long)device->depth * (now - device->depthChanged);
+    device->depthChanged = now;
+}
+
+static void queue_request(Device *device, IoRequest *request)
+{
+    int track = request->track;
+    request->trackNext = NULL;
+    request->trackPrev = device->trackTails[track];
+    if (device->trackTails[track] != NULL)
+    {
+        device->trackTails[track]->trackNext = request;
+    }
+    else
+    {
+        device->tracks[track] = request;
+        device->nonEmpty[track / 64] |= (uint64_t)1 << (track % 64);
+    }
+    device->trackTails[track] = request;
+
+    request->fifoNext = NULL;
+    request->fifoPrev = device->fifoTail;
+    if (device->fifoTail != NULL)
+    {
+        device->fifoTail->fifoNext = request;
+    }
+    else
+    {
+        device->fifoHead = request;
+    }
+    device->fifoTail = request;
+    device->depth++;
+    if (device->depth > device->depthMax)
+    {
+        device->depthMax = device->depth;
+    }
+}
+
+static void unqueue_request(Device *device, IoRequest *request)
+{
+    int track = request->track;
+    if (request->trackPrev != NULL)
+    {
+        request->trackPrev->trackNext = request->trackNext;
+    }
+    else
+    {
+        device->tracks[track] = request->trackNext;
+    }
+    if (request->trackNext != NULL)
+    {
+        request->trackNext->trackPrev = request->trackPrev;
+    }
+    else
+    {
+        device->trackTails[track] = request->trackPrev;
+    }
+    if (device->tracks[track] == NULL)
+    {
+        device->nonEmpty[track / 64] &= ~((uint64_t)1 << (track % 64));
+    }
+
+    if (request->fifoPrev != NULL)
+    {
+        request->fifoPrev->fifoNext = request->fifoNext;
+    }
+    else
+    {
+        device->fifoHead = request->fifoNext;
+    }
+    if (request->fifoNext != NULL)
+    {
+        request->fifoNext->fifoPrev = request->fifoPrev;
+    }
+    else
+    {
+        device->fifoTail = request->fifoPrev;
+    }
+    device->depth--;
+}
+
+// Nearest non-empty track from track onwards in direction, or -1
+static int find_track(const Device *device, int track, int direction)
+{
+    while (track >= 0 && track < DEVICE_TRACKS)
+    {
+        uint64_t word = device->nonEmpty[track / 64];
+        int bit = track % 64;
+        if (direction > 0)
+        {
+            word &= ~(uint64_t)0 << bit;
+            if (word != 0)
+            {
+                return track - bit + __builtin_ctzll(word);
+            }
+            track += 64 - bit;
+        }
+        else
+        {
+            word &= bit == 63 ? ~(uint64_t)0 : ((uint64_t)1 << (bit + 1)) - 1;
+            if (word != 0)
+            {
+                return track - bit + 63 - __builtin_clzll(word);
+            }
+            track -= bit + 1;
+        }
+    }
+    return -1;
+}
+
+static IoRequest *pick_request(Device *device, long now)
+{
+    if (device->fifoHead == NULL)
+    {
+        return NULL;
+    }
+    if (device->policy == DEVICE_FIFO ||
+        (device->policy == DEVICE_DEADLINE && now - device->fifoHead->arrival >= DEVICE_DEADLINE_TICKS))
+    {
+        return device->fifoHead;
+    }
+    int track = find_track(device, device->head, device->direction);
+    if (track < 0)
+    {
+        device->direction = -device->direction; // Past the last request: reverse
+        track = find_track(device, device->head, device->direction);
+    }
+    return device->tracks[track];
+}
+
+static void start_next(Device *device, long now)
+{
+    IoRequest *request = pick_request(device, now);
+    if (request == NULL)
+    {
+        return;
+    }
+    account_depth(device, now);
+    unqueue_request(device, request);
+    int distance = abs(request->track - device->head);
+    if (request->track != device->head)
+    {
+        device->direction = request->track > device->head ? 1 : -1;
+    }
+    device->head = request->track;
+    device->active = request;
+    device->activeStart = now;
+    device->activeDone = now + (distance + DEVICE_SEEK_TRACKS_PER_TICK - 1) / DEVICE_SEEK_TRACKS_PER_TICK + request->length;
+}
+
+static void complete_active(Device *device, long now)
+{
+    IoRequest *request = device->active;
+    long response = now - request->arrival;
+    device->active = NULL;
+    device->completed++;
+    device->serviceTotal += now - device->activeStart;
+    device->responseTotal += response;
+    if (response > device->responseMax)
+    {
+        device->responseMax = response;
+    }
+    if (request->process != NULL)
+    {
+        request->process->ioRequest = NULL;
+        Workload_ioDone(request->process, now);
+        Scheduler_scheduleProcess(request->process);
+    }
+    request_free(request);
+}
+
+void Device_init()
+{
+    for (int id = 0; id < NUM_DEVICES; id++)
+    {
+        memset(&devices[id], 0, sizeof(Device));
+        devices[id].policy = DEVICE_FIFO;
+        devices[id].direction = 1;
+    }
+}
+
+bool Device_setPolicy(int id, DevicePolicy policy)
+{
+    if (id < 0 || id >= NUM_DEVICES || policy < DEVICE_FIFO || policy > DEVICE_DEADLINE)
+    {
+        return false;
+    }
+    devices[id].policy = policy;
+    return true;
+}
+
+bool Device_submit(PCB *process, int id, int track, int length, long now)
+{
+    if (process == NULL || process->ioRequest != NULL || id < 0 || id >= NUM_DEVICES || track < 0 ||
+        track >= DEVICE_TRACKS || length < 1)
+    {
+        return false;
+    }
+    IoRequest *request = request_alloc();
+    if (request == NULL)
+    {
+        return false;
+    }
+    Device *device = &devices[id];
+    request->process = process;
+    request->device = id;
+    request->track = track;
+    request->length = length;
+    request->arrival = now;
+    process->ioRequest = request;
+    account_depth(device, now);
+    queue_request(device, request);
+    if (device->active == NULL)
+    {
+        start_next(device, now);
+    }
+    return true;
+}
+
+void Device_advanceTime(long now)
+{
+    for (int id = 0; id < NUM_DEVICES; id++)
+    {
+        Device *device = &devices[id];
+        if (device->active != NULL && device->activeDone <= now)
+        {
+            complete_active(device, now);
+            start_next(device, now);
+        }
+    }
+}
+
+void Device_cancel(PCB *process)
+{
+    IoRequest *request = process != NULL ? process->ioRequest : NULL;
+    if (request == NULL)
+    {
+        return;
+    }
+    process->ioRequest = NULL;
+    Device *device = &devices[request->device];
+    if (device->active == request)
+    {
+        request->process = NULL; // The transfer still finishes, but wakes no one
+        return;
+    }
+    account_depth(device, Scheduler_getTime());
+    unqueue_request(device, request);
+    request_free(request);
+}
+
+const Device *Device_get(int id)
+{
+    return id >= 0 && id < NUM_DEVICES ? &devices[id] : NULL;
+}
+
+const char *Device_policyName(DevicePolicy policy)
+{
+    switch (policy)
+    {
+    case DEVICE_FIFO:
+        return "FIFO";
+    case DEVICE_SCAN:
+        return "SCAN";
+    case DEVICE_DEADLINE:
+        return "DEADLINE";
+    }
+    return "?";
+}
+
+static void save_request(SnapshotWriter *writer, const IoRequest *request)
+{
+    Snapshot_putPid(writer, request->process);
+    Snapshot_putInt(writer, request->track);
+    Snapshot_putInt(writer, request->length);
+    Snapshot_putLong(writer, request->arrival);
+}
+
+static IoRequest *restore_request(SnapshotReader *reader, int id)
+{
+    IoRequest *request = request_alloc();
+    if (request == NULL)
+    {
+        reader->failed = true;
+        return NULL;
+    }
+    request->process = Snapshot_getPcb(reader);
+    request->device = id;
+    request->track = Snapshot_getInt(reader);
+    request->length = Snapshot_getInt(reader);
+    request->arrival = Snapshot_getLong(reader);
+    if (request->track < 0 || request->track >= DEVICE_TRACKS)
+    {
+        reader->failed = true;
+        request->track = 0;
+    }
+    if (request->process != NULL)
+    {
+        request->process->ioRequest = request;
+    }
+    return request;
+}
+
+void Device_save(SnapshotWriter *writer)
+{
+    for (int id = 0; id < NUM_DEVICES; id++)
+    {
+        const Device *device = &devices[id];
+        Snapshot_putInt(writer, device->policy);
+        Snapshot_putInt(writer, device->head);
+        Snapshot_putInt(writer, device->direction);
+        Snapshot_putLong(writer, device->completed);
+        Snapshot_putLong(writer, device->serviceTotal);
+        Snapshot_putLong(writer, device->responseTotal);
+        Snapshot_putLong(writer, device->responseMax);
+        Snapshot_putLong(writer, device->depthArea);
+        Snapshot_putLong(writer, device->depthChanged);
+        Snapshot_putInt(writer, device->depthMax);
+        Snapshot_putInt(writer, device->active != NULL);
+        if (device->active != NULL)
+        {
+            save_request(writer, device->active);
+            Snapshot_putLong(writer, device->activeStart);
+            Snapshot_putLong(writer, device->activeDone);
+        }
+        Snapshot_putInt(writer, device->depth);
+        for (const IoRequest *request = device->fifoHead; request != NULL; request = request->fifoNext)
+        {
+            save_request(writer, request);
+        }
+    }
+}
+
+void Device_restore(SnapshotReader *reader)
+{
+    Device_init();
+    for (int id = 0; id < NUM_DEVICES && !reader->failed; id++)
+    {
+        Device *device = &devices[id];
+        device->policy = (DevicePolicy)Snapshot_getInt(reader);
+        device->head = Snapshot_getInt(reader);
+        device->direction = Snapshot_getInt(reader);
+        device->completed = Snapshot_getLong(reader);
+        device->serviceTotal = Snapshot_getLong(reader);
+        device->responseTotal = Snapshot_getLong(reader);
+        device->responseMax = Snapshot_getLong(reader);
+        device->depthArea = Snapshot_getLong(reader);
+        device->depthChanged = Snapshot_getLong(reader);
+        device->depthMax = Snapshot_getInt(reader);
+        if (Snapshot_getInt(reader))
+        {
+            device->active = restore_request(reader, id);
+            device->activeStart = Snapshot_getLong(reader);
+            device->activeDone = Snapshot_getLong(reader);
+        }
+        // Requeued in arrival order, which also rebuilds each track's FIFO in order
+        int depth = Snapshot_getInt(reader);
+        for (int i = 0; i < depth && !reader->failed; i++)
+        {
+            IoRequest *request = restore_request(reader, id);
+            if (request != NULL)
+            {
+                queue_request(device, request);
+            }
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pcb.h"
+
+#define NUM_DEVICES 4
+// Tracks per device; requests are addressed by track
+#define DEVICE_TRACKS 256
+// Tracks the head crosses per tick of seeking
+#define DEVICE_SEEK_TRACKS_PER_TICK 32
+// Ticks a request may wait under the deadline policy before it is served out of order
+#define DEVICE_DEADLINE_TICKS 50
+
+// Order in which a device serves its queued requests
+typedef enum
+{
+    DEVICE_FIFO,     // Arrival order
+    DEVICE_SCAN,     // Elevator: nearest track in the direction of head travel, reversing at the last request
+    DEVICE_DEADLINE  // SCAN, except that a request waiting DEVICE_DEADLINE_TICKS is served next
+} DevicePolicy;
+
+// A pending or in-service I/O request. A process has at most one, since it blocks until it completes.
+typedef struct IoRequest
+{
+    PCB *process;                 // NULL if the process was destroyed while the request was in service
+    int device;
+    int track;
+    int length;                   // Transfer time in ticks, after the seek
+    long arrival;
+    struct IoRequest *trackNext;  // FIFO of requests for the same track
+    struct IoRequest *trackPrev;
+    struct IoRequest *fifoNext;   // Every queued request in arrival order
+    struct IoRequest *fifoPrev;
+} IoRequest;
+
+// A simulated block device. Queued requests sit in per-track FIFOs with a bitmap of non-empty
+// tracks, so SCAN finds the next track in O(DEVICE_TRACKS / 64), and in one arrival-order FIFO
+// for FIFO and deadline checks. Every operation on a request is O(1) otherwise.
+typedef struct Device
+{
+    DevicePolicy policy;
+    int head;                            // Track under the head
+    int direction;                       // 1 moving up, -1 moving down
+    IoRequest *tracks[DEVICE_TRACKS];    // Head of each track's FIFO
+    IoRequest *trackTails[DEVICE_TRACKS];
+    uint64_t nonEmpty[DEVICE_TRACKS / 64];
+    IoRequest *fifoHead;
+    IoRequest *fifoTail;
+    IoRequest *active;                   // Request in service, NULL when idle
+    long activeStart;
+    long activeDone;                     // Tick the active request completes at
+    int depth;                           // Queued requests, not counting the active one
+
+    // Metrics since start-up
+    long completed;
+    long serviceTotal;                   // Ticks spent seeking and transferring
+    long responseTotal;                  // Arrival to completion
+    long responseMax;
+    long depthArea;                      // Sum over ticks of the queue depth
+    long depthChanged;                   // Tick depthArea was last brought up to date
+    int depthMax;
+} Device;
+
+// Resets every device to an idle FIFO device with its head at track 0.
+void Device_init();
+
+bool Device_setPolicy(int id, DevicePolicy policy);
+
+// Queues an I/O request for process, which the caller blocks in BLOCKED_ON_IO. The process is
+// made ready through Scheduler_scheduleProcess when the request completes.
+// Returns false if the device, track or length is out of range or memory runs out.
+bool Device_submit(PCB *process, int id, int track, int length, long now);
+
+// Completes the requests done at now and starts the next ones.
+void Device_advanceTime(long now);
+
+// Withdraws the request of a process that is being destroyed.
+void Device_cancel(PCB *process);
+
+const Device *Device_get(int id);
+const char *Device_policyName(DevicePolicy policy);
+
+// Snapshot support (snapshot.h): every device with its metrics, the request in service and the
+// queued requests in arrival order.
+struct SnapshotWriter;
+struct SnapshotReader;
+void Device_save(struct SnapshotWriter *writer);
+void Device_restore(struct SnapshotReader *reader);
+
+#endif // DEVICE_H
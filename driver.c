@@ -0,0 +1,186 @@
+#include "ring.h"
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Sample driver and load generator for the shared-memory command ring. Start the simulator with
+// "run -m name" (with its output sent to /dev/null for a throughput run), then run
+// "driver [-n commands] [-p producers] [-q] name". Each producer is a separate process writing
+// the same mix of commands; the first one also asks for and reads every completion. The driver
+// reports how many commands per second the simulator got through.
+
+#define DRIVER_DEFAULT_COMMANDS 10000000L
+#define DRIVER_ATTACH_TRIES 500 // 10ms apart
+
+// Creates, takes and gives back a semaphore, lets the new process run and has it exit, so the
+// simulator's state stays the same size however long the run
+static const RingCommand commandMix[] = {
+    {.op = RING_CREATE, .args = {1}},
+    {.op = RING_P, .args = {0}},
+    {.op = RING_V, .args = {0}},
+    {.op = RING_TICK},
+    {.op = RING_EXIT},
+};
+#define COMMAND_MIX_LENGTH (sizeof(commandMix) / sizeof(commandMix[0]))
+
+static long completions = 0;
+static long failures = 0;
+
+static double now()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static RingChannel *attach(const char *name)
+{
+    for (int tries = 0; tries < DRIVER_ATTACH_TRIES; tries++)
+    {
+        RingChannel *channel = Ring_attach(name);
+        if (channel)
+        {
+            return channel;
+        }
+        struct timespec pause = {.tv_sec = 0, .tv_nsec = 10000000};
+        nanosleep(&pause, NULL);
+    }
+    return NULL;
+}
+
+// Reads every completion available. Returns true if one for syncTag was among them.
+static bool drain(RingChannel *channel, uint64_t syncTag)
+{
+    RingCompletion completion;
+    bool synced = false;
+    while (Ring_popCompletion(channel, &completion))
+    {
+        completions++;
+        if (completion.result < 0)
+        {
+            failures++;
+        }
+        if (completion.op == RING_SYNC && completion.tag == syncTag)
+        {
+            synced = true;
+        }
+    }
+    return synced;
+}
+
+// Pushes command, reading completions while the ring is full so the simulator never stalls on them
+static void push(RingChannel *channel, const RingCommand *command, bool reading)
+{
+    while (!Ring_pushCommand(channel, command))
+    {
+        if (reading)
+        {
+            drain(channel, 0);
+        }
+        sched_yield();
+    }
+}
+
+static void produce(RingChannel *channel, long count, bool reading)
+{
+    RingCommand command;
+    for (long i = 0; i < count; i++)
+    {
+        command = commandMix[i % COMMAND_MIX_LENGTH];
+        command.tag = (uint64_t)i + 1;
+        command.flags = reading ? RING_REPLY_WANTED : 0;
+        push(channel, &command, reading);
+        if (reading && (i & 1023) == 0)
+        {
+            drain(channel, 0);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long count = DRIVER_DEFAULT_COMMANDS;
+    int producers = 1;
+    bool quit = false;
+    int option;
+    while ((option = getopt(argc, argv, "n:p:q")) != -1)
+    {
+        switch (option)
+        {
+        case 'n':
+            count = atol(optarg);
+            break;
+        case 'p':
+            producers = atoi(optarg);
+            break;
+        case 'q':
+            quit = true;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n commands] [-p producers] [-q] name\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc || count < 1 || producers < 1)
+    {
+        fprintf(stderr, "Usage: %s [-n commands] [-p producers] [-q] name\n", argv[0]);
+        return 1;
+    }
+    const char *name = argv[optind];
+
+    RingChannel *channel = attach(name);
+    if (channel == NULL)
+    {
+        fprintf(stderr, "No command ring named %s; start the simulator with run -m %s first.\n", name, name);
+        return 1;
+    }
+
+    RingCommand setup = {.op = RING_NEW_SEMAPHORE, .args = {0, 1}};
+    push(channel, &setup, false);
+
+    double start = now();
+    for (int producer = 1; producer < producers; producer++)
+    {
+        pid_t child = fork();
+        if (child < 0)
+        {
+            perror("fork");
+            return 1;
+        }
+        if (child == 0)
+        {
+            produce(channel, count / producers, false);
+            _exit(0);
+        }
+    }
+    produce(channel, count - (count / producers) * (producers - 1), true);
+    while (waitpid(-1, NULL, WNOHANG) >= 0)
+    {
+        drain(channel, 0);
+        sched_yield();
+    }
+
+    // The rings are FIFO, so once the sync command completes every earlier command has run
+    RingCommand sync = {.op = RING_SYNC, .flags = RING_REPLY_WANTED, .tag = UINT64_MAX};
+    push(channel, &sync, true);
+    while (!drain(channel, sync.tag))
+    {
+        sched_yield();
+    }
+    double elapsed = now() - start;
+
+    printf("%ld commands from %d producers in %.3f s: %.2f million commands/s\n", count, producers, elapsed,
+           count / elapsed / 1e6);
+    printf("%ld completions read, %ld commands failed\n", completions - 1, failures);
+
+    if (quit)
+    {
+        RingCommand stop = {.op = RING_QUIT};
+        push(channel, &stop, true);
+    }
+    Ring_close(channel);
+    return 0;
+}
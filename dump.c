@@ -0,0 +1,461 @@
+#include "dump.h"
+#include "commands.h"
+#include "semaphore.h"
+#include "pidtable.h"
+#include "group.h"
+#include "edf.h"
+#include "device.h"
+#include "workload.h"
+#include "program.h"
+#include "deadlock.h"
+#include <stdio.h>
+#include <string.h>
+
+// Longest piece written by one call; the buffer is flushed when less than this is left
+#define DUMP_MAX_PIECE (MAX_MESSAGE_LENGTH * 6 + 64)
+
+static char buffer[DUMP_BUFFER_SIZE];
+static size_t length = 0;
+static DumpFormat format = DUMP_TEXT;
+static bool firstItem = true; // Of the current list
+
+static const char *stateNames[] = {
+    "running", "ready", "blocked_on_send", "blocked_on_receive", "blocked_on_semaphore",
+    "blocked_on_condition", "blocked_on_rwlock", "blocked_on_futex", "blocked_on_io", "terminated",
+};
+
+static void flush()
+{
+    fwrite(buffer, 1, length, stdout);
+    length = 0;
+}
+
+static void reserve()
+{
+    if (length > DUMP_BUFFER_SIZE - DUMP_MAX_PIECE)
+    {
+        flush();
+    }
+}
+
+static void put_raw(const char *text, size_t size)
+{
+    memcpy(buffer + length, text, size);
+    length += size;
+}
+
+static void put_text(const char *text)
+{
+    put_raw(text, strlen(text));
+}
+
+static void put_long(long value)
+{
+    char digits[24];
+    int count = 0;
+    unsigned long magnitude = value < 0 ? -(unsigned long)value : (unsigned long)value;
+    do
+    {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0)
+    {
+        buffer[length++] = '-';
+    }
+    while (count > 0)
+    {
+        buffer[length++] = digits[--count];
+    }
+}
+
+// Writes text quoted and escaped, so message contents cannot break a record
+static void put_string(const char *text)
+{
+    static const char hex[] = "0123456789abcdef";
+    buffer[length++] = '"';
+    for (size_t i = 0; i < MAX_MESSAGE_LENGTH && text[i] != '\0'; i++)
+    {
+        unsigned char c = (unsigned char)text[i];
+        if (c == '"' || c == '\\')
+        {
+            buffer[length++] = '\\';
+            buffer[length++] = (char)c;
+        }
+        else if (c < 0x20)
+        {
+            put_raw("\\u00", 4);
+            buffer[length++] = hex[c >> 4];
+            buffer[length++] = hex[c & 15];
+        }
+        else
+        {
+            buffer[length++] = (char)c;
+        }
+    }
+    buffer[length++] = '"';
+}
+
+static void begin_record(const char *type)
+{
+    reserve();
+    if (format == DUMP_JSON)
+    {
+        put_text("{\"type\":\"");
+        put_text(type);
+        buffer[length++] = '"';
+    }
+    else
+    {
+        put_text(type);
+    }
+}
+
+static void end_record()
+{
+    if (format == DUMP_JSON)
+    {
+        buffer[length++] = '}';
+    }
+    buffer[length++] = '\n';
+}
+
+static void put_key(const char *key)
+{
+    reserve();
+    if (format == DUMP_JSON)
+    {
+        buffer[length++] = ',';
+        buffer[length++] = '"';
+        put_text(key);
+        put_raw("\":", 2);
+    }
+    else
+    {
+        buffer[length++] = ' ';
+        put_text(key);
+        buffer[length++] = '=';
+    }
+}
+
+static void field_long(const char *key, long value)
+{
+    put_key(key);
+    put_long(value);
+}
+
+static void field_name(const char *key, const char *name)
+{
+    put_key(key);
+    if (format == DUMP_JSON)
+    {
+        put_string(name);
+    }
+    else
+    {
+        put_text(name);
+    }
+}
+
+static void begin_list(const char *key)
+{
+    put_key(key);
+    buffer[length++] = '[';
+    firstItem = true;
+}
+
+static void next_item()
+{
+    reserve();
+    if (!firstItem)
+    {
+        buffer[length++] = format == DUMP_JSON ? ',' : ' ';
+    }
+    firstItem = false;
+}
+
+static void list_pid(PCB *process, void *arg)
+{
+    (void)arg;
+    next_item();
+    put_long(process->pid);
+}
+
+static void end_list()
+{
+    buffer[length++] = ']';
+}
+
+static void field_queue(const char *key, const ProcessQueue *queue)
+{
+    begin_list(key);
+    for (PCB *process = queue->head; process != NULL; process = process->queueNext)
+    {
+        list_pid(process, NULL);
+    }
+    end_list();
+}
+
+static int semaphore_id(const struct Semaphore *semaphore)
+{
+    for (int id = 0; id < NUM_SEMAPHORES; id++)
+    {
+        if (Commands_getSemaphore(id) == semaphore)
+        {
+            return id;
+        }
+    }
+    return -1;
+}
+
+static void dump_process(PCB *process, void *arg)
+{
+    (void)arg;
+    begin_record("process");
+    field_long("pid", process->pid);
+    field_name("state", stateNames[process->state]);
+    field_long("priority", process->priority);
+    field_long("base_priority", process->basePriority);
+    field_long("group", process->groupId);
+    field_long("slice_used", process->sliceUsed);
+    field_long("messages", Mailbox_count(process->mailbox));
+    if (process->waitsOnSemaphore != NULL)
+    {
+        field_long("semaphore", semaphore_id(process->waitsOnSemaphore));
+    }
+    if (process->senderPid >= 0)
+    {
+        field_long("reply_from", process->senderPid);
+    }
+    if (process->waitsForPid >= 0)
+    {
+        field_long("waits_for", process->waitsForPid);
+    }
+    if (process->blockedSenders.count > 0)
+    {
+        field_queue("blocked_senders", &process->blockedSenders);
+    }
+    if (Edf_isRealTime(process))
+    {
+        field_long("rt_budget", process->rtBudget);
+        field_long("rt_period", process->rtPeriod);
+        field_long("rt_budget_left", process->rtBudgetLeft);
+        field_long("rt_deadline", process->rtDeadline);
+        field_long("rt_deadline_misses", process->rtDeadlineMisses);
+    }
+    if (process->program != NULL)
+    {
+        field_name("program", Program_name(process));
+    }
+    if (process->pendingSignals != 0)
+    {
+        field_long("pending_signals", process->pendingSignals);
+    }
+    if (process->ioRequest != NULL)
+    {
+        field_long("io_device", process->ioRequest->device);
+        field_long("io_track", process->ioRequest->track);
+    }
+    if (process->workload != NULL)
+    {
+        field_long("burst", process->workload->phase);
+        field_long("bursts", process->workload->phaseCount);
+        field_long("burst_left", process->workload->remaining);
+    }
+    end_record();
+}
+
+static void dump_mailbox(PCB *process, void *arg)
+{
+    (void)arg;
+    const Mailbox *mailbox = process->mailbox;
+    if (Mailbox_count(mailbox) == 0)
+    {
+        return;
+    }
+    begin_record("mailbox");
+    field_long("pid", process->pid);
+    field_long("count", mailbox->count);
+    field_long("capacity", mailbox->capacity);
+    begin_list("messages");
+    for (const MailboxEntry *entry = mailbox->head; entry != NULL; entry = entry->next)
+    {
+        next_item();
+        if (format == DUMP_JSON)
+        {
+            put_text("{\"from\":");
+            put_long(entry->senderPid);
+            put_text(",\"tag\":");
+            put_long(entry->tag);
+            put_text(",\"text\":");
+            put_string(entry->payload->content);
+            buffer[length++] = '}';
+        }
+        else
+        {
+            put_long(entry->senderPid);
+            buffer[length++] = '/';
+            put_long(entry->tag);
+            buffer[length++] = ':';
+            put_string(entry->payload->content);
+        }
+    }
+    end_list();
+    end_record();
+}
+
+// The blocked sets are gathered without allocation: one pass counts every state, then one pass
+// per non-empty blocked state lists its members
+typedef struct
+{
+    int counts[TERMINATED + 1];
+    ProcessState listing;
+} BlockedSets;
+
+static void count_state(PCB *process, void *arg)
+{
+    ((BlockedSets *)arg)->counts[process->state]++;
+}
+
+static void list_blocked(PCB *process, void *arg)
+{
+    if (process->state == ((BlockedSets *)arg)->listing)
+    {
+        list_pid(process, NULL);
+    }
+}
+
+static void dump_blocked_sets()
+{
+    BlockedSets sets = {{0}, RUNNING};
+    PidTable_forEach(count_state, &sets);
+    for (ProcessState state = BLOCKED_ON_SEND; state < TERMINATED; state++)
+    {
+        if (sets.counts[state] == 0)
+        {
+            continue;
+        }
+        begin_record("blocked");
+        field_name("state", stateNames[state]);
+        field_long("count", sets.counts[state]);
+        begin_list("pids");
+        sets.listing = state;
+        PidTable_forEach(list_blocked, &sets);
+        end_list();
+        end_record();
+    }
+}
+
+static void dump_queues()
+{
+    for (int id = 0; id < MAX_GROUPS; id++)
+    {
+        const ProcessGroup *group = Group_get(id);
+        for (int priority = 0; priority < NUM_PRIORITIES; priority++)
+        {
+            if (group->queues[priority].count == 0)
+            {
+                continue;
+            }
+            begin_record("ready");
+            field_long("group", id);
+            field_long("priority", priority);
+            field_long("count", group->queues[priority].count);
+            field_queue("pids", &group->queues[priority]);
+            end_record();
+        }
+    }
+    for (int ready = 1; ready >= 0; ready--)
+    {
+        begin_record(ready ? "rt_ready" : "rt_waiting_release");
+        begin_list("pids");
+        Edf_forEach(ready, list_pid, NULL);
+        end_list();
+        end_record();
+    }
+    for (int id = 0; id < NUM_SEMAPHORES; id++)
+    {
+        const Semaphore *semaphore = Commands_getSemaphore(id);
+        if (semaphore == NULL)
+        {
+            continue;
+        }
+        begin_record("semaphore");
+        field_long("id", id);
+        field_long("value", semaphore->value);
+        field_long("holder", semaphore->holderPid);
+        field_queue("waiters", &semaphore->queue);
+        end_record();
+    }
+    if (Deadlock_cycleCount() > 0)
+    {
+        int cycle[DEADLOCK_MAX_REPORTED];
+        int cycleLength = Deadlock_lastCycle(cycle);
+        begin_record("deadlock");
+        field_long("detected", Deadlock_cycleCount());
+        field_long("edges_checked", Deadlock_edgesVisited());
+        begin_list("last_cycle");
+        for (int i = 0; i < cycleLength; i++)
+        {
+            next_item();
+            put_long(cycle[i]);
+        }
+        end_list();
+        end_record();
+    }
+    for (int id = 0; id < NUM_DEVICES; id++)
+    {
+        const Device *device = Device_get(id);
+        if (device->active == NULL && device->fifoHead == NULL)
+        {
+            continue;
+        }
+        begin_record("device");
+        field_long("id", id);
+        field_name("policy", Device_policyName(device->policy));
+        field_long("head", device->head);
+        field_long("active", device->active != NULL && device->active->process != NULL ? device->active->process->pid : -1);
+        begin_list("queued");
+        for (const IoRequest *request = device->fifoHead; request != NULL; request = request->fifoNext)
+        {
+            list_pid(request->process, NULL);
+        }
+        end_list();
+        end_record();
+    }
+}
+
+static void dump_process_and_mailbox(PCB *process, void *arg)
+{
+    dump_process(process, arg);
+    dump_mailbox(process, arg);
+}
+
+bool Dump_process(int pid, DumpFormat dumpFormat)
+{
+    PCB *process = PidTable_lookup(pid);
+    if (process == NULL)
+    {
+        return false;
+    }
+    format = dumpFormat;
+    dump_process_and_mailbox(process, NULL);
+    flush();
+    return true;
+}
+
+void Dump_system(DumpFormat dumpFormat)
+{
+    format = dumpFormat;
+    PCB *current = Scheduler_getCurrentProcess();
+    begin_record("system");
+    field_long("time", Scheduler_getTime());
+    field_long("running", current != NULL ? current->pid : -1);
+    field_long("processes", PidTable_count());
+    field_long("ready", Scheduler_readyCount());
+    end_record();
+    dump_queues();
+    dump_blocked_sets();
+    PidTable_forEach(dump_process_and_mailbox, NULL);
+    flush();
+}
@@ -0,0 +1,28 @@
+#ifndef DUMP_H
+#define DUMP_H
+
+#include <stdbool.h>
+
+// Streaming dump of the simulator's state, behind the Procinfo and Totalinfo commands. Records
+// are formatted straight into one static output buffer that is written to stdout whenever it
+// fills, so a dump allocates nothing and costs the same per record however large the system.
+// Text records read "type key=value ...", one per line; JSON records are one object per line
+// (newline-delimited JSON) with a "type" member and the same keys.
+
+// Size of the output buffer
+#define DUMP_BUFFER_SIZE (1 << 16)
+
+typedef enum
+{
+    DUMP_TEXT,
+    DUMP_JSON
+} DumpFormat;
+
+// Writes the process record of pid followed by its mailbox. Returns false if there is no such process.
+bool Dump_process(int pid, DumpFormat format);
+
+// Writes a system record, then every ready queue, real-time heap, semaphore, device queue and
+// blocked set, and finally every process, each followed by its mailbox if it is not empty.
+void Dump_system(DumpFormat format);
+
+#endif // DUMP_H
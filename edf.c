@@ -0,0 +1,294 @@
+#include "edf.h"
+#include "snapshot.h"
+#include "stats.h"
+#include <stdlib.h>
+
+// Binary min-heap of PCBs. Each PCB stores its position so it can be removed or re-keyed in
+// O(log n) without a search.
+typedef struct EdfHeap
+{
+    PCB **items;
+    int count;
+    int capacity;
+    bool byRelease; // Keyed on next release time instead of deadline
+} EdfHeap;
+
+static EdfHeap readyHeap = {NULL, 0, 0, false};   // Runnable jobs by deadline
+static EdfHeap releaseHeap = {NULL, 0, 0, true};  // Every admitted process by next release
+static long utilization = 0;
+static long deadlineMisses = 0;
+
+static long heap_key(const EdfHeap *heap, const PCB *process)
+{
+    return heap->byRelease ? process->rtNextRelease : process->rtDeadline;
+}
+
+static int *heap_index(const EdfHeap *heap, PCB *process)
+{
+    return heap->byRelease ? &process->rtReleaseIndex : &process->rtReadyIndex;
+}
+
+static void heap_set(EdfHeap *heap, int index, PCB *process)
+{
+    heap->items[index] = process;
+    *heap_index(heap, process) = index;
+}
+
+static void sift_up(EdfHeap *heap, int index)
+{
+    PCB *process = heap->items[index];
+    while (index > 0)
+    {
+        int parent = (index - 1) / 2;
+        if (heap_key(heap, heap->items[parent]) <= heap_key(heap, process))
+        {
+            break;
+        }
+        heap_set(heap, index, heap->items[parent]);
+        index = parent;
+    }
+    heap_set(heap, index, process);
+}
+
+static void sift_down(EdfHeap *heap, int index)
+{
+    PCB *process = heap->items[index];
+    for (;;)
+    {
+        int child = 2 * index + 1;
+        if (child >= heap->count)
+        {
+            break;
+        }
+        if (child + 1 < heap->count && heap_key(heap, heap->items[child + 1]) < heap_key(heap, heap->items[child]))
+        {
+            child++;
+        }
+        if (heap_key(heap, process) <= heap_key(heap, heap->items[child]))
+        {
+            break;
+        }
+        heap_set(heap, index, heap->items[child]);
+        index = child;
+    }
+    heap_set(heap, index, process);
+}
+
+static bool heap_push(EdfHeap *heap, PCB *process)
+{
+    if (heap->count == heap->capacity)
+    {
+        int capacity = heap->capacity > 0 ? heap->capacity * 2 : 16;
+        PCB **items = (PCB **)realloc(heap->items, capacity * sizeof(PCB *));
+        if (items == NULL)
+        {
+            return false;
+        }
+        heap->items = items;
+        heap->capacity = capacity;
+    }
+    heap_set(heap, heap->count++, process);
+    sift_up(heap, heap->count - 1);
+    if (heap == &readyHeap)
+    {
+        Stats_add(STATS_REAL_TIME_READY, 1);
+    }
+    return true;
+}
+
+static bool heap_remove(EdfHeap *heap, PCB *process)
+{
+    int *index = heap_index(heap, process);
+    if (*index < 0)
+    {
+        return false;
+    }
+    int at = *index;
+    *index = -1;
+    PCB *last = heap->items[--heap->count];
+    if (at < heap->count)
+    {
+        heap_set(heap, at, last);
+        sift_down(heap, at);
+        sift_up(heap, *heap_index(heap, last));
+    }
+    if (heap == &readyHeap)
+    {
+        Stats_add(STATS_REAL_TIME_READY, -1);
+    }
+    return true;
+}
+
+bool Edf_admit(PCB *process, int budget, int period, long now)
+{
+    if (process == NULL || budget <= 0 || period <= 0 || budget > period || Edf_isRealTime(process))
+    {
+        return false;
+    }
+    long share = (long)budget * EDF_FULL_UTILIZATION / period;
+    if (utilization + share > EDF_FULL_UTILIZATION)
+    {
+        return false; // Over-subscribed: EDF could no longer meet every deadline
+    }
+
+    process->rtBudget = budget;
+    process->rtPeriod = period;
+    process->rtBudgetLeft = budget;
+    process->rtDeadline = now + period;
+    process->rtNextRelease = now + period;
+    if (!heap_push(&releaseHeap, process))
+    {
+        process->rtBudget = 0;
+        process->rtPeriod = 0;
+        return false;
+    }
+    utilization += share;
+    return true;
+}
+
+void Edf_release(PCB *process)
+{
+    if (!Edf_isRealTime(process))
+    {
+        return;
+    }
+    heap_remove(&readyHeap, process);
+    heap_remove(&releaseHeap, process);
+    utilization -= (long)process->rtBudget * EDF_FULL_UTILIZATION / process->rtPeriod;
+    process->rtBudget = 0;
+    process->rtPeriod = 0;
+}
+
+bool Edf_isRealTime(const PCB *process)
+{
+    return process != NULL && process->rtPeriod > 0;
+}
+
+void Edf_enqueue(PCB *process)
+{
+    if (Edf_isRealTime(process) && process->rtBudgetLeft > 0 && process->rtReadyIndex < 0)
+    {
+        heap_push(&readyHeap, process);
+    }
+}
+
+bool Edf_dequeue(PCB *process)
+{
+    return process != NULL && heap_remove(&readyHeap, process);
+}
+
+PCB *Edf_pickNext()
+{
+    if (readyHeap.count == 0)
+    {
+        return NULL;
+    }
+    PCB *process = readyHeap.items[0];
+    heap_remove(&readyHeap, process);
+    return process;
+}
+
+bool Edf_chargeQuantum(PCB *process, int quanta)
+{
+    if (!Edf_isRealTime(process))
+    {
+        return false;
+    }
+    process->rtBudgetLeft -= quanta;
+    if (process->rtBudgetLeft <= 0)
+    {
+        process->rtBudgetLeft = 0;
+        return true;
+    }
+    return false;
+}
+
+void Edf_advanceTime(long now)
+{
+    while (releaseHeap.count > 0 && releaseHeap.items[0]->rtNextRelease <= now)
+    {
+        PCB *process = releaseHeap.items[0];
+        if (process->rtBudgetLeft > 0)
+        {
+            // The job did not get its budget before its deadline
+            process->rtDeadlineMisses++;
+            deadlineMisses++;
+        }
+        process->rtBudgetLeft = process->rtBudget;
+        process->rtDeadline = process->rtNextRelease + process->rtPeriod;
+        process->rtNextRelease += process->rtPeriod;
+        sift_down(&releaseHeap, 0);
+
+        if (process->rtReadyIndex >= 0)
+        {
+            sift_down(&readyHeap, process->rtReadyIndex); // Later deadline
+        }
+        else if (process->state == READY)
+        {
+            heap_push(&readyHeap, process); // Was throttled
+        }
+    }
+}
+
+long Edf_deadlineMisses()
+{
+    return deadlineMisses;
+}
+
+long Edf_utilization()
+{
+    return utilization;
+}
+
+void Edf_forEach(bool ready, void (*fn)(PCB *process, void *arg), void *arg)
+{
+    const EdfHeap *heap = ready ? &readyHeap : &releaseHeap;
+    for (int i = 0; i < heap->count; i++)
+    {
+        fn(heap->items[i], arg);
+    }
+}
+
+int Edf_readyCount()
+{
+    return readyHeap.count;
+}
+
+static void save_heap(SnapshotWriter *writer, const EdfHeap *heap)
+{
+    Snapshot_putInt(writer, heap->count);
+    for (int i = 0; i < heap->count; i++)
+    {
+        Snapshot_putPid(writer, heap->items[i]);
+    }
+}
+
+// The saved order is already a valid heap, so pushing in that order moves nothing
+static void restore_heap(SnapshotReader *reader, EdfHeap *heap)
+{
+    int count = Snapshot_getInt(reader);
+    for (int i = 0; i < count && !reader->failed; i++)
+    {
+        PCB *process = Snapshot_getPcb(reader);
+        if (process == NULL || !heap_push(heap, process))
+        {
+            reader->failed = true;
+        }
+    }
+}
+
+void Edf_save(SnapshotWriter *writer)
+{
+    Snapshot_putLong(writer, utilization);
+    Snapshot_putLong(writer, deadlineMisses);
+    save_heap(writer, &readyHeap);
+    save_heap(writer, &releaseHeap);
+}
+
+void Edf_restore(SnapshotReader *reader)
+{
+    utilization = Snapshot_getLong(reader);
+    deadlineMisses = Snapshot_getLong(reader);
+    restore_heap(reader, &readyHeap);
+    restore_heap(reader, &releaseHeap);
+}
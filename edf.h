@@ -0,0 +1,60 @@
+#ifndef EDF_H
+#define EDF_H
+
+#include <stdbool.h>
+#include "pcb.h"
+
+// Earliest-deadline-first scheduling class for periodic soft-real-time processes. It sits above
+// the static priority levels: a real-time process with budget left always runs before them.
+// Each process runs jobs of up to budget quanta, released every period quanta, with the
+// deadline of a job at the next release. Times are in quanta of simulated time.
+
+// Utilization is tracked in parts per million of one CPU
+#define EDF_FULL_UTILIZATION 1000000L
+
+// Makes process real-time if the admission test passes: the total utilization
+// sum(budget / period) of admitted processes must stay at or below one CPU.
+// Its first job is released at now. Returns false if the process is rejected.
+bool Edf_admit(PCB *process, int budget, int period, long now);
+
+// Removes a real-time process from the class and gives back its utilization.
+void Edf_release(PCB *process);
+
+bool Edf_isRealTime(const PCB *process);
+
+// Queues a ready real-time process by deadline. A process with no budget left in its current
+// job stays out of the queue (throttled) until its next release.
+void Edf_enqueue(PCB *process);
+
+// Removes a queued process from the deadline queue. Returns true if it was queued.
+bool Edf_dequeue(PCB *process);
+
+// Removes and returns the ready real-time process with the earliest deadline, or NULL.
+PCB *Edf_pickNext();
+
+// Charges quanta of CPU time to a running real-time process. Returns true if this used up the
+// budget of its current job, so the process must give up the CPU until its next release.
+bool Edf_chargeQuantum(PCB *process, int quanta);
+
+// Releases every job due at or before now, refilling budgets and moving deadlines forward.
+// A job whose budget was not used up by its deadline counts as a deadline miss.
+void Edf_advanceTime(long now);
+
+// Total deadline misses and current utilization in parts per million.
+long Edf_deadlineMisses();
+long Edf_utilization();
+
+// Number of real-time processes ready to run.
+int Edf_readyCount();
+
+// Calls fn on every process in the ready heap (ready true) or waiting for its next release, in
+// heap order.
+void Edf_forEach(bool ready, void (*fn)(PCB *process, void *arg), void *arg);
+
+// Snapshot support (snapshot.h): both heaps in their saved order, utilization and misses.
+struct SnapshotWriter;
+struct SnapshotReader;
+void Edf_save(struct SnapshotWriter *writer);
+void Edf_restore(struct SnapshotReader *reader);
+
+#endif // EDF_H
@@ -0,0 +1,169 @@
+#include "futex.h"
+#include "scheduler.h"
+#include "snapshot.h"
+#include <stdlib.h>
+
+#define FUTEX_SLAB_SIZE 64
+
+typedef struct FutexQueue FutexQueue;
+struct FutexQueue
+{
+    ProcessQueue waiters; // First member, so a waiter's queue pointer leads back to its FutexQueue
+    int key;
+    FutexQueue *bucketNext; // Next queue in the same bucket, or next free queue
+};
+
+static FutexQueue *buckets[FUTEX_HASH_BUCKETS];
+static FutexQueue *freeQueues = NULL;
+
+static unsigned int bucket_of(int key)
+{
+    return ((unsigned int)key * 2654435761u) >> 24 & (FUTEX_HASH_BUCKETS - 1);
+}
+
+static FutexQueue *find_queue(int key)
+{
+    FutexQueue *queue = buckets[bucket_of(key)];
+    while (queue != NULL && queue->key != key)
+    {
+        queue = queue->bucketNext;
+    }
+    return queue;
+}
+
+// Takes a queue from the free list, refilling it a slab at a time
+static FutexQueue *queue_alloc()
+{
+    if (freeQueues == NULL)
+    {
+        FutexQueue *slab = (FutexQueue *)malloc(FUTEX_SLAB_SIZE * sizeof(FutexQueue));
+        if (slab == NULL)
+        {
+            return NULL;
+        }
+        for (int i = 0; i < FUTEX_SLAB_SIZE; i++)
+        {
+            slab[i].bucketNext = freeQueues;
+            freeQueues = &slab[i];
+        }
+    }
+    FutexQueue *queue = freeQueues;
+    freeQueues = queue->bucketNext;
+    return queue;
+}
+
+// Unhooks a queue whose last waiter has gone and returns it to the free list
+static void queue_release(FutexQueue *queue)
+{
+    FutexQueue **link = &buckets[bucket_of(queue->key)];
+    while (*link != queue)
+    {
+        link = &(*link)->bucketNext;
+    }
+    *link = queue->bucketNext;
+    queue->bucketNext = freeQueues;
+    freeQueues = queue;
+}
+
+bool Futex_wait(PCB *process, int key, const int *word, int expected)
+{
+    if (process == NULL || process->queue != NULL)
+    {
+        return false;
+    }
+    if (word != NULL && *word != expected)
+    {
+        return false; // Value changed, the caller should re-check instead of sleeping
+    }
+
+    FutexQueue *queue = find_queue(key);
+    if (queue == NULL)
+    {
+        queue = queue_alloc();
+        if (queue == NULL)
+        {
+            return false;
+        }
+        unsigned int bucket = bucket_of(key);
+        processQueueInit(&queue->waiters);
+        queue->key = key;
+        queue->bucketNext = buckets[bucket];
+        buckets[bucket] = queue;
+    }
+    processQueueAppend(&queue->waiters, process);
+    process->state = BLOCKED_ON_FUTEX;
+    return true;
+}
+
+int Futex_wake(int key, int count)
+{
+    FutexQueue *queue = find_queue(key);
+    if (queue == NULL)
+    {
+        return 0;
+    }
+    int woken = 0;
+    while (woken < count && queue->waiters.head != NULL)
+    {
+        Scheduler_scheduleProcess(processQueuePop(&queue->waiters));
+        woken++;
+    }
+    if (queue->waiters.head == NULL)
+    {
+        queue_release(queue);
+    }
+    return woken;
+}
+
+void Futex_cancelWait(PCB *process)
+{
+    if (process == NULL || process->state != BLOCKED_ON_FUTEX || process->queue == NULL)
+    {
+        return;
+    }
+    FutexQueue *queue = (FutexQueue *)process->queue;
+    processQueueRemove(process);
+    if (queue->waiters.head == NULL)
+    {
+        queue_release(queue);
+    }
+}
+
+int Futex_waiterCount(int key)
+{
+    FutexQueue *queue = find_queue(key);
+    return queue != NULL ? queue->waiters.count : 0;
+}
+
+void Futex_save(SnapshotWriter *writer)
+{
+    for (int bucket = 0; bucket < FUTEX_HASH_BUCKETS; bucket++)
+    {
+        for (FutexQueue *queue = buckets[bucket]; queue != NULL; queue = queue->bucketNext)
+        {
+            Snapshot_putInt(writer, 1);
+            Snapshot_putInt(writer, queue->key);
+            Snapshot_putQueue(writer, &queue->waiters);
+        }
+    }
+    Snapshot_putInt(writer, 0);
+}
+
+void Futex_restore(SnapshotReader *reader)
+{
+    while (Snapshot_getInt(reader) == 1 && !reader->failed)
+    {
+        FutexQueue *queue = queue_alloc();
+        if (queue == NULL)
+        {
+            reader->failed = true;
+            return;
+        }
+        queue->key = Snapshot_getInt(reader);
+        processQueueInit(&queue->waiters);
+        Snapshot_getQueue(reader, &queue->waiters);
+        unsigned int bucket = bucket_of(queue->key);
+        queue->bucketNext = buckets[bucket];
+        buckets[bucket] = queue;
+    }
+}
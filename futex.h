@@ -0,0 +1,35 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <stdbool.h>
+#include "pcb.h"
+
+// Number of hash buckets in the wait table. Must be a power of two.
+#define FUTEX_HASH_BUCKETS 256
+
+// Futex-style blocking on arbitrary integer keys. A key costs nothing until a process waits on
+// it: the table only holds wait queues for keys that currently have waiters, and those queues
+// are recycled through a free list rather than allocated per key.
+
+// Blocks process on key unless word is not NULL and *word != expected, the usual futex check
+// that the value has not changed since the caller decided to wait.
+// Returns true if the process was blocked (state BLOCKED_ON_FUTEX). O(1) expected.
+bool Futex_wait(PCB *process, int key, const int *word, int expected);
+
+// Makes up to count of the processes waiting on key ready, longest-waiting first.
+// Returns the number woken. O(1) expected plus O(1) per process woken.
+int Futex_wake(int key, int count);
+
+// Removes a waiting process from its key without waking it, e.g. when it is killed.
+void Futex_cancelWait(PCB *process);
+
+// Number of processes waiting on key.
+int Futex_waiterCount(int key);
+
+// Snapshot support (snapshot.h): every key that has waiters, with its waiters in order.
+struct SnapshotWriter;
+struct SnapshotReader;
+void Futex_save(struct SnapshotWriter *writer);
+void Futex_restore(struct SnapshotReader *reader);
+
+#endif // FUTEX_H
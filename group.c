@@ -0,0 +1,344 @@
+#include "group.h"
+#include "snapshot.h"
+#include "stats.h"
+#include <stdlib.h>
+
+// Virtual runtime added per quantum at weight 1
+#define GROUP_VRUNTIME_SCALE 65536L
+
+static ProcessGroup groups[MAX_GROUPS];
+static ProcessGroup *runnable[MAX_GROUPS]; // Min-heap of groups with ready processes, by vruntime
+static int runnableCount = 0;
+static long minVruntime = 0;               // Floor for groups becoming runnable, so idle time is not banked
+static int readyCount = 0;
+
+static bool runs_before(const ProcessGroup *a, const ProcessGroup *b)
+{
+    return a->vruntime < b->vruntime || (a->vruntime == b->vruntime && a->id < b->id);
+}
+
+static void heap_set(int index, ProcessGroup *group)
+{
+    runnable[index] = group;
+    group->heapIndex = index;
+}
+
+static void sift_up(int index)
+{
+    ProcessGroup *group = runnable[index];
+    while (index > 0)
+    {
+        int parent = (index - 1) / 2;
+        if (!runs_before(group, runnable[parent]))
+        {
+            break;
+        }
+        heap_set(index, runnable[parent]);
+        index = parent;
+    }
+    heap_set(index, group);
+}
+
+static void sift_down(int index)
+{
+    ProcessGroup *group = runnable[index];
+    for (;;)
+    {
+        int child = 2 * index + 1;
+        if (child >= runnableCount)
+        {
+            break;
+        }
+        if (child + 1 < runnableCount && runs_before(runnable[child + 1], runnable[child]))
+        {
+            child++;
+        }
+        if (!runs_before(runnable[child], group))
+        {
+            break;
+        }
+        heap_set(index, runnable[child]);
+        index = child;
+    }
+    heap_set(index, group);
+}
+
+static void heap_push(ProcessGroup *group)
+{
+    if (group->vruntime < minVruntime)
+    {
+        group->vruntime = minVruntime;
+    }
+    heap_set(runnableCount++, group);
+    sift_up(group->heapIndex);
+}
+
+static void heap_remove(ProcessGroup *group)
+{
+    int index = group->heapIndex;
+    ProcessGroup *last = runnable[--runnableCount];
+    group->heapIndex = -1;
+    if (last != group)
+    {
+        heap_set(index, last);
+        sift_down(index);
+        sift_up(last->heapIndex);
+    }
+}
+
+static int group_ready(const ProcessGroup *group)
+{
+    int count = 0;
+    for (int i = 0; i < NUM_PRIORITIES; i++)
+    {
+        count += group->queues[i].count;
+    }
+    return count;
+}
+
+// Adds or removes the group from the heap after its ready queues or cap state changed
+static void update_runnable(ProcessGroup *group)
+{
+    bool shouldRun = !group->throttled && group_ready(group) > 0;
+    if (shouldRun && group->heapIndex < 0)
+    {
+        heap_push(group);
+    }
+    else if (!shouldRun && group->heapIndex >= 0)
+    {
+        heap_remove(group);
+    }
+}
+
+void Group_init()
+{
+    for (int id = 0; id < MAX_GROUPS; id++)
+    {
+        ProcessGroup *group = &groups[id];
+        group->id = id;
+        group->weight = GROUP_DEFAULT_WEIGHT;
+        group->capPercent = 0;
+        group->vruntime = 0;
+        group->usage = 0;
+        group->windowUsage = 0;
+        group->throttled = false;
+        group->heapIndex = -1;
+        for (int i = 0; i < NUM_PRIORITIES; i++)
+        {
+            processQueueInit(&group->queues[i]);
+        }
+    }
+    runnableCount = 0;
+    minVruntime = 0;
+    readyCount = 0;
+}
+
+bool Group_configure(int id, int weight, int capPercent)
+{
+    if (id < 0 || id >= MAX_GROUPS || weight < 1 || weight > 10000 || capPercent < 0 || capPercent > 100)
+    {
+        return false;
+    }
+    groups[id].weight = weight;
+    groups[id].capPercent = capPercent;
+    if (capPercent == 0 && groups[id].throttled)
+    {
+        groups[id].throttled = false;
+        update_runnable(&groups[id]);
+    }
+    return true;
+}
+
+bool Group_join(PCB *process, int id)
+{
+    if (process == NULL || id < 0 || id >= MAX_GROUPS)
+    {
+        return false;
+    }
+    bool queued = Group_dequeue(process);
+    process->groupId = id;
+    if (queued)
+    {
+        Group_enqueue(process, false);
+    }
+    return true;
+}
+
+ProcessGroup *Group_get(int id)
+{
+    return id >= 0 && id < MAX_GROUPS ? &groups[id] : NULL;
+}
+
+void Group_enqueue(PCB *process, bool atFront)
+{
+    ProcessGroup *group = &groups[process->groupId];
+    if (atFront)
+    {
+        processQueuePrepend(&group->queues[process->priority], process);
+    }
+    else
+    {
+        processQueueAppend(&group->queues[process->priority], process);
+    }
+    readyCount++;
+    Stats_add(STATS_READY + process->priority, 1);
+    update_runnable(group);
+}
+
+void Group_enqueueAll(ProcessQueue *waiters)
+{
+    if (waiters->head == NULL)
+    {
+        return;
+    }
+    ProcessGroup *group = &groups[waiters->head->groupId];
+    readyCount += waiters->count;
+    Stats_add(STATS_READY + waiters->head->priority, waiters->count);
+    processQueueSplice(&group->queues[waiters->head->priority], waiters);
+    update_runnable(group);
+}
+
+bool Group_isQueued(const PCB *process)
+{
+    const ProcessGroup *group = &groups[process->groupId];
+    return process->queue >= &group->queues[0] && process->queue < &group->queues[NUM_PRIORITIES];
+}
+
+bool Group_dequeue(PCB *process)
+{
+    if (!Group_isQueued(process))
+    {
+        return false;
+    }
+    processQueueRemove(process); // O(1), the PCB knows its own queue links
+    readyCount--;
+    Stats_add(STATS_READY + process->priority, -1);
+    update_runnable(&groups[process->groupId]);
+    return true;
+}
+
+PCB *Group_pickNext()
+{
+    if (runnableCount == 0)
+    {
+        return NULL;
+    }
+    ProcessGroup *group = runnable[0];
+    if (group->vruntime > minVruntime)
+    {
+        minVruntime = group->vruntime;
+    }
+    for (int i = 0; i < NUM_PRIORITIES; i++)
+    {
+        if (group->queues[i].count > 0)
+        {
+            PCB *process = processQueuePop(&group->queues[i]);
+            readyCount--;
+            Stats_add(STATS_READY + i, -1);
+            update_runnable(group);
+            return process;
+        }
+    }
+    return NULL;
+}
+
+void Group_chargeQuantum(PCB *process, int quanta)
+{
+    if (process == NULL)
+    {
+        return;
+    }
+    ProcessGroup *group = &groups[process->groupId];
+    group->usage += quanta;
+    group->windowUsage += quanta;
+    group->vruntime += quanta * GROUP_VRUNTIME_SCALE / group->weight;
+    if (group->capPercent > 0 && group->windowUsage * 100 >= group->capPercent * GROUP_CAP_WINDOW)
+    {
+        group->throttled = true;
+    }
+    if (group->heapIndex >= 0)
+    {
+        sift_down(group->heapIndex);
+    }
+    update_runnable(group);
+}
+
+void Group_advanceTime(long now)
+{
+    if (now % GROUP_CAP_WINDOW != 0)
+    {
+        return;
+    }
+    for (int id = 0; id < MAX_GROUPS; id++)
+    {
+        groups[id].windowUsage = 0;
+        if (groups[id].throttled)
+        {
+            groups[id].throttled = false;
+            update_runnable(&groups[id]);
+        }
+    }
+}
+
+int Group_readyCount()
+{
+    return readyCount;
+}
+
+void Group_save(SnapshotWriter *writer)
+{
+    for (int id = 0; id < MAX_GROUPS; id++)
+    {
+        ProcessGroup *group = &groups[id];
+        Snapshot_putInt(writer, group->weight);
+        Snapshot_putInt(writer, group->capPercent);
+        Snapshot_putLong(writer, group->vruntime);
+        Snapshot_putLong(writer, group->usage);
+        Snapshot_putInt(writer, group->windowUsage);
+        Snapshot_putInt(writer, group->throttled);
+        for (int i = 0; i < NUM_PRIORITIES; i++)
+        {
+            Snapshot_putQueue(writer, &group->queues[i]);
+        }
+    }
+    Snapshot_putInt(writer, runnableCount);
+    for (int i = 0; i < runnableCount; i++)
+    {
+        Snapshot_putInt(writer, runnable[i]->id);
+    }
+    Snapshot_putLong(writer, minVruntime);
+    Snapshot_putInt(writer, readyCount);
+}
+
+void Group_restore(SnapshotReader *reader)
+{
+    Group_init();
+    for (int id = 0; id < MAX_GROUPS; id++)
+    {
+        ProcessGroup *group = &groups[id];
+        group->weight = Snapshot_getInt(reader);
+        group->capPercent = Snapshot_getInt(reader);
+        group->vruntime = Snapshot_getLong(reader);
+        group->usage = Snapshot_getLong(reader);
+        group->windowUsage = Snapshot_getInt(reader);
+        group->throttled = Snapshot_getInt(reader) != 0;
+        for (int i = 0; i < NUM_PRIORITIES; i++)
+        {
+            Snapshot_getQueue(reader, &group->queues[i]);
+        }
+    }
+    // The heap is restored in its saved order, which is already a valid heap
+    int count = Snapshot_getInt(reader);
+    for (int i = 0; i < count && !reader->failed; i++)
+    {
+        int id = Snapshot_getInt(reader);
+        if (id < 0 || id >= MAX_GROUPS || count > MAX_GROUPS)
+        {
+            reader->failed = true;
+            return;
+        }
+        heap_set(runnableCount++, &groups[id]);
+    }
+    minVruntime = Snapshot_getLong(reader);
+    readyCount = Snapshot_getInt(reader);
+}
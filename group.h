@@ -0,0 +1,74 @@
+#ifndef GROUP_H
+#define GROUP_H
+
+#include <stdbool.h>
+#include "scheduler.h" // NUM_PRIORITIES
+
+// Number of process groups. Group 0 is the default group every process starts in.
+#define MAX_GROUPS 16
+#define GROUP_DEFAULT_WEIGHT 100
+// Caps are enforced over windows of this many quanta
+#define GROUP_CAP_WINDOW 10
+
+// Fair-share process groups. Ordinary processes are scheduled in two levels: the runnable
+// group with the least weighted CPU usage (virtual runtime) is picked from a min-heap in
+// O(log groups), then the most urgent process within it, round-robin per priority. A group
+// therefore gets CPU in proportion to its weight however many processes it has, and priorities
+// (including inherited ones) only order processes inside a group. A capped group is held off
+// the CPU for the rest of a window once it has used its cap.
+typedef struct ProcessGroup
+{
+    int id;
+    int weight;      // Relative share, 1 to 10000
+    int capPercent;  // Hard cap in percent of the CPU per window, 0 for none
+    long vruntime;   // Usage scaled by 1 / weight
+    long usage;      // Quanta used since start-up
+    int windowUsage; // Quanta used in the current cap window
+    bool throttled;  // Over its cap until the window ends
+    int heapIndex;   // Position in the runnable-group heap, -1 if absent
+    ProcessQueue queues[NUM_PRIORITIES];
+} ProcessGroup;
+
+// Resets every group to the default weight with no cap and no queued processes.
+void Group_init();
+
+// Sets a group's weight and cap. Returns false if any argument is out of range.
+bool Group_configure(int id, int weight, int capPercent);
+
+// Moves process into group id, requeueing it there if it is ready. Returns false for a bad id.
+bool Group_join(PCB *process, int id);
+
+ProcessGroup *Group_get(int id);
+
+// Queues a ready process on its group at the back (or front) of its priority level.
+void Group_enqueue(PCB *process, bool atFront);
+
+// Makes every process in waiters ready in one splice. They must share a group and a priority.
+void Group_enqueueAll(ProcessQueue *waiters);
+
+// Removes a queued process from its group. Returns true if it was queued.
+bool Group_dequeue(PCB *process);
+
+// True if process is linked into one of its group's ready queues.
+bool Group_isQueued(const PCB *process);
+
+// Removes and returns the next process of the runnable group with the least virtual runtime,
+// or NULL if no uncapped group has a ready process.
+PCB *Group_pickNext();
+
+// Charges quanta of CPU time to the group of a process that just ran.
+void Group_chargeQuantum(PCB *process, int quanta);
+
+// Starts a new cap window every GROUP_CAP_WINDOW quanta, letting throttled groups run again.
+void Group_advanceTime(long now);
+
+// Number of processes ready in all groups.
+int Group_readyCount();
+
+// Snapshot support (snapshot.h): every group with its ready queues and the runnable-group heap.
+struct SnapshotWriter;
+struct SnapshotReader;
+void Group_save(struct SnapshotWriter *writer);
+void Group_restore(struct SnapshotReader *reader);
+
+#endif // GROUP_H
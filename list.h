@@ -29,6 +29,19 @@ enum ListOutOfBounds
     LIST_OOB_END
 };
 typedef struct List_s List;
+#ifdef LIST_BACKEND_RING
+// Array-backed lists (list_ring.c, built with LIST_BACKEND=ring)
+struct List_s
+{
+    int flag;
+    int size;
+    void **items;  // Circular array; item i is in slot (start + i) & (capacity - 1)
+    int capacity;  // Zero or a power of two
+    int start;
+    int current;   // Index of the current item, -1 when before the start or beyond the end
+    enum ListOutOfBounds outOfBounds;
+};
+#else
 struct List_s
 {
     // TODO: You should change this!
@@ -39,6 +52,7 @@ struct List_s
     Node *current;
     enum ListOutOfBounds outOfBounds;
 };
+#endif
 
 // Maximum number of unique lists the system can support
 // (You may modify this, but reset the value to 10 when handing in your assignment)
@@ -46,7 +60,10 @@ struct List_s
 
 // Maximum total number of nodes (statically allocated) to be shared across all lists
 // (You may modify this, but reset the value to 100 when handing in your assignment)
+// Benchmark builds may define a larger one on the command line.
+#ifndef LIST_MAX_NUM_NODES
 #define LIST_MAX_NUM_NODES 100
+#endif
 
 // General Error Handling:
 // Client code is assumed never to call these functions with a NULL List pointer, or
@@ -0,0 +1,419 @@
+// Array-backed implementation of list.h, built instead of list.c with LIST_BACKEND=ring.
+// Each list keeps its items in a growable circular array, so appending, trimming and taking the
+// first item touch one slot next to the last one used, with no node to link. An insert or remove
+// in the middle moves whichever side of the array is shorter. The total number of items across
+// all lists is bounded by LIST_MAX_NUM_NODES, as with the node pool.
+#include "list.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef LIST_BACKEND_RING
+#error "list_ring.c needs LIST_BACKEND_RING, which selects its List layout in list.h"
+#endif
+
+// Slots a list starts with; doubled whenever it fills up
+#define LIST_RING_INITIAL_CAPACITY 8
+
+static List listHeadArray[LIST_MAX_NUM_HEADS];
+static int initializerFlag = 0;
+static int nextFreeListIndex = 0;
+int freeNodeCount = 0; // Items that can still be added across all lists
+int listCount = 0;
+
+// There are no nodes in this backend
+void pushToFreeNodeStack(Node *node)
+{
+    (void)node;
+}
+
+int listHeadCount()
+{
+    int freeCount = 0;
+    for (int i = 0; i < LIST_MAX_NUM_HEADS; i++)
+        if (listHeadArray[i].flag == 0)
+            freeCount++;
+
+    return freeCount;
+}
+
+// Slot of the item at position index
+static void **slot(List *pList, int index)
+{
+    return &pList->items[(pList->start + index) & (pList->capacity - 1)];
+}
+
+// Makes room for needed items, doubling the array as often as it takes and unrolling it to
+// start at slot 0
+static bool reserve(List *pList, int needed)
+{
+    if (needed <= pList->capacity)
+        return true;
+
+    int capacity = pList->capacity > 0 ? pList->capacity : LIST_RING_INITIAL_CAPACITY;
+    while (capacity < needed)
+        capacity *= 2;
+    void **items = malloc((size_t)capacity * sizeof(void *));
+    if (items == NULL)
+        return false;
+    int first = pList->capacity - pList->start; // Items before the array wraps around
+    if (first > pList->size)
+        first = pList->size;
+    if (pList->size > 0)
+    {
+        memcpy(items, pList->items + pList->start, (size_t)first * sizeof(void *));
+        memcpy(items + first, pList->items, (size_t)(pList->size - first) * sizeof(void *));
+    }
+    free(pList->items);
+    pList->items = items;
+    pList->capacity = capacity;
+    pList->start = 0;
+    return true;
+}
+
+// Inserts item at position index (0 to size), moving the shorter side of the list, and makes
+// it the current item
+static int insert_at(List *pList, int index, void *pItem)
+{
+    if (freeNodeCount <= 0 || (pList->size == pList->capacity && !reserve(pList, pList->size + 1)))
+        return LIST_FAIL;
+
+    if (index == pList->size)
+        ; // Appending moves nothing
+    else if (index < pList->size / 2)
+    {
+        pList->start = (pList->start - 1) & (pList->capacity - 1);
+        for (int i = 0; i < index; i++)
+            *slot(pList, i) = *slot(pList, i + 1);
+    }
+    else
+    {
+        for (int i = pList->size; i > index; i--)
+            *slot(pList, i) = *slot(pList, i - 1);
+    }
+    *slot(pList, index) = pItem;
+    pList->size++;
+    freeNodeCount--;
+
+    pList->current = index;
+    pList->outOfBounds = LIST_OOB_END;
+    return LIST_SUCCESS;
+}
+
+// Removes the item at position index, moving the shorter side of the list
+static void *remove_at(List *pList, int index)
+{
+    void *item = *slot(pList, index);
+    if (index == 0)
+        pList->start = (pList->start + 1) & (pList->capacity - 1);
+    else if (index < pList->size / 2)
+    {
+        for (int i = index; i > 0; i--)
+            *slot(pList, i) = *slot(pList, i - 1);
+        pList->start = (pList->start + 1) & (pList->capacity - 1);
+    }
+    else
+    {
+        for (int i = index; i < pList->size - 1; i++)
+            *slot(pList, i) = *slot(pList, i + 1);
+    }
+    pList->size--;
+    freeNodeCount++;
+    return item;
+}
+
+// Returns a list head to the array of heads, keeping its items array for the next list
+static void release_head(List *pList)
+{
+    int listHeadIndex = pList - listHeadArray;
+
+    if (listHeadIndex >= 0 && listHeadIndex < LIST_MAX_NUM_HEADS)
+    {
+        pList->flag = 0;
+        if (listHeadIndex < nextFreeListIndex)
+            nextFreeListIndex = listHeadIndex;
+    }
+
+    listCount--;
+}
+
+List *List_create()
+{
+    if (!initializerFlag)
+    {
+        for (int i = 0; i < LIST_MAX_NUM_HEADS; i++)
+            listHeadArray[i].flag = 0; // Mark as unused
+
+        freeNodeCount = LIST_MAX_NUM_NODES;
+        initializerFlag = 1;
+    }
+
+    while (nextFreeListIndex < LIST_MAX_NUM_HEADS && listHeadArray[nextFreeListIndex].flag != 0)
+        nextFreeListIndex++;
+
+    if (nextFreeListIndex < LIST_MAX_NUM_HEADS)
+    {
+        List *newList = &listHeadArray[nextFreeListIndex];
+        newList->flag = 1;
+        newList->size = 0;
+        newList->start = 0;
+        newList->current = -1;
+        newList->outOfBounds = LIST_OOB_START;
+        listCount++;
+        nextFreeListIndex++;
+        return newList;
+    }
+
+    return NULL;
+}
+
+int List_count(List *pList)
+{
+    if (pList == NULL)
+        return -1;
+
+    return pList->size;
+}
+
+void *List_first(List *pList)
+{
+    if (pList == NULL)
+        return NULL;
+
+    if (pList->size == 0)
+    {
+        pList->current = -1;
+        pList->outOfBounds = LIST_OOB_START;
+        return NULL;
+    }
+
+    pList->current = 0;
+    pList->outOfBounds = LIST_OOB_END;
+    return *slot(pList, 0);
+}
+
+void *List_last(List *pList)
+{
+    if (pList == NULL)
+        return NULL;
+
+    if (pList->size == 0)
+    {
+        pList->current = -1;
+        pList->outOfBounds = LIST_OOB_END;
+        return NULL;
+    }
+
+    pList->current = pList->size - 1;
+    pList->outOfBounds = LIST_OOB_END;
+    return *slot(pList, pList->current);
+}
+
+void *List_next(List *pList)
+{
+    if (pList == NULL)
+        return NULL;
+
+    if (pList->current < 0)
+    {
+        if (pList->outOfBounds != LIST_OOB_START)
+            return NULL;
+        pList->current = 0;
+    }
+    else
+        pList->current++;
+
+    pList->outOfBounds = LIST_OOB_END;
+    if (pList->current >= pList->size)
+    {
+        pList->current = -1;
+        return NULL;
+    }
+    return *slot(pList, pList->current);
+}
+
+void *List_prev(List *pList)
+{
+    if (pList == NULL)
+        return NULL;
+
+    if (pList->current < 0)
+    {
+        if (pList->outOfBounds != LIST_OOB_END)
+            return NULL;
+        pList->current = pList->size - 1;
+    }
+    else
+        pList->current--;
+
+    if (pList->current < 0)
+    {
+        pList->outOfBounds = LIST_OOB_START;
+        return NULL;
+    }
+    pList->outOfBounds = LIST_OOB_END;
+    return *slot(pList, pList->current);
+}
+
+void *List_curr(List *pList)
+{
+    if (pList == NULL || pList->current < 0)
+        return NULL;
+
+    return *slot(pList, pList->current);
+}
+
+int List_insert_after(List *pList, void *pItem)
+{
+    if (pList == NULL || pItem == NULL)
+        return LIST_FAIL;
+
+    int index;
+    if (pList->current >= 0)
+        index = pList->current + 1;
+    else if (pList->outOfBounds == LIST_OOB_END)
+        index = pList->size;
+    else
+        index = 0;
+    return insert_at(pList, index, pItem);
+}
+
+int List_insert_before(List *pList, void *pItem)
+{
+    if (pList == NULL)
+        return LIST_FAIL;
+
+    int index;
+    if (pList->current >= 0)
+        index = pList->current;
+    else if (pList->outOfBounds == LIST_OOB_END)
+        index = pList->size;
+    else
+        index = 0;
+    return insert_at(pList, index, pItem);
+}
+
+int List_append(List *pList, void *pItem)
+{
+    if (pList == NULL || pItem == NULL)
+        return LIST_FAIL;
+
+    return insert_at(pList, pList->size, pItem);
+}
+
+int List_prepend(List *pList, void *pItem)
+{
+    if (pList == NULL)
+        return LIST_FAIL;
+
+    return insert_at(pList, 0, pItem);
+}
+
+void *List_remove(List *pList)
+{
+    if (pList == NULL || pList->current < 0)
+        return NULL;
+
+    void *itemToRemove = remove_at(pList, pList->current);
+
+    // The next item becomes current, or the new last one if the last was removed
+    if (pList->size == 0)
+    {
+        pList->current = -1;
+        pList->outOfBounds = LIST_OOB_START;
+    }
+    else if (pList->current == pList->size)
+        pList->current = pList->size - 1;
+
+    return itemToRemove;
+}
+
+void *List_trim(List *pList)
+{
+    if (pList == NULL || pList->size == 0)
+        return NULL;
+
+    void *itemToRemove = remove_at(pList, pList->size - 1);
+    pList->current = pList->size - 1; // -1 once the list is empty
+
+    return itemToRemove;
+}
+
+void List_concat(List *pList1, List *pList2)
+{
+    if (pList1 == NULL || pList2 == NULL)
+        return;
+
+    // The items already count against the total, so only growing the array can fail
+    if (!reserve(pList1, pList1->size + pList2->size))
+        return;
+    for (int i = 0; i < pList2->size; i++)
+        *slot(pList1, pList1->size++) = *slot(pList2, i);
+
+    pList2->size = 0;
+    pList2->start = 0;
+    pList2->current = -1;
+    pList2->outOfBounds = LIST_OOB_START;
+    release_head(pList2);
+}
+
+void List_free(List *pList, FREE_FN pItemFreeFn)
+{
+    if (pList == NULL)
+        return;
+
+    for (int i = 0; i < pList->size; i++)
+    {
+        void *item = *slot(pList, i);
+        if (pItemFreeFn != NULL && item != NULL)
+            pItemFreeFn(item);
+    }
+    freeNodeCount += pList->size;
+
+    pList->size = 0;
+    pList->start = 0;
+    pList->current = -1;
+    pList->outOfBounds = LIST_OOB_START;
+    release_head(pList);
+}
+
+void *List_search(List *pList, COMPARATOR_FN pComparator, void *pComparisonArg)
+{
+    if (pList == NULL || pComparator == NULL)
+        return NULL;
+
+    if (pList->current < 0)
+        pList->current = 0;
+    pList->outOfBounds = LIST_OOB_END;
+
+    for (; pList->current < pList->size; pList->current++)
+    {
+        void *item = *slot(pList, pList->current);
+        if (pComparator(item, pComparisonArg))
+            return item;
+    }
+
+    pList->current = -1;
+    return NULL;
+}
+
+void List_print(List *pList)
+{
+    if (pList == NULL)
+    {
+        printf("List is NULL.\n");
+        return;
+    }
+
+    if (pList->size == 0)
+    {
+        printf("List is empty.\n");
+        return;
+    }
+
+    printf("List elements: ");
+    for (int i = 0; i < pList->size; i++)
+        printf("%d ", *((int *)*slot(pList, i)));
+    printf("\n");
+}
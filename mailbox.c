@@ -0,0 +1,623 @@
+#include "mailbox.h"
+#include "snapshot.h"
+#include "stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MAILBOX_INITIAL_BUCKETS 8
+
+// Entries, payloads, key queues and mailboxes are carved from slabs of this many objects and
+// recycled through free lists, so queueing a message does not normally call malloc.
+#define MAILBOX_SLAB_SIZE 256
+
+static long payloadCount = 0;
+static MessagePayload *freePayloads = NULL;
+static MailboxEntry *freeEntries = NULL; // Linked through next
+static MailboxKeyQueue *freeKeyQueues = NULL; // Linked through bucketNext
+static Mailbox *freeMailboxes = NULL;
+
+static MessagePayload *payload_alloc()
+{
+    if (freePayloads == NULL)
+    {
+        MessagePayload *slab = (MessagePayload *)malloc(MAILBOX_SLAB_SIZE * sizeof(MessagePayload));
+        if (slab == NULL)
+        {
+            return NULL;
+        }
+        for (int i = 0; i < MAILBOX_SLAB_SIZE; i++)
+        {
+            slab[i].nextFree = freePayloads;
+            freePayloads = &slab[i];
+        }
+    }
+    MessagePayload *payload = freePayloads;
+    freePayloads = payload->nextFree;
+    return payload;
+}
+
+static MailboxEntry *entry_alloc()
+{
+    if (freeEntries == NULL)
+    {
+        MailboxEntry *slab = (MailboxEntry *)malloc(MAILBOX_SLAB_SIZE * sizeof(MailboxEntry));
+        if (slab == NULL)
+        {
+            return NULL;
+        }
+        for (int i = 0; i < MAILBOX_SLAB_SIZE; i++)
+        {
+            slab[i].next = freeEntries;
+            freeEntries = &slab[i];
+        }
+    }
+    MailboxEntry *entry = freeEntries;
+    freeEntries = entry->next;
+    return entry;
+}
+
+static void entry_free(MailboxEntry *entry)
+{
+    entry->next = freeEntries;
+    freeEntries = entry;
+}
+
+static MailboxKeyQueue *key_queue_alloc()
+{
+    if (freeKeyQueues == NULL)
+    {
+        MailboxKeyQueue *slab = (MailboxKeyQueue *)malloc(MAILBOX_SLAB_SIZE * sizeof(MailboxKeyQueue));
+        if (slab == NULL)
+        {
+            return NULL;
+        }
+        for (int i = 0; i < MAILBOX_SLAB_SIZE; i++)
+        {
+            slab[i].bucketNext = freeKeyQueues;
+            freeKeyQueues = &slab[i];
+        }
+    }
+    MailboxKeyQueue *queue = freeKeyQueues;
+    freeKeyQueues = queue->bucketNext;
+    return queue;
+}
+
+static void key_queue_free(MailboxKeyQueue *queue)
+{
+    queue->bucketNext = freeKeyQueues;
+    freeKeyQueues = queue;
+}
+
+static Mailbox *mailbox_alloc()
+{
+    if (freeMailboxes == NULL)
+    {
+        Mailbox *slab = (Mailbox *)malloc(MAILBOX_SLAB_SIZE * sizeof(Mailbox));
+        if (slab == NULL)
+        {
+            return NULL;
+        }
+        for (int i = 0; i < MAILBOX_SLAB_SIZE; i++)
+        {
+            slab[i].nextFree = freeMailboxes;
+            freeMailboxes = &slab[i];
+        }
+    }
+    Mailbox *mailbox = freeMailboxes;
+    freeMailboxes = mailbox->nextFree;
+    return mailbox;
+}
+
+MessagePayload *Payload_create(const char *content)
+{
+    MessagePayload *payload = payload_alloc();
+    if (payload == NULL)
+    {
+        return NULL;
+    }
+    payload->refCount = 1;
+    strncpy(payload->content, content, MAX_MESSAGE_LENGTH - 1);
+    payload->content[MAX_MESSAGE_LENGTH - 1] = '\0'; // Ensure null-termination
+    payloadCount++;
+    return payload;
+}
+
+MessagePayload *Payload_share(MessagePayload *payload)
+{
+    if (payload != NULL)
+    {
+        payload->refCount++;
+    }
+    return payload;
+}
+
+void Payload_release(MessagePayload *payload)
+{
+    if (payload != NULL && --payload->refCount == 0)
+    {
+        payload->nextFree = freePayloads;
+        freePayloads = payload;
+        payloadCount--;
+    }
+}
+
+long Payload_liveCount()
+{
+    return payloadCount;
+}
+
+long Payload_liveBytes()
+{
+    return payloadCount * (long)sizeof(MessagePayload);
+}
+
+static unsigned int hash_key(int key)
+{
+    // Multiplicative hash so consecutive PIDs and tags spread across buckets
+    return (unsigned int)key * 2654435761u;
+}
+
+// Starts an index with no buckets; the first key queued allocates them
+static void index_init(MailboxIndex *index)
+{
+    index->buckets = NULL;
+    index->bucketCount = 0;
+    index->keyCount = 0;
+}
+
+static MailboxKeyQueue *index_find(const MailboxIndex *index, int key)
+{
+    if (index->bucketCount == 0)
+    {
+        return NULL;
+    }
+    MailboxKeyQueue *queue = index->buckets[hash_key(key) & (index->bucketCount - 1)];
+    while (queue != NULL && queue->key != key)
+    {
+        queue = queue->bucketNext;
+    }
+    return queue;
+}
+
+// Doubles the bucket array once the index averages more than two keys per bucket
+static void index_grow(MailboxIndex *index)
+{
+    int newCount = index->bucketCount > 0 ? index->bucketCount * 2 : MAILBOX_INITIAL_BUCKETS;
+    MailboxKeyQueue **newBuckets = (MailboxKeyQueue **)calloc(newCount, sizeof(MailboxKeyQueue *));
+    if (newBuckets == NULL)
+    {
+        return; // Keep working with longer chains
+    }
+    for (int i = 0; i < index->bucketCount; i++)
+    {
+        MailboxKeyQueue *queue = index->buckets[i];
+        while (queue != NULL)
+        {
+            MailboxKeyQueue *next = queue->bucketNext;
+            unsigned int bucket = hash_key(queue->key) & (newCount - 1);
+            queue->bucketNext = newBuckets[bucket];
+            newBuckets[bucket] = queue;
+            queue = next;
+        }
+    }
+    free(index->buckets);
+    index->buckets = newBuckets;
+    index->bucketCount = newCount;
+}
+
+// Returns the key queue for key, creating it if this is the first queued message with that key
+static MailboxKeyQueue *index_get(MailboxIndex *index, int key)
+{
+    MailboxKeyQueue *queue = index_find(index, key);
+    if (queue != NULL)
+    {
+        return queue;
+    }
+
+    queue = key_queue_alloc();
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+    if (index->keyCount >= index->bucketCount * 2)
+    {
+        index_grow(index);
+    }
+    if (index->bucketCount == 0)
+    {
+        key_queue_free(queue); // Could not allocate the first buckets
+        return NULL;
+    }
+    unsigned int bucket = hash_key(key) & (index->bucketCount - 1);
+    queue->key = key;
+    queue->count = 0;
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->bucketNext = index->buckets[bucket];
+    index->buckets[bucket] = queue;
+    index->keyCount++;
+    return queue;
+}
+
+// Unhooks an empty key queue from its bucket and returns it to the free list
+static void index_drop(MailboxIndex *index, MailboxKeyQueue *queue)
+{
+    MailboxKeyQueue **link = &index->buckets[hash_key(queue->key) & (index->bucketCount - 1)];
+    while (*link != queue)
+    {
+        link = &(*link)->bucketNext;
+    }
+    *link = queue->bucketNext;
+    index->keyCount--;
+    key_queue_free(queue);
+}
+
+static void index_free(MailboxIndex *index)
+{
+    for (int i = 0; i < index->bucketCount; i++)
+    {
+        MailboxKeyQueue *queue = index->buckets[i];
+        while (queue != NULL)
+        {
+            MailboxKeyQueue *next = queue->bucketNext;
+            key_queue_free(queue);
+            queue = next;
+        }
+    }
+    free(index->buckets);
+    index->buckets = NULL;
+}
+
+// Removes entry from the mailbox and from every index it is linked into. O(1).
+static void unlink_entry(Mailbox *mailbox, MailboxEntry *entry)
+{
+    if (entry->prev != NULL)
+        entry->prev->next = entry->next;
+    else
+        mailbox->head = entry->next;
+    if (entry->next != NULL)
+        entry->next->prev = entry->prev;
+    else
+        mailbox->tail = entry->prev;
+    mailbox->count--;
+    Stats_add(STATS_MAILBOX_MESSAGES, -1);
+
+    for (int kind = 0; kind < MAILBOX_NUM_INDEXES; kind++)
+    {
+        MailboxLink *link = &entry->links[kind];
+        MailboxKeyQueue *queue = link->queue;
+        if (link->prev != NULL)
+            link->prev->links[kind].next = link->next;
+        else
+            queue->head = link->next;
+        if (link->next != NULL)
+            link->next->links[kind].prev = link->prev;
+        else
+            queue->tail = link->prev;
+
+        if (--queue->count == 0)
+        {
+            index_drop(&mailbox->indexes[kind], queue);
+        }
+    }
+}
+
+// Unlinks entry, copies it out to the caller and drops the entry's payload reference
+static void take_entry(Mailbox *mailbox, MailboxEntry *entry, Message *out)
+{
+    unlink_entry(mailbox, entry);
+    memcpy(out->content, entry->payload->content, MAX_MESSAGE_LENGTH);
+    out->senderPid = entry->senderPid;
+    out->tag = entry->tag;
+    Payload_release(entry->payload);
+    entry_free(entry);
+}
+
+Mailbox *Mailbox_create()
+{
+    Mailbox *mailbox = mailbox_alloc();
+    if (mailbox == NULL)
+    {
+        return NULL;
+    }
+    mailbox->count = 0;
+    mailbox->capacity = MAILBOX_DEFAULT_CAPACITY;
+    mailbox->head = NULL;
+    mailbox->tail = NULL;
+    for (int kind = 0; kind < MAILBOX_NUM_INDEXES; kind++)
+    {
+        index_init(&mailbox->indexes[kind]);
+    }
+    return mailbox;
+}
+
+void Mailbox_free(Mailbox *mailbox)
+{
+    if (mailbox == NULL)
+    {
+        return;
+    }
+    Stats_add(STATS_MAILBOX_MESSAGES, -mailbox->count);
+    MailboxEntry *entry = mailbox->head;
+    while (entry != NULL)
+    {
+        MailboxEntry *next = entry->next;
+        Payload_release(entry->payload);
+        entry_free(entry);
+        entry = next;
+    }
+    for (int kind = 0; kind < MAILBOX_NUM_INDEXES; kind++)
+    {
+        index_free(&mailbox->indexes[kind]);
+    }
+    mailbox->nextFree = freeMailboxes;
+    freeMailboxes = mailbox;
+}
+
+int Mailbox_count(const Mailbox *mailbox)
+{
+    return mailbox != NULL ? mailbox->count : 0;
+}
+
+bool Mailbox_isFull(const Mailbox *mailbox)
+{
+    return mailbox != NULL && mailbox->count >= mailbox->capacity;
+}
+
+void Mailbox_setCapacity(Mailbox *mailbox, int capacity)
+{
+    if (mailbox != NULL && capacity >= 1)
+    {
+        mailbox->capacity = capacity;
+    }
+}
+
+int Mailbox_countMatching(const Mailbox *mailbox, MailboxIndexKind kind, int key)
+{
+    if (mailbox == NULL || kind < 0 || kind >= MAILBOX_NUM_INDEXES)
+    {
+        return 0;
+    }
+    MailboxKeyQueue *queue = index_find(&mailbox->indexes[kind], key);
+    return queue != NULL ? queue->count : 0;
+}
+
+bool Mailbox_put(Mailbox *mailbox, const Message *message)
+{
+    if (mailbox == NULL || message == NULL || mailbox->count >= mailbox->capacity)
+    {
+        return false;
+    }
+
+    MessagePayload *payload = Payload_create(message->content);
+    if (payload == NULL)
+    {
+        return false;
+    }
+    bool queued = Mailbox_putShared(mailbox, payload, message->senderPid, message->tag);
+    Payload_release(payload); // The mailbox holds its own reference on success
+    return queued;
+}
+
+// Finds (or creates) the key queue of every index for one sender and tag. On failure, queues
+// created here are dropped again so the mailbox is left untouched.
+static bool get_key_queues(Mailbox *mailbox, int senderPid, int tag, MailboxKeyQueue *queues[])
+{
+    for (int kind = 0; kind < MAILBOX_NUM_INDEXES; kind++)
+    {
+        queues[kind] = index_get(&mailbox->indexes[kind], kind == MAILBOX_BY_SENDER ? senderPid : tag);
+        if (queues[kind] == NULL)
+        {
+            while (kind-- > 0)
+            {
+                if (queues[kind]->count == 0)
+                {
+                    index_drop(&mailbox->indexes[kind], queues[kind]);
+                }
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+// Links entry at the back of the mailbox and of its key queues
+static void link_entry(Mailbox *mailbox, MailboxEntry *entry, MailboxKeyQueue *queues[])
+{
+    entry->next = NULL;
+    entry->prev = mailbox->tail;
+    if (mailbox->tail != NULL)
+        mailbox->tail->next = entry;
+    else
+        mailbox->head = entry;
+    mailbox->tail = entry;
+    mailbox->count++;
+    Stats_add(STATS_MAILBOX_MESSAGES, 1);
+
+    for (int kind = 0; kind < MAILBOX_NUM_INDEXES; kind++)
+    {
+        MailboxKeyQueue *queue = queues[kind];
+        MailboxLink *link = &entry->links[kind];
+        link->queue = queue;
+        link->next = NULL;
+        link->prev = queue->tail;
+        if (queue->tail != NULL)
+            queue->tail->links[kind].next = entry;
+        else
+            queue->head = entry;
+        queue->tail = entry;
+        queue->count++;
+    }
+}
+
+// Drops key queues that get_key_queues created but no entry was linked into
+static void release_empty_queues(Mailbox *mailbox, MailboxKeyQueue *queues[])
+{
+    for (int kind = 0; kind < MAILBOX_NUM_INDEXES; kind++)
+    {
+        if (queues[kind]->count == 0)
+        {
+            index_drop(&mailbox->indexes[kind], queues[kind]);
+        }
+    }
+}
+
+bool Mailbox_putShared(Mailbox *mailbox, MessagePayload *payload, int senderPid, int tag)
+{
+    if (mailbox == NULL || payload == NULL || mailbox->count >= mailbox->capacity)
+    {
+        return false;
+    }
+
+    MailboxKeyQueue *queues[MAILBOX_NUM_INDEXES];
+    if (!get_key_queues(mailbox, senderPid, tag, queues))
+    {
+        return false;
+    }
+    MailboxEntry *entry = entry_alloc();
+    if (entry == NULL)
+    {
+        release_empty_queues(mailbox, queues);
+        return false;
+    }
+    entry->senderPid = senderPid;
+    entry->tag = tag;
+    entry->payload = Payload_share(payload);
+    link_entry(mailbox, entry, queues);
+    return true;
+}
+
+int Mailbox_putMany(Mailbox *mailbox, const char *const *contents, int count, int senderPid, int tag)
+{
+    if (mailbox == NULL || contents == NULL || count <= 0)
+    {
+        return 0;
+    }
+    int room = mailbox->capacity - mailbox->count;
+    if (count > room)
+    {
+        count = room;
+    }
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    MailboxKeyQueue *queues[MAILBOX_NUM_INDEXES];
+    if (!get_key_queues(mailbox, senderPid, tag, queues))
+    {
+        return 0;
+    }
+    int queued = 0;
+    while (queued < count)
+    {
+        MailboxEntry *entry = entry_alloc();
+        MessagePayload *payload = entry != NULL ? Payload_create(contents[queued]) : NULL;
+        if (payload == NULL)
+        {
+            if (entry != NULL)
+            {
+                entry_free(entry);
+            }
+            break;
+        }
+        entry->senderPid = senderPid;
+        entry->tag = tag;
+        entry->payload = payload; // The mailbox owns the only reference
+        link_entry(mailbox, entry, queues);
+        queued++;
+    }
+    if (queued == 0)
+    {
+        release_empty_queues(mailbox, queues);
+    }
+    return queued;
+}
+
+bool Mailbox_take(Mailbox *mailbox, Message *out)
+{
+    if (mailbox == NULL || out == NULL || mailbox->head == NULL)
+    {
+        return false;
+    }
+    MailboxEntry *entry = mailbox->head;
+    take_entry(mailbox, entry, out);
+    return true;
+}
+
+int Mailbox_takeMany(Mailbox *mailbox, Message *out, int max)
+{
+    if (mailbox == NULL || out == NULL)
+    {
+        return 0;
+    }
+    int taken = 0;
+    while (taken < max && mailbox->head != NULL)
+    {
+        take_entry(mailbox, mailbox->head, &out[taken]);
+        taken++;
+    }
+    return taken;
+}
+
+bool Mailbox_takeMatching(Mailbox *mailbox, MailboxIndexKind kind, int key, Message *out)
+{
+    if (mailbox == NULL || out == NULL || kind < 0 || kind >= MAILBOX_NUM_INDEXES)
+    {
+        return false;
+    }
+    MailboxKeyQueue *queue = index_find(&mailbox->indexes[kind], key);
+    if (queue == NULL)
+    {
+        return false;
+    }
+    MailboxEntry *entry = queue->head;
+    take_entry(mailbox, entry, out);
+    return true;
+}
+
+void Mailbox_save(SnapshotWriter *writer, const Mailbox *mailbox)
+{
+    Snapshot_putInt(writer, mailbox->capacity);
+    Snapshot_putInt(writer, mailbox->count);
+    for (const MailboxEntry *entry = mailbox->head; entry != NULL; entry = entry->next)
+    {
+        if (Snapshot_putObject(writer, entry->payload))
+        {
+            Snapshot_putBytes(writer, entry->payload->content, MAX_MESSAGE_LENGTH);
+        }
+        Snapshot_putInt(writer, entry->senderPid);
+        Snapshot_putInt(writer, entry->tag);
+    }
+}
+
+void Mailbox_restore(SnapshotReader *reader, Mailbox *mailbox)
+{
+    int capacity = Snapshot_getInt(reader);
+    int count = Snapshot_getInt(reader);
+    mailbox->capacity = count + 1; // Messages beyond a lowered capacity were queued before it was lowered
+    for (int i = 0; i < count && !reader->failed; i++)
+    {
+        bool isNew;
+        MessagePayload *payload = Snapshot_getObject(reader, &isNew);
+        if (isNew)
+        {
+            char content[MAX_MESSAGE_LENGTH];
+            Snapshot_getBytes(reader, content, sizeof(content));
+            content[MAX_MESSAGE_LENGTH - 1] = '\0';
+            payload = Payload_create(content);
+            Snapshot_addObject(reader, payload);
+        }
+        int senderPid = Snapshot_getInt(reader);
+        int tag = Snapshot_getInt(reader);
+        if (payload == NULL || !Mailbox_putShared(mailbox, payload, senderPid, tag))
+        {
+            reader->failed = true;
+        }
+        if (isNew)
+        {
+            Payload_release(payload); // The mailbox holds its own reference now
+        }
+    }
+    mailbox->capacity = capacity;
+}
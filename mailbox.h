@@ -0,0 +1,150 @@
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <stdbool.h>
+
+#define MAX_MESSAGE_LENGTH 40
+
+// Messages a mailbox accepts before senders are held back
+#define MAILBOX_DEFAULT_CAPACITY 64
+
+typedef struct Message
+{
+    char content[MAX_MESSAGE_LENGTH]; // Assume MAX_MESSAGE_LENGTH is defined somewhere
+    int senderPid;                    // Process ID of the sender
+    int tag;                          // Caller-defined message kind, 0 if untagged
+} Message;
+
+// Immutable, reference-counted message body. A multicast queues one payload in every
+// recipient's mailbox; it is freed when the last recipient has taken its copy.
+typedef struct MessagePayload
+{
+    int refCount;
+    char content[MAX_MESSAGE_LENGTH];
+    struct MessagePayload *nextFree; // Free-list link while the payload is pooled
+} MessagePayload;
+
+// Keys a mailbox keeps an index on, so a filtered receive does not scan the queue
+typedef enum
+{
+    MAILBOX_BY_SENDER,
+    MAILBOX_BY_TAG,
+    MAILBOX_NUM_INDEXES
+} MailboxIndexKind;
+
+typedef struct MailboxEntry MailboxEntry;
+typedef struct MailboxKeyQueue MailboxKeyQueue;
+
+// Links of one entry within one index: the queue of entries sharing its key
+typedef struct MailboxLink
+{
+    MailboxEntry *next;
+    MailboxEntry *prev;
+    MailboxKeyQueue *queue;
+} MailboxLink;
+
+struct MailboxEntry
+{
+    MessagePayload *payload; // Shared with every other mailbox the message was multicast to
+    int senderPid;
+    int tag;
+    MailboxEntry *next; // Arrival order across the whole mailbox
+    MailboxEntry *prev;
+    MailboxLink links[MAILBOX_NUM_INDEXES];
+};
+
+// FIFO of the entries that share one key, chained into a hash bucket
+struct MailboxKeyQueue
+{
+    int key;
+    int count;
+    MailboxEntry *head;
+    MailboxEntry *tail;
+    MailboxKeyQueue *bucketNext;
+};
+
+typedef struct MailboxIndex
+{
+    MailboxKeyQueue **buckets;
+    int bucketCount; // Zero until a key is first added, then always a power of two
+    int keyCount;    // Number of non-empty key queues
+} MailboxIndex;
+
+// Message queue of one process. Messages are kept in arrival order and indexed by sender PID
+// and by tag, so taking the oldest message overall, from one sender, or with one tag is O(1)
+// (expected) regardless of how many messages are queued.
+typedef struct Mailbox
+{
+    int count;
+    int capacity; // Puts fail once count reaches capacity
+    MailboxEntry *head;
+    MailboxEntry *tail;
+    MailboxIndex indexes[MAILBOX_NUM_INDEXES];
+    struct Mailbox *nextFree; // Links free mailboxes
+} Mailbox;
+
+// Creates a payload holding a copy of content (truncated to MAX_MESSAGE_LENGTH - 1 characters)
+// with one reference owned by the caller. Returns NULL on failure.
+MessagePayload *Payload_create(const char *content);
+
+// Adds a reference to payload and returns it.
+MessagePayload *Payload_share(MessagePayload *payload);
+
+// Drops a reference to payload, freeing it when the last one goes.
+void Payload_release(MessagePayload *payload);
+
+// Number of payloads currently allocated and their total size in bytes.
+long Payload_liveCount();
+long Payload_liveBytes();
+
+// Makes a new, empty mailbox. Returns NULL on failure.
+Mailbox *Mailbox_create();
+
+// Frees the mailbox and every message still queued in it.
+void Mailbox_free(Mailbox *mailbox);
+
+// Returns the number of queued messages.
+int Mailbox_count(const Mailbox *mailbox);
+
+// Returns true if the mailbox holds capacity messages and will refuse new ones.
+bool Mailbox_isFull(const Mailbox *mailbox);
+
+// Changes how many messages the mailbox accepts. Messages already queued beyond the new
+// capacity are kept. Capacity must be at least 1.
+void Mailbox_setCapacity(Mailbox *mailbox, int capacity);
+
+// Returns the number of queued messages whose key of the given kind equals key. O(1) expected.
+int Mailbox_countMatching(const Mailbox *mailbox, MailboxIndexKind kind, int key);
+
+// Queues a copy of message at the back of the mailbox.
+// Returns false if the mailbox is full or on allocation failure.
+bool Mailbox_put(Mailbox *mailbox, const Message *message);
+
+// Queues payload at the back of the mailbox without copying it; the mailbox takes its own
+// reference. Returns false if the mailbox is full or on allocation failure.
+bool Mailbox_putShared(Mailbox *mailbox, MessagePayload *payload, int senderPid, int tag);
+
+// Queues up to count messages from one sender, all with the same tag, in order. Index lookups
+// and the capacity check are done once for the whole batch.
+// Returns how many messages were queued; fewer than count if the mailbox filled up.
+int Mailbox_putMany(Mailbox *mailbox, const char *const *contents, int count, int senderPid, int tag);
+
+// Removes the oldest message into *out. Returns false if the mailbox is empty.
+bool Mailbox_take(Mailbox *mailbox, Message *out);
+
+// Removes up to max of the oldest messages into out[0..max-1], oldest first.
+// Returns the number of messages removed.
+int Mailbox_takeMany(Mailbox *mailbox, Message *out, int max);
+
+// Removes the oldest message whose key of the given kind equals key into *out.
+// Returns false if there is no such message. O(1) expected.
+bool Mailbox_takeMatching(Mailbox *mailbox, MailboxIndexKind kind, int key, Message *out);
+
+// Snapshot support (snapshot.h): writes the capacity and queued messages in arrival order, and
+// queues them again into an empty mailbox. Payloads shared between mailboxes stay shared.
+struct SnapshotWriter;
+struct SnapshotReader;
+void Mailbox_save(struct SnapshotWriter *writer, const Mailbox *mailbox);
+void Mailbox_restore(struct SnapshotReader *reader, Mailbox *mailbox);
+
+#endif // MAILBOX_H
@@ -1,90 +1,158 @@
 #include "scheduler.h"
 #include "commands.h"
 #include "list.h"
+#include "pidtable.h"
+#include "group.h"
+#include "device.h"
+#include "snapshot.h"
+#include "shell.h"
+#include "server.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 const int INIT_PROCESS_PID = 1;
 const int INIT_PRIORITY = 0; // or whatever priority level you decide for "init"
 extern int get_next_pid(void);
-extern int nextPid;
 
-int main()
+// Usage: run [-p maxPids] [-r snapshot] [-l commandLog] [-y replayLog] [-f event] [-s socket | -m ring]
+// With -r the simulator starts from a snapshot instead of a fresh init process. With -l every
+// command is appended to the log; combined with -r, the commands logged after the snapshot
+// are replayed first, which brings the simulator back to where the logged session ended.
+// With -y the commands of a recorded log are replayed from its start before anything else, and
+// -f hides all output until the given event of the replay so a point deep in a long run is
+// reached quickly.
+// With -s the commands come from clients of a Unix-domain socket instead of stdin, and with -m
+// from drivers writing binary commands into a shared-memory ring.
+int main(int argc, char **argv)
 {
-    char command;
-    int priority;
-    int pid;
+    int maxPids = -1;
+    const char *snapshotPath = NULL;
+    const char *logPath = NULL;
+    const char *socketPath = NULL;
+    const char *ringName = NULL;
+    const char *replayPath = NULL;
+    long fastForward = 0;
+    int option;
+
+    while ((option = getopt(argc, argv, "p:r:l:y:f:s:m:")) != -1)
+    {
+        switch (option)
+        {
+        case 'p':
+            maxPids = atoi(optarg);
+            break;
+        case 'r':
+            snapshotPath = optarg;
+            break;
+        case 'l':
+            logPath = optarg;
+            break;
+        case 'y':
+            replayPath = optarg;
+            break;
+        case 'f':
+            fastForward = atol(optarg);
+            break;
+        case 's':
+            socketPath = optarg;
+            break;
+        case 'm':
+            ringName = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-p maxPids] [-r snapshot] [-l commandLog] [-y replayLog] [-f event] "
+                            "[-s socket | -m ring]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    // A replay has to hand out the same PIDs as the recorded run
+    if (maxPids < 0 && replayPath)
+    {
+        maxPids = Shell_recordedMaxPids(replayPath);
+    }
+    if (maxPids < 0)
+    {
+        maxPids = PID_TABLE_DEFAULT_MAX;
+    }
 
     // Initialization
     Scheduler_init();
+    Device_init();
+    Shell_setFastForward(fastForward);
 
-    PCB *initProcess = createPCB(INIT_PROCESS_PID, INIT_PRIORITY); // Only pass priority, as createPCB now generates PID internally
-    if (initProcess)
+    if (snapshotPath)
     {
-        initProcess->pid = INIT_PROCESS_PID; // Explicitly set PID for init process
-        initProcess->state = RUNNING;
-        Scheduler_scheduleProcess(initProcess);
-        Scheduler_setCurrentProcess(initProcess);
-        nextPid = INIT_PROCESS_PID + 1;
-        printf("Init process created and running with PID: %d and Priority: %d\n", INIT_PROCESS_PID, INIT_PRIORITY);
+        long logOffset;
+        if (!Snapshot_restore(snapshotPath, &logOffset))
+        {
+            printf("Failed to restore snapshot %s.\n", snapshotPath);
+            return -1;
+        }
+        printf("Restored snapshot %s.\n", snapshotPath);
+        if (logPath && logOffset >= 0 && !Shell_replay(logPath, logOffset))
+        {
+            printf("Failed to replay command log %s.\n", logPath);
+            return -1;
+        }
     }
     else
     {
-        printf("Failed to create init process.\n");
+        if (!PidTable_init(maxPids))
+        {
+            printf("Failed to create a process table with %d slots.\n", maxPids);
+            return -1;
+        }
+
+        // The process table hands out its first slot first, so init always gets INIT_PROCESS_PID
+        int initPid = get_next_pid();
+        PCB *initProcess = initPid == INIT_PROCESS_PID ? createPCB(initPid, INIT_PRIORITY) : NULL;
+        if (initProcess)
+        {
+            Scheduler_setInitProcess(initProcess);
+            Scheduler_setCurrentProcess(initProcess);
+            printf("Init process created and running with PID: %d and Priority: %d\n", INIT_PROCESS_PID, INIT_PRIORITY);
+        }
+        else
+        {
+            printf("Failed to create init process.\n");
+            return -1;
+        }
+    }
+
+    if (replayPath && !Shell_replay(replayPath, 0))
+    {
+        printf("Failed to replay command log %s.\n", replayPath);
         return -1;
     }
-    nextPid = INIT_PROCESS_PID + 1;
 
-     printf("Enter command (C - Create, F - Fork, K - Kill, E - Exit, Q - Quit): ");
+    if (logPath && !Shell_openLog(logPath))
+    {
+        printf("Failed to open command log %s.\n", logPath);
+        return -1;
+    }
 
-    while (scanf(" %c", &command) == 1)
-    { // Note the space before %c to skip any leading whitespace
-        switch (command)
+    bool quit;
+    if (socketPath || ringName)
+    {
+        quit = socketPath ? Server_run(socketPath) : Server_runRing(ringName);
+        if (!quit)
         {
-        case 'C':
-        case 'c': // For case-insensitivity
-            printf("Enter priority (0=high, 1=norm, 2=low): ");
-            if (scanf("%d", &priority) != 1)
-            {
-                printf("Invalid input for priority.\n");
-                // Clean stdin buffer
-                while (getchar() != '\n')
-                    ;
-                break;
-            }
-            Commands_CreateProcess(priority);
-            break;
-        case 'F':
-        case 'f':
-            Commands_Fork();
-            break;
-        case 'K':
-        case 'k':
-            printf("Enter PID of process to kill: ");
-            if (scanf("%d", &pid) != 1)
-            {
-                printf("Invalid input for PID.\n");
-                // Clean stdin buffer
-                while (getchar() != '\n')
-                    ;
-                break;
-            }
-            Commands_Kill(pid);
-            break;
-        case 'Q':
-        case 'q':
-            printf("Exiting program.\n");
-            return 0;
-
-        case 'E':
-        case 'e':
-            Commands_Exit();
-            break;
-        default:
-            printf("Invalid command.\n");
+            return -1;
         }
-        // In main.c, within the main loop where you prompt for user commands
-        printf("Enter command (C - Create, F - Fork, K - Kill, E - Exit, Q - Quit): ");
+    }
+    else
+    {
+        quit = Shell_run(stdin);
+    }
+    Shell_closeLog();
+    if (quit)
+    {
+        Shell_setFastForward(0); // Always show the statistics
+        Shell_printStats();
+        printf("Exiting program.\n");
     }
 
     return 0;
-}
\ No newline at end of file
+}
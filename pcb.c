@@ -4,77 +4,461 @@
 
 // Creates a new PCB instance with specified PID and priority
 #include "pcb.h"
+#include "pidtable.h"
+#include "workload.h"
+#include "program.h"
+#include "device.h"
+#include "snapshot.h"
+#include "scheduler.h"
+#include "deadlock.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 extern int get_next_pid(void);
 
+// PCBs are carved from slabs of this many and recycled through a free list, as mailbox entries
+// are, so creating a process does not normally call malloc
+#define PCB_SLAB_SIZE 256
+
+static PCB *freePCBs = NULL; // Linked through queueNext
+static int freePCBCount = 0;
+
+// Adds a slab of count PCBs to the free list. Returns false if it cannot be allocated.
+static bool add_pcb_slab(int count)
+{
+    PCB *slab = (PCB *)malloc((size_t)count * sizeof(PCB));
+    if (slab == NULL)
+    {
+        return false;
+    }
+    for (int i = count - 1; i >= 0; i--)
+    {
+        slab[i].queueNext = freePCBs;
+        freePCBs = &slab[i];
+    }
+    freePCBCount += count;
+    return true;
+}
+
+static PCB *pcb_alloc()
+{
+    if (freePCBs == NULL && !add_pcb_slab(PCB_SLAB_SIZE))
+    {
+        return NULL;
+    }
+    PCB *pcb = freePCBs;
+    freePCBs = pcb->queueNext;
+    freePCBCount--;
+    return pcb;
+}
+
+static void pcb_free(PCB *pcb)
+{
+    pcb->queueNext = freePCBs;
+    freePCBs = pcb;
+    freePCBCount++;
+}
+
+bool reservePCBs(int count)
+{
+    return count <= freePCBCount || add_pcb_slab(count - freePCBCount);
+}
+
 // Creates a new PCB instance with the specified priority and assigns a unique PID
 PCB *createPCB(int pid, int priority) {
-    PCB *pcb = (PCB *)malloc(sizeof(PCB));
+    PCB *pcb = pcb_alloc();
     if (pcb == NULL) {
         return NULL;
     }
 
     pcb->pid = pid;  // Use the pid argument to assign the PID
     pcb->priority = priority;
+    pcb->basePriority = priority;
     pcb->state = READY;
-    pcb->messageQueue = List_create();
+    pcb->mailbox = Mailbox_create();
+    pcb->waitingSemaphore = -1;
+    pcb->senderPid = -1;
+    pcb->receiveFilter = -1;
+    pcb->receiveKey = 0;
+    for (int i = 0; i < PCB_NUM_STATE_BLOCKS; i++) {
+        pcb->stateBlocks[i] = NULL;
+    }
+    processQueueInit(&pcb->blockedSenders);
+    processQueueInit(&pcb->replyWaiters);
+    pcb->pendingMessage = NULL;
+    pcb->pendingTag = 0;
+    pcb->queueNext = NULL;
+    pcb->queuePrev = NULL;
+    pcb->queue = NULL;
+    pcb->waitsForPid = -1;
+    pcb->waitsOnSemaphore = NULL;
+    pcb->heldSemaphoreCount = 0;
+    pcb->sliceUsed = 0;
+    pcb->burstEstimate = 0;
+    pcb->readySince = -1;
+    pcb->ioRequest = NULL;
+    pcb->workload = NULL;
+    pcb->groupId = 0;
+    pcb->rtPeriod = 0;
+    pcb->rtBudget = 0;
+    pcb->rtBudgetLeft = 0;
+    pcb->rtDeadline = 0;
+    pcb->rtNextRelease = 0;
+    pcb->rtDeadlineMisses = 0;
+    pcb->rtReadyIndex = -1;
+    pcb->rtReleaseIndex = -1;
+    pcb->pendingSignals = 0;
+    pcb->handledSignals = 0;
+    pcb->ignoredSignals = 0;
+    pcb->program = NULL;
+
+    if (pcb->mailbox == NULL) {
+        pcb_free(pcb);
+        return NULL;
+    }
 
-    if (pcb->messageQueue == NULL) {
-        free(pcb);
+    // Make the PCB reachable through its PID in O(1)
+    if (!PidTable_bind(pid, pcb)) {
+        Mailbox_free(pcb->mailbox);
+        pcb_free(pcb);
         return NULL;
     }
 
     return pcb;
 }
 
+// Wakes a sender blocked on a process that is going away. Its send fails.
+static void fail_send(PCB *sender, int receiverPid)
+{
+    sender->senderPid = -1;
+    Deadlock_clearWait(sender);
+    Program_interrupt(sender); // A process body sees its send return -1
+    Scheduler_scheduleProcess(sender);
+    printf("Send from PID %d failed: process with PID %d is gone.\n", sender->pid, receiverPid);
+}
+
 // Destroys a PCB instance and frees its allocated memory, including the message queue
 void destroyPCB(PCB *pcb)
 {
     if (pcb != NULL)
     {
-        // Free all messages in the message queue
-        void *message;
-        while ((message = List_trim(pcb->messageQueue)) != NULL)
+        // Free the mailbox along with every message still queued in it
+        Mailbox_free(pcb->mailbox);
+        // Senders held back by this mailbox will never get room; drop their pending messages
+        PCB *sender;
+        while ((sender = processQueuePop(&pcb->blockedSenders)) != NULL)
+        {
+            Payload_release(sender->pendingMessage);
+            sender->pendingMessage = NULL;
+            fail_send(sender, pcb->pid);
+        }
+        // Senders waiting for a reply from this process will never get one
+        while ((sender = processQueuePop(&pcb->replyWaiters)) != NULL)
+        {
+            fail_send(sender, pcb->pid);
+        }
+        // Leave whatever queue this process is waiting in
+        processQueueRemove(pcb);
+        Payload_release(pcb->pendingMessage);
+        // Drop this process's references to its per-process state
+        for (int i = 0; i < PCB_NUM_STATE_BLOCKS; i++)
+        {
+            Cow_release(pcb->stateBlocks[i]);
+        }
+        Device_cancel(pcb);
+        Workload_free(pcb);
+        Program_free(pcb);
+        PidTable_release(pcb->pid); // Return the PID; stale copies of it are now rejected
+        pcb_free(pcb); // Back to the free list for the next process
+    }
+}
+
+// Makes child share every per-process state block of parent. The blocks are only copied
+// when one of the two processes first writes to them, so fork cost does not grow with state size.
+void sharePCBState(PCB *child, const PCB *parent)
+{
+    if (child == NULL || parent == NULL)
+    {
+        return;
+    }
+    for (int i = 0; i < PCB_NUM_STATE_BLOCKS; i++)
+    {
+        child->stateBlocks[i] = Cow_share(parent->stateBlocks[i]);
+    }
+}
+
+// Returns read-only access to a per-process state block, or NULL if it was never written
+const void *readPCBState(const PCB *pcb, PcbStateBlock which)
+{
+    if (pcb == NULL || which < 0 || which >= PCB_NUM_STATE_BLOCKS)
+    {
+        return NULL;
+    }
+    return Cow_read(pcb->stateBlocks[which]);
+}
+
+// Returns writable access to a per-process state block, creating it with size bytes on first use
+// and taking a private copy if it is still shared with a parent or child
+void *writePCBState(PCB *pcb, PcbStateBlock which, size_t size)
+{
+    if (pcb == NULL || which < 0 || which >= PCB_NUM_STATE_BLOCKS)
+    {
+        return NULL;
+    }
+    if (pcb->stateBlocks[which] == NULL)
+    {
+        pcb->stateBlocks[which] = Cow_create(size);
+        if (pcb->stateBlocks[which] == NULL)
+        {
+            return NULL;
+        }
+    }
+    return Cow_write(&pcb->stateBlocks[which]);
+}
+
+void processQueueInit(ProcessQueue *queue)
+{
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->count = 0;
+}
+
+// Links pcb at the back of queue. The process must not already be in a queue.
+void processQueueAppend(ProcessQueue *queue, PCB *pcb)
+{
+    pcb->queue = queue;
+    pcb->queueNext = NULL;
+    pcb->queuePrev = queue->tail;
+    if (queue->tail != NULL)
+        queue->tail->queueNext = pcb;
+    else
+        queue->head = pcb;
+    queue->tail = pcb;
+    queue->count++;
+}
+
+// Links pcb at the front of queue. The process must not already be in a queue.
+void processQueuePrepend(ProcessQueue *queue, PCB *pcb)
+{
+    pcb->queue = queue;
+    pcb->queuePrev = NULL;
+    pcb->queueNext = queue->head;
+    if (queue->head != NULL)
+        queue->head->queuePrev = pcb;
+    else
+        queue->tail = pcb;
+    queue->head = pcb;
+    queue->count++;
+}
+
+// Unlinks and returns the process at the front of queue, or NULL if it is empty
+PCB *processQueuePop(ProcessQueue *queue)
+{
+    PCB *pcb = queue->head;
+    if (pcb != NULL)
+    {
+        processQueueRemove(pcb);
+    }
+    return pcb;
+}
+
+// Unlinks pcb from whichever queue holds it. Does nothing if it is not queued.
+void processQueueRemove(PCB *pcb)
+{
+    ProcessQueue *queue = pcb->queue;
+    if (queue == NULL)
+    {
+        return;
+    }
+    if (pcb->queuePrev != NULL)
+        pcb->queuePrev->queueNext = pcb->queueNext;
+    else
+        queue->head = pcb->queueNext;
+    if (pcb->queueNext != NULL)
+        pcb->queueNext->queuePrev = pcb->queuePrev;
+    else
+        queue->tail = pcb->queuePrev;
+    queue->count--;
+    pcb->queue = NULL;
+    pcb->queueNext = NULL;
+    pcb->queuePrev = NULL;
+}
+
+// Moves every process in from to the back of queue, keeping their order, and leaves from empty.
+// The chains are joined without relinking, but each moved PCB has its queue pointer updated,
+// so this is O(n) in the number moved.
+void processQueueSplice(ProcessQueue *queue, ProcessQueue *from)
+{
+    if (from->head == NULL || queue == from)
+    {
+        return;
+    }
+    for (PCB *pcb = from->head; pcb != NULL; pcb = pcb->queueNext)
+    {
+        pcb->queue = queue;
+    }
+    from->head->queuePrev = queue->tail;
+    if (queue->tail != NULL)
+        queue->tail->queueNext = from->head;
+    else
+        queue->head = from->head;
+    queue->tail = from->tail;
+    queue->count += from->count;
+    processQueueInit(from);
+}
+
+// Moves held-back messages into pcb's mailbox, oldest sender first, while there is room
+static void admitBlockedSenders(PCB *pcb)
+{
+    while (pcb->blockedSenders.head != NULL && !Mailbox_isFull(pcb->mailbox))
+    {
+        PCB *sender = pcb->blockedSenders.head;
+        if (!Mailbox_putShared(pcb->mailbox, sender->pendingMessage, sender->pid, sender->pendingTag))
         {
-            free(message); // Free each message structure
+            return; // Allocation failure, retry on the next receive
         }
-        // Free the list itself
-        List_free(pcb->messageQueue, NULL);
-        free(pcb); // Free the PCB
+        processQueuePop(&pcb->blockedSenders);
+        processQueueAppend(&pcb->replyWaiters, sender); // Its message is in; now it waits for the reply
+        Payload_release(sender->pendingMessage);
+        sender->pendingMessage = NULL;
     }
 }
 
+// Changes how many messages pcb's mailbox accepts, admitting held-back senders that now fit
+void setMailboxCapacity(PCB *pcb, int capacity)
+{
+    if (pcb != NULL)
+    {
+        Mailbox_setCapacity(pcb->mailbox, capacity);
+        admitBlockedSenders(pcb);
+    }
+}
+
+// Takes a sender blocked in Send off its receiver's queues, dropping its message if it was
+// still held back. The sender is left for the caller to reschedule.
+void cancelSend(PCB *sender)
+{
+    if (sender == NULL || sender->state != BLOCKED_ON_SEND)
+    {
+        return;
+    }
+    processQueueRemove(sender);
+    Payload_release(sender->pendingMessage);
+    sender->pendingMessage = NULL;
+    sender->senderPid = -1;
+}
+
 // Sends a message to a process, storing it in the receiver's message queue
 bool sendMessage(PCB *receiver, const char *message, int senderPid)
+{
+    return sendTaggedMessage(receiver, message, senderPid, 0);
+}
+
+// Sends a message carrying a tag that the receiver can filter on
+bool sendTaggedMessage(PCB *receiver, const char *message, int senderPid, int tag)
 {
     if (receiver == NULL || message == NULL)
     {
         return false;
     }
 
-    // Create a new message and copy the data into it
-    Message *newMsg = (Message *)malloc(sizeof(Message));
-    if (newMsg == NULL)
+    // Build the message; the mailbox keeps its own copy
+    Message newMsg;
+    strncpy(newMsg.content, message, MAX_MESSAGE_LENGTH - 1);
+    newMsg.content[MAX_MESSAGE_LENGTH - 1] = '\0'; // Ensure null-termination
+    newMsg.senderPid = senderPid;
+    newMsg.tag = tag;
+
+    // Add the new message to the receiver's message queue
+    return Mailbox_put(receiver->mailbox, &newMsg);
+}
+
+// Sends count messages to one receiver in order, checking arguments and capacity once for the
+// whole batch. Returns how many were queued; the rest did not fit in the mailbox.
+int sendMessages(PCB *receiver, const char *const *messages, int count, int senderPid)
+{
+    if (receiver == NULL || messages == NULL || receiver->blockedSenders.head != NULL)
+    {
+        return 0; // Held-back senders go first
+    }
+    return Mailbox_putMany(receiver->mailbox, messages, count, senderPid, 0);
+}
+
+// Drains up to max of the oldest messages into out, oldest first. Returns the number received.
+int receiveMessages(PCB *pcb, Message *out, int max)
+{
+    if (pcb == NULL || out == NULL || max <= 0)
     {
-        // Failed to allocate memory for the new message
-        return false;
+        return 0;
     }
-    strncpy(newMsg->content, message, MAX_MESSAGE_LENGTH - 1);
-    newMsg->content[MAX_MESSAGE_LENGTH - 1] = '\0'; // Ensure null-termination
-    newMsg->senderPid = senderPid;
+    int received = Mailbox_takeMany(pcb->mailbox, out, max);
+    if (received > 0)
+    {
+        admitBlockedSenders(pcb);
+    }
+    return received;
+}
 
-    // Add the new message to the receiver's message queue
-    if (List_append(receiver->messageQueue, newMsg) != LIST_SUCCESS)
+// Sends a message without ever blocking. Reports SEND_MAILBOX_FULL instead of queueing
+// when the receiver's mailbox is at capacity or other senders are already waiting for room.
+SendResult trySendMessage(PCB *receiver, const char *message, int senderPid, int tag)
+{
+    if (receiver == NULL || message == NULL)
     {
-        free(newMsg); // If adding to the list failed, free the allocated memory for the message
-        return false;
+        return SEND_FAILED;
     }
+    if (Mailbox_isFull(receiver->mailbox) || receiver->blockedSenders.head != NULL)
+    {
+        return SEND_MAILBOX_FULL;
+    }
+    return sendTaggedMessage(receiver, message, senderPid, tag) ? SEND_OK : SEND_FAILED;
+}
 
+// Holds sender's message back until receiver's mailbox has room. Senders are admitted in the
+// order they started waiting as the receiver takes messages. The caller blocks the sender.
+bool waitForMailboxSpace(PCB *receiver, PCB *sender, const char *message, int tag)
+{
+    if (receiver == NULL || sender == NULL || message == NULL || sender->queue != NULL)
+    {
+        return false;
+    }
+    sender->pendingMessage = Payload_create(message);
+    if (sender->pendingMessage == NULL)
+    {
+        return false;
+    }
+    sender->pendingTag = tag;
+    processQueueAppend(&receiver->blockedSenders, sender);
     return true;
 }
 
-// Receives a message from the process's message queue
+// Sends one message to count receivers. The content is copied once into a shared payload that
+// every receiver's mailbox references. Returns the number of mailboxes it was queued in.
+int multicastMessage(PCB **receivers, int count, const char *message, int senderPid)
+{
+    if (receivers == NULL || message == NULL)
+    {
+        return 0;
+    }
+
+    MessagePayload *payload = Payload_create(message);
+    if (payload == NULL)
+    {
+        return 0;
+    }
+    int delivered = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (receivers[i] != NULL && Mailbox_putShared(receivers[i]->mailbox, payload, senderPid, 0))
+        {
+            delivered++;
+        }
+    }
+    Payload_release(payload); // Freed here if nobody took it
+    return delivered;
+}
+
+// Receives the oldest message from the process's message queue
 bool receiveMessage(PCB *pcb, char *buffer, int *senderPid)
 {
     if (pcb == NULL || buffer == NULL || senderPid == NULL)
@@ -82,31 +466,92 @@ bool receiveMessage(PCB *pcb, char *buffer, int *senderPid)
         return false;
     }
 
-    // Check if there are any messages in the queue
-    if (List_count(pcb->messageQueue) == 0)
+    Message msg;
+    if (!Mailbox_take(pcb->mailbox, &msg))
     {
-        // No messages to receive
+        // No messages in the queue
         return false;
     }
+    admitBlockedSenders(pcb);
 
-    // Get the first message from the queue
-    Message *msg = (Message *)List_trim(pcb->messageQueue);
-    if (msg == NULL)
+    // Copy the message content and sender PID to the provided buffer and senderPid
+    strncpy(buffer, msg.content, MAX_MESSAGE_LENGTH);
+    *senderPid = msg.senderPid;
+    return true;
+}
+
+// Receives the oldest message sent by senderPid, without scanning messages from other senders
+bool receiveMessageFrom(PCB *pcb, int senderPid, char *buffer)
+{
+    if (pcb == NULL || buffer == NULL)
     {
-        // No messages in the queue
         return false;
     }
 
-    // Copy the message content and sender PID to the provided buffer and senderPid
-    strncpy(buffer, msg->content, MAX_MESSAGE_LENGTH);
-    *senderPid = msg->senderPid;
+    Message msg;
+    if (!Mailbox_takeMatching(pcb->mailbox, MAILBOX_BY_SENDER, senderPid, &msg))
+    {
+        return false;
+    }
+    admitBlockedSenders(pcb);
+    strncpy(buffer, msg.content, MAX_MESSAGE_LENGTH);
+    return true;
+}
 
-    // Free the message after receiving it
-    free(msg);
+// Receives the oldest message with the given tag
+bool receiveTaggedMessage(PCB *pcb, int tag, char *buffer, int *senderPid)
+{
+    if (pcb == NULL || buffer == NULL || senderPid == NULL)
+    {
+        return false;
+    }
 
+    Message msg;
+    if (!Mailbox_takeMatching(pcb->mailbox, MAILBOX_BY_TAG, tag, &msg))
+    {
+        return false;
+    }
+    admitBlockedSenders(pcb);
+    strncpy(buffer, msg.content, MAX_MESSAGE_LENGTH);
+    *senderPid = msg.senderPid;
     return true;
 }
 
+// Receives the oldest message matching filter: any message if it is -1, otherwise the oldest
+// from sender key (MAILBOX_BY_SENDER) or with tag key (MAILBOX_BY_TAG)
+bool receiveMatchingMessage(PCB *pcb, int filter, int key, char *buffer, int *senderPid)
+{
+    if (filter == MAILBOX_BY_SENDER)
+    {
+        *senderPid = key;
+        return receiveMessageFrom(pcb, key, buffer);
+    }
+    if (filter == MAILBOX_BY_TAG)
+    {
+        return receiveTaggedMessage(pcb, key, buffer, senderPid);
+    }
+    return receiveMessage(pcb, buffer, senderPid);
+}
+
+// Whether receiver is blocked in Receive for a message like this one, which can then be handed
+// to it directly; a message its Receive does not select is queued instead
+bool waitsForMessage(const PCB *receiver, int senderPid, int tag)
+{
+    if (receiver->state != BLOCKED_ON_RECEIVE)
+    {
+        return false;
+    }
+    switch (receiver->receiveFilter)
+    {
+    case MAILBOX_BY_SENDER:
+        return receiver->receiveKey == senderPid;
+    case MAILBOX_BY_TAG:
+        return receiver->receiveKey == tag;
+    default:
+        return true;
+    }
+}
+
 // Function to block a process on a semaphore
 void blockOnSemaphore(PCB *pcb, int semaphoreId)
 {
@@ -125,4 +570,130 @@ void unblockFromSemaphore(PCB *pcb)
         pcb->waitingSemaphore = -1; // No longer waiting on a semaphore
         pcb->state = READY;         // Set the process state back to ready
     }
-}
\ No newline at end of file
+}
+
+void savePCB(SnapshotWriter *writer, const PCB *pcb)
+{
+    Snapshot_putInt(writer, pcb->pid);
+    Snapshot_putInt(writer, pcb->priority);
+    Snapshot_putInt(writer, pcb->basePriority);
+    Snapshot_putInt(writer, pcb->state);
+    Snapshot_putInt(writer, pcb->waitingSemaphore);
+    Snapshot_putInt(writer, pcb->senderPid);
+    Snapshot_putInt(writer, pcb->receiveFilter);
+    Snapshot_putInt(writer, pcb->receiveKey);
+    for (int i = 0; i < PCB_NUM_STATE_BLOCKS; i++)
+    {
+        if (Snapshot_putObject(writer, pcb->stateBlocks[i]))
+        {
+            Snapshot_putLong(writer, (long)pcb->stateBlocks[i]->size);
+            Snapshot_putBytes(writer, pcb->stateBlocks[i]->data, pcb->stateBlocks[i]->size);
+        }
+    }
+    if (Snapshot_putObject(writer, pcb->pendingMessage))
+    {
+        Snapshot_putBytes(writer, pcb->pendingMessage->content, MAX_MESSAGE_LENGTH);
+    }
+    Snapshot_putInt(writer, pcb->pendingTag);
+    Snapshot_putInt(writer, pcb->waitsForPid);
+    Snapshot_putInt(writer, pcb->sliceUsed);
+    Snapshot_putInt(writer, pcb->burstEstimate);
+    Snapshot_putLong(writer, pcb->readySince);
+    Snapshot_putInt(writer, pcb->groupId);
+    Snapshot_putInt(writer, pcb->rtPeriod);
+    Snapshot_putInt(writer, pcb->rtBudget);
+    Snapshot_putInt(writer, pcb->rtBudgetLeft);
+    Snapshot_putLong(writer, pcb->rtDeadline);
+    Snapshot_putLong(writer, pcb->rtNextRelease);
+    Snapshot_putLong(writer, pcb->rtDeadlineMisses);
+    Snapshot_putInt(writer, (int)pcb->pendingSignals);
+    Snapshot_putInt(writer, (int)pcb->handledSignals);
+    Snapshot_putInt(writer, (int)pcb->ignoredSignals);
+    Snapshot_putInt(writer, pcb->workload != NULL);
+    if (pcb->workload != NULL)
+    {
+        Snapshot_putBytes(writer, pcb->workload, sizeof(Workload));
+    }
+    Mailbox_save(writer, pcb->mailbox);
+}
+
+PCB *restorePCB(SnapshotReader *reader)
+{
+    int pid = Snapshot_getInt(reader);
+    int priority = Snapshot_getInt(reader);
+    PCB *pcb = reader->failed ? NULL : createPCB(pid, priority);
+    if (pcb == NULL)
+    {
+        reader->failed = true;
+        return NULL;
+    }
+    pcb->basePriority = Snapshot_getInt(reader);
+    pcb->state = (ProcessState)Snapshot_getInt(reader);
+    pcb->waitingSemaphore = Snapshot_getInt(reader);
+    pcb->senderPid = Snapshot_getInt(reader);
+    pcb->receiveFilter = Snapshot_getInt(reader);
+    pcb->receiveKey = Snapshot_getInt(reader);
+    bool isNew;
+    for (int i = 0; i < PCB_NUM_STATE_BLOCKS; i++)
+    {
+        CowBlock *block = Snapshot_getObject(reader, &isNew);
+        if (isNew)
+        {
+            size_t size = (size_t)Snapshot_getLong(reader);
+            block = size <= reader->size - reader->offset ? Cow_create(size) : NULL;
+            if (block == NULL)
+            {
+                reader->failed = true;
+                return pcb;
+            }
+            Snapshot_getBytes(reader, block->data, size);
+            Snapshot_addObject(reader, block);
+        }
+        else
+        {
+            Cow_share(block); // Each holder owns one reference
+        }
+        pcb->stateBlocks[i] = block;
+    }
+    MessagePayload *payload = Snapshot_getObject(reader, &isNew);
+    if (isNew)
+    {
+        char content[MAX_MESSAGE_LENGTH];
+        Snapshot_getBytes(reader, content, sizeof(content));
+        content[MAX_MESSAGE_LENGTH - 1] = '\0';
+        payload = Payload_create(content);
+        Snapshot_addObject(reader, payload);
+    }
+    else
+    {
+        Payload_share(payload);
+    }
+    pcb->pendingMessage = payload;
+    pcb->pendingTag = Snapshot_getInt(reader);
+    pcb->waitsForPid = Snapshot_getInt(reader);
+    pcb->sliceUsed = Snapshot_getInt(reader);
+    pcb->burstEstimate = Snapshot_getInt(reader);
+    pcb->readySince = Snapshot_getLong(reader);
+    pcb->groupId = Snapshot_getInt(reader);
+    pcb->rtPeriod = Snapshot_getInt(reader);
+    pcb->rtBudget = Snapshot_getInt(reader);
+    pcb->rtBudgetLeft = Snapshot_getInt(reader);
+    pcb->rtDeadline = Snapshot_getLong(reader);
+    pcb->rtNextRelease = Snapshot_getLong(reader);
+    pcb->rtDeadlineMisses = Snapshot_getLong(reader);
+    pcb->pendingSignals = (unsigned)Snapshot_getInt(reader);
+    pcb->handledSignals = (unsigned)Snapshot_getInt(reader);
+    pcb->ignoredSignals = (unsigned)Snapshot_getInt(reader);
+    if (Snapshot_getInt(reader))
+    {
+        pcb->workload = malloc(sizeof(Workload));
+        if (pcb->workload == NULL)
+        {
+            reader->failed = true;
+            return pcb;
+        }
+        Snapshot_getBytes(reader, pcb->workload, sizeof(Workload));
+    }
+    Mailbox_restore(reader, pcb->mailbox);
+    return pcb;
+}
@@ -2,9 +2,10 @@
 #define PCB_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "list.h" // Include the list implementation for dynamic message queue
-
-#define MAX_MESSAGE_LENGTH 40
+#include "cow.h"  // Copy-on-write blocks for per-process state shared across fork
+#include "mailbox.h" // Indexed message queue and the Message type
 typedef enum
 {
     RUNNING,
@@ -12,31 +13,125 @@ typedef enum
     BLOCKED_ON_SEND,
     BLOCKED_ON_RECEIVE,
     BLOCKED_ON_SEMAPHORE,
+    BLOCKED_ON_CONDITION,
+    BLOCKED_ON_RWLOCK,
+    BLOCKED_ON_FUTEX,
+    BLOCKED_ON_IO,
     TERMINATED 
 } ProcessState;
 
-typedef struct Message
+// Large per-process state kept in copy-on-write blocks, shared between parent and child on fork
+typedef enum
+{
+    PCB_ADDRESS_SPACE,
+    PCB_ENVIRONMENT,
+    PCB_RESOURCE_TABLE,
+    PCB_NUM_STATE_BLOCKS
+} PcbStateBlock;
+
+typedef struct ProcessControlBlock PCB;
+struct Semaphore;
+
+// Semaphore holds a process keeps track of for priority inheritance; holds beyond this many
+// are not tracked, so their waiters do not keep the holder boosted once it releases another
+#define PCB_MAX_HELD_SEMAPHORES 8
+
+// Intrusive FIFO of processes. A process is linked into at most one such queue at a time,
+// so it can be removed from whichever queue holds it in O(1).
+typedef struct ProcessQueue
 {
-    char content[MAX_MESSAGE_LENGTH]; // Assume MAX_MESSAGE_LENGTH is defined somewhere
-    int senderPid;                    // Process ID of the sender
-} Message;
+    PCB *head;
+    PCB *tail;
+    int count;
+} ProcessQueue;
 
-typedef struct ProcessControlBlock
+// Outcome of a non-blocking send
+typedef enum
+{
+    SEND_OK,
+    SEND_MAILBOX_FULL,
+    SEND_FAILED
+} SendResult;
+
+struct ProcessControlBlock
 {
     int pid;
-    int priority;
+    int priority;         // Effective priority, raised while holding a semaphore a more urgent process waits on
+    int basePriority;     // Priority the process was created with
     ProcessState state;
-    List *messageQueue;   // Dynamic queue of messages
+    Mailbox *mailbox;     // Queue of messages, indexed by sender and tag
     int waitingSemaphore; // ID of the semaphore the process is waiting on, -1 if not waiting
     int senderPid;        // PID of the process from which a reply is expected, -1 if not waiting for reply
-} PCB;
+    int receiveFilter;    // Index (mailbox.h) a blocked Receive selects messages by, -1 for any message
+    int receiveKey;       // Sender PID or tag the blocked Receive waits for
+    CowBlock *stateBlocks[PCB_NUM_STATE_BLOCKS]; // Per-process state, NULL until first written
+    ProcessQueue blockedSenders; // Senders waiting for room in this process's mailbox, in arrival order
+    ProcessQueue replyWaiters;   // Senders whose message this process has, blocked until it replies
+    MessagePayload *pendingMessage; // Message held back while this process waits for mailbox room
+    int pendingTag;
+    PCB *queueNext;        // Links within the ProcessQueue this process is waiting in
+    PCB *queuePrev;
+    ProcessQueue *queue;   // Queue this process is linked into, NULL if none
+    int waitsForPid;       // Wait-for graph edge: process this one is blocked on, -1 if none
+    struct Semaphore *waitsOnSemaphore; // Wait-for graph edge through a semaphore's holder, NULL if none
+    struct Semaphore *heldSemaphores[PCB_MAX_HELD_SEMAPHORES]; // Acquired and not yet released, oldest first
+    int heldSemaphoreCount;
+    int sliceUsed;         // Ticks run since last dispatched
+    int burstEstimate;     // Average CPU burst in ticks, times SCHEDULER_BURST_SCALE
+    long readySince;       // Tick it woke up at, -1 once dispatched
+    struct IoRequest *ioRequest; // Outstanding device request (device.h), NULL if none
+    struct Workload *workload; // Synthetic CPU and I/O bursts (workload.h), NULL if none
+    int groupId;           // Fair-share process group (group.h), inherited on fork
+    int rtPeriod;          // Real-time (EDF) parameters in quanta; period 0 for ordinary processes
+    int rtBudget;
+    int rtBudgetLeft;      // Budget left in the current job
+    long rtDeadline;       // Absolute deadline of the current job
+    long rtNextRelease;    // When the next job is released
+    long rtDeadlineMisses;
+    int rtReadyIndex;      // Positions in the EDF heaps, -1 if absent
+    int rtReleaseIndex;
+    unsigned pendingSignals; // Signals posted but not yet delivered, one bit per SignalId (signals.h)
+    unsigned handledSignals; // Signals the process has a handler for
+    unsigned ignoredSignals; // Signals the process discards
+    struct Program *program; // C function run as the process body (program.h), NULL if none
+};
 
 // Function prototypes
+void processQueueInit(ProcessQueue *queue);
+void processQueueAppend(ProcessQueue *queue, PCB *pcb);
+void processQueuePrepend(ProcessQueue *queue, PCB *pcb);
+PCB *processQueuePop(ProcessQueue *queue);
+void processQueueRemove(PCB *pcb);
+void processQueueSplice(ProcessQueue *queue, ProcessQueue *from);
 PCB *createPCB(int pid, int priority);
+bool reservePCBs(int count); // Allocates room for count PCBs at once, ahead of creating them
 void destroyPCB(PCB *pcb);
 bool sendMessage(PCB *receiver, const char *message, int senderPid);
+bool sendTaggedMessage(PCB *receiver, const char *message, int senderPid, int tag);
+int sendMessages(PCB *receiver, const char *const *messages, int count, int senderPid);
+int receiveMessages(PCB *pcb, Message *out, int max);
+SendResult trySendMessage(PCB *receiver, const char *message, int senderPid, int tag);
+bool waitForMailboxSpace(PCB *receiver, PCB *sender, const char *message, int tag);
+int multicastMessage(PCB **receivers, int count, const char *message, int senderPid);
+void setMailboxCapacity(PCB *pcb, int capacity);
+void cancelSend(PCB *sender);
 bool receiveMessage(PCB *pcb, char *buffer, int *senderPid);
+bool receiveMessageFrom(PCB *pcb, int senderPid, char *buffer);
+bool receiveTaggedMessage(PCB *pcb, int tag, char *buffer, int *senderPid);
+bool receiveMatchingMessage(PCB *pcb, int filter, int key, char *buffer, int *senderPid);
+bool waitsForMessage(const PCB *receiver, int senderPid, int tag);
+void sharePCBState(PCB *child, const PCB *parent);
+const void *readPCBState(const PCB *pcb, PcbStateBlock which);
+void *writePCBState(PCB *pcb, PcbStateBlock which, size_t size);
 void blockOnSemaphore(PCB *pcb, int semaphoreId);
 void unblockFromSemaphore(PCB *pcb);
 
+// Snapshot support (snapshot.h). savePCB writes a process with its mailbox, state blocks and
+// workload; restorePCB recreates it under the same PID. Queue memberships and links to other
+// processes are saved by the modules that own them.
+struct SnapshotWriter;
+struct SnapshotReader;
+void savePCB(struct SnapshotWriter *writer, const PCB *pcb);
+PCB *restorePCB(struct SnapshotReader *reader);
+
 #endif // PCB_H
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "pidtable.h"
+#include "snapshot.h"
+#include <limits.h>
+#include <stdlib.h>
+
+typedef struct PidSlot
+{
+    PCB *pcb;       // Process bound to this slot, NULL while only reserved
+    int generation; // Incremented every time the slot is freed
+    bool inUse;
+} PidSlot;
+
+static PidSlot *slots = NULL;
+static int *freeSlots = NULL; // Stack of free slot indices, like the list node pool
+static int freeSlotCount = 0;
+static int slotCount = 0; // maxPids + 1, slot 0 is reserved
+static int maxGeneration = 0;
+static int usedCount = 0;
+
+bool PidTable_init(int maxPids)
+{
+    if (maxPids <= 0 || maxPids >= INT_MAX || usedCount > 0)
+    {
+        return false;
+    }
+
+    PidSlot *newSlots = (PidSlot *)calloc((size_t)maxPids + 1, sizeof(PidSlot));
+    int *newFreeSlots = (int *)malloc((size_t)maxPids * sizeof(int));
+    if (newSlots == NULL || newFreeSlots == NULL)
+    {
+        free(newSlots);
+        free(newFreeSlots);
+        return false;
+    }
+
+    free(slots);
+    free(freeSlots);
+    slots = newSlots;
+    freeSlots = newFreeSlots;
+    slotCount = maxPids + 1;
+    maxGeneration = INT_MAX / slotCount - 1;
+
+    // Push in reverse so that the lowest indices are handed out first
+    freeSlotCount = 0;
+    for (int i = maxPids; i >= 1; i--)
+    {
+        freeSlots[freeSlotCount++] = i;
+    }
+    return true;
+}
+
+int PidTable_alloc(void)
+{
+    if (slots == NULL && !PidTable_init(PID_TABLE_DEFAULT_MAX))
+    {
+        return -1;
+    }
+    if (freeSlotCount == 0)
+    {
+        return -1;
+    }
+
+    int index = freeSlots[--freeSlotCount];
+    PidSlot *slot = &slots[index];
+    slot->inUse = true;
+    slot->pcb = NULL;
+    usedCount++;
+    return slot->generation * slotCount + index;
+}
+
+// Maps a PID to its live slot, or NULL if the PID is out of range, free or stale
+static PidSlot *slot_for_pid(int pid)
+{
+    if (slots == NULL || pid <= 0)
+    {
+        return NULL;
+    }
+    PidSlot *slot = &slots[pid % slotCount];
+    if (!slot->inUse || slot->generation != pid / slotCount)
+    {
+        return NULL;
+    }
+    return slot;
+}
+
+bool PidTable_bind(int pid, PCB *pcb)
+{
+    PidSlot *slot = slot_for_pid(pid);
+    if (slot == NULL)
+    {
+        return false;
+    }
+    slot->pcb = pcb;
+    return true;
+}
+
+PCB *PidTable_lookup(int pid)
+{
+    PidSlot *slot = slot_for_pid(pid);
+    return slot != NULL ? slot->pcb : NULL;
+}
+
+void PidTable_release(int pid)
+{
+    PidSlot *slot = slot_for_pid(pid);
+    if (slot == NULL)
+    {
+        return;
+    }
+    slot->pcb = NULL;
+    slot->inUse = false;
+    // Wrap before the encoded PID would overflow an int
+    slot->generation = slot->generation < maxGeneration ? slot->generation + 1 : 0;
+    freeSlots[freeSlotCount++] = pid % slotCount;
+    usedCount--;
+}
+
+void PidTable_forEach(void (*fn)(PCB *pcb, void *arg), void *arg)
+{
+    for (int i = 1; i < slotCount; i++)
+    {
+        if (slots[i].inUse && slots[i].pcb != NULL)
+        {
+            fn(slots[i].pcb, arg);
+        }
+    }
+}
+
+int PidTable_count(void)
+{
+    return usedCount;
+}
+
+int PidTable_capacity(void)
+{
+    return slotCount > 0 ? slotCount - 1 : PID_TABLE_DEFAULT_MAX;
+}
+
+void PidTable_save(SnapshotWriter *writer)
+{
+    Snapshot_putInt(writer, PidTable_capacity());
+    if (slots == NULL)
+    {
+        Snapshot_putInt(writer, -1);
+        return;
+    }
+    Snapshot_putInt(writer, freeSlotCount);
+    Snapshot_putBytes(writer, freeSlots, (size_t)freeSlotCount * sizeof(int));
+    for (int i = 1; i < slotCount; i++)
+    {
+        Snapshot_putInt(writer, slots[i].inUse ? -slots[i].generation - 1 : slots[i].generation);
+    }
+}
+
+void PidTable_restore(SnapshotReader *reader)
+{
+    int maxPids = Snapshot_getInt(reader);
+    int savedFreeCount = Snapshot_getInt(reader);
+    if (reader->failed || !PidTable_init(maxPids))
+    {
+        reader->failed = true;
+        return;
+    }
+    if (savedFreeCount < 0)
+    {
+        return; // Saved before the table was first used
+    }
+    if (savedFreeCount > maxPids)
+    {
+        reader->failed = true;
+        return;
+    }
+    freeSlotCount = savedFreeCount;
+    Snapshot_getBytes(reader, freeSlots, (size_t)freeSlotCount * sizeof(int));
+    usedCount = 0;
+    for (int i = 1; i < slotCount; i++)
+    {
+        int generation = Snapshot_getInt(reader); // Negative (minus one) for slots in use
+        slots[i].inUse = generation < 0;
+        slots[i].generation = generation < 0 ? -generation - 1 : generation;
+        usedCount += slots[i].inUse;
+    }
+}
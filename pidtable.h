@@ -0,0 +1,46 @@
+#ifndef PIDTABLE_H
+#define PIDTABLE_H
+
+#include <stdbool.h>
+#include "pcb.h"
+
+// Number of process slots used when PidTable_init is not called before the first allocation
+#define PID_TABLE_DEFAULT_MAX 1024
+
+// PIDs encode a slot index and a generation number: pid = generation * (maxPids + 1) + index.
+// Slot 0 is never handed out, so the first generation yields PIDs 1..maxPids in order, and a
+// PID whose slot has since been freed (and possibly reused) is rejected by PidTable_lookup.
+
+// Sets up the process table with room for maxPids live processes.
+// Returns false if the table is already in use or memory could not be allocated.
+bool PidTable_init(int maxPids);
+
+// Reserves a free slot and returns its PID, or -1 if the table is full. O(1).
+int PidTable_alloc(void);
+
+// Associates a reserved PID with its PCB. Returns false if the PID is not reserved.
+bool PidTable_bind(int pid, PCB *pcb);
+
+// Returns the PCB for pid, or NULL if the PID is free or stale. O(1).
+PCB *PidTable_lookup(int pid);
+
+// Frees the slot behind pid and bumps its generation. Stale PIDs are ignored. O(1).
+void PidTable_release(int pid);
+
+// Calls fn(pcb, arg) for every live process, in slot order.
+void PidTable_forEach(void (*fn)(PCB *pcb, void *arg), void *arg);
+
+// Number of PIDs currently allocated.
+int PidTable_count(void);
+
+// Maximum number of PIDs that can be allocated at once.
+int PidTable_capacity(void);
+
+// Snapshot support (snapshot.h): the generation and use of every slot and the free-slot order,
+// so a restored table hands out the same PIDs. Restored slots are reserved but not yet bound.
+struct SnapshotWriter;
+struct SnapshotReader;
+void PidTable_save(struct SnapshotWriter *writer);
+void PidTable_restore(struct SnapshotReader *reader);
+
+#endif // PIDTABLE_H
@@ -0,0 +1,563 @@
+#include "program.h"
+#include "coroutine.h"
+#include "commands.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum
+{
+    CALL_YIELD,
+    CALL_SEND,
+    CALL_RECEIVE,
+    CALL_REPLY,
+    CALL_P,
+    CALL_V,
+    CALL_WAIT,
+    CALL_SIGNAL,
+    CALL_BROADCAST,
+    CALL_READ_LOCK,
+    CALL_WRITE_LOCK,
+    CALL_UNLOCK,
+    CALL_FUTEX_WAIT,
+    CALL_FUTEX_WAKE,
+    CALL_FUTEX_SET
+} ProgramCall;
+
+typedef struct
+{
+    const char *name;
+    ProgramBody body;
+} ProgramType;
+
+typedef struct Program
+{
+    Coroutine *coroutine;
+    const ProgramType *type;
+    int args[2];
+    ProgramCall call;                 // System call the body is suspended in
+    int target;                       // PID, ID of the semaphore, condition or lock, futex key, or receive key
+    int value;                        // Tag, receive filter, futex value, or semaphore a condition wait releases
+    char message[MAX_MESSAGE_LENGTH]; // Message to send, or the message or reply received
+    int senderPid;
+    int result;
+    bool waiting;     // The call blocked the process; it finishes when the process runs again
+    bool interrupted; // A signal cut the wait short
+} Program;
+
+static Program *running = NULL; // Program whose body is executing
+static int programCount = 0;
+
+static void copy_message(char *to, const char *from)
+{
+    strncpy(to, from, MAX_MESSAGE_LENGTH - 1);
+    to[MAX_MESSAGE_LENGTH - 1] = '\0';
+}
+
+// Suspends the body until the kernel has carried out the call described in running
+static int system_call(ProgramCall call)
+{
+    Program *program = running;
+    program->call = call;
+    Coroutine_yield();
+    return program->result;
+}
+
+void Program_yield()
+{
+    system_call(CALL_YIELD);
+}
+
+int Program_send(int pid, const char *message, char *reply)
+{
+    return Program_sendTagged(pid, 0, message, reply);
+}
+
+int Program_sendTagged(int pid, int tag, const char *message, char *reply)
+{
+    running->target = pid;
+    running->value = tag;
+    copy_message(running->message, message);
+    int result = system_call(CALL_SEND);
+    if (result == 0 && reply != NULL)
+    {
+        copy_message(reply, running->message);
+    }
+    return result;
+}
+
+// Receives the oldest message selected by filter and key (see receiveMatchingMessage)
+static int receive_matching(int filter, int key, char *message, int *senderPid)
+{
+    running->value = filter;
+    running->target = key;
+    int result = system_call(CALL_RECEIVE);
+    if (result == 0)
+    {
+        copy_message(message, running->message);
+        *senderPid = running->senderPid;
+    }
+    return result;
+}
+
+int Program_receive(char *message, int *senderPid)
+{
+    return receive_matching(-1, 0, message, senderPid);
+}
+
+int Program_receiveFrom(int pid, char *message)
+{
+    int senderPid;
+    return receive_matching(MAILBOX_BY_SENDER, pid, message, &senderPid);
+}
+
+int Program_receiveTagged(int tag, char *message, int *senderPid)
+{
+    return receive_matching(MAILBOX_BY_TAG, tag, message, senderPid);
+}
+
+int Program_reply(int pid, const char *message)
+{
+    running->target = pid;
+    copy_message(running->message, message);
+    return system_call(CALL_REPLY);
+}
+
+int Program_P(int id)
+{
+    running->target = id;
+    return system_call(CALL_P);
+}
+
+int Program_V(int id)
+{
+    running->target = id;
+    return system_call(CALL_V);
+}
+
+int Program_wait(int id, int mutexId)
+{
+    running->target = id;
+    running->value = mutexId;
+    int result = system_call(CALL_WAIT);
+    if (result == 0 && mutexId != -1)
+    {
+        result = Program_P(mutexId); // Woken without the mutex; take it back before returning
+    }
+    return result;
+}
+
+int Program_signal(int id)
+{
+    running->target = id;
+    return system_call(CALL_SIGNAL);
+}
+
+int Program_broadcast(int id)
+{
+    running->target = id;
+    return system_call(CALL_BROADCAST);
+}
+
+int Program_readLock(int id)
+{
+    running->target = id;
+    return system_call(CALL_READ_LOCK);
+}
+
+int Program_writeLock(int id)
+{
+    running->target = id;
+    return system_call(CALL_WRITE_LOCK);
+}
+
+int Program_unlock(int id)
+{
+    running->target = id;
+    return system_call(CALL_UNLOCK);
+}
+
+int Program_futexWait(int key, int expected)
+{
+    running->target = key;
+    running->value = expected;
+    return system_call(CALL_FUTEX_WAIT);
+}
+
+int Program_futexWake(int key, int count)
+{
+    running->target = key;
+    running->value = count;
+    return system_call(CALL_FUTEX_WAKE);
+}
+
+int Program_futexSet(int key, int value)
+{
+    running->target = key;
+    running->value = value;
+    return system_call(CALL_FUTEX_SET);
+}
+
+int Program_futexGet(int key)
+{
+    return Commands_getFutexWord(key);
+}
+
+int Program_self()
+{
+    return Scheduler_getCurrentProcess()->pid;
+}
+
+// Replies to arg1 requests (forever if 0) with the request itself
+static void echo_body(int requests, int unused)
+{
+    (void)unused;
+    char message[MAX_MESSAGE_LENGTH];
+    int senderPid;
+    for (int served = 0; requests == 0 || served < requests;)
+    {
+        if (Program_receive(message, &senderPid) == 0)
+        {
+            Program_reply(senderPid, message);
+            served++;
+        }
+    }
+}
+
+// Replies to requests tagged tag, requests of them (forever if 0), leaving other messages queued
+static void triage_body(int tag, int requests)
+{
+    char message[MAX_MESSAGE_LENGTH];
+    int senderPid;
+    for (int served = 0; requests == 0 || served < requests;)
+    {
+        if (Program_receiveTagged(tag, message, &senderPid) == 0)
+        {
+            Program_reply(senderPid, message);
+            served++;
+        }
+    }
+}
+
+// Sends rounds requests to the process serverPid, a tick apart
+static void client_body(int serverPid, int rounds)
+{
+    char request[MAX_MESSAGE_LENGTH];
+    char reply[MAX_MESSAGE_LENGTH];
+    for (int round = 0; round < rounds; round++)
+    {
+        snprintf(request, sizeof(request), "request %d from %d", round, Program_self());
+        if (Program_send(serverPid, request, reply) != 0)
+        {
+            return;
+        }
+        Program_yield();
+    }
+}
+
+// Holds the semaphore id for one tick, rounds times
+static void worker_body(int id, int rounds)
+{
+    for (int round = 0; round < rounds; round++)
+    {
+        if (Program_P(id) != 0)
+        {
+            continue; // Interrupted before getting the semaphore
+        }
+        Program_yield();
+        Program_V(id);
+        Program_yield();
+    }
+}
+
+// Holds lock id for reading for one tick, rounds times
+static void reader_body(int id, int rounds)
+{
+    for (int round = 0; round < rounds; round++)
+    {
+        if (Program_readLock(id) != 0)
+        {
+            continue;
+        }
+        Program_yield();
+        Program_unlock(id);
+        Program_yield();
+    }
+}
+
+// Holds lock id for writing for one tick, rounds times
+static void writer_body(int id, int rounds)
+{
+    for (int round = 0; round < rounds; round++)
+    {
+        if (Program_writeLock(id) != 0)
+        {
+            continue;
+        }
+        Program_yield();
+        Program_unlock(id);
+        Program_yield();
+    }
+}
+
+// Waits on condition id with semaphore mutex held around each wait, until a wait fails
+static void waiter_body(int id, int mutex)
+{
+    while (Program_P(mutex) == 0)
+    {
+        if (Program_wait(id, mutex) != 0)
+        {
+            return; // Interrupted; the mutex was not taken back
+        }
+        Program_V(mutex);
+    }
+}
+
+// Wakes every waiter on condition id once a tick, rounds times
+static void notifier_body(int id, int rounds)
+{
+    for (int round = 0; round < rounds; round++)
+    {
+        Program_yield();
+        Program_broadcast(id);
+    }
+}
+
+// Takes a lock built on futex key rounds times, holding it for one tick: the word is 0 while the
+// lock is free and 1 while it is taken, and a taker that finds it taken waits until it is not
+static void locker_body(int key, int rounds)
+{
+    for (int round = 0; round < rounds; round++)
+    {
+        while (Program_futexGet(key) != 0)
+        {
+            Program_futexWait(key, 1); // Fails at once if the lock was freed in between
+        }
+        Program_futexSet(key, 1);
+        Program_yield();
+        Program_futexSet(key, 0);
+        Program_futexWake(key, 1);
+        Program_yield();
+    }
+}
+
+// Computes for ticks ticks
+static void spin_body(int ticks, int unused)
+{
+    (void)unused;
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        Program_yield();
+    }
+}
+
+static const ProgramType programTypes[] = {
+    {"echo", echo_body},
+    {"triage", triage_body},
+    {"client", client_body},
+    {"worker", worker_body},
+    {"reader", reader_body},
+    {"writer", writer_body},
+    {"waiter", waiter_body},
+    {"notifier", notifier_body},
+    {"locker", locker_body},
+    {"spin", spin_body},
+};
+
+#define NUM_PROGRAM_TYPES (int)(sizeof(programTypes) / sizeof(programTypes[0]))
+
+static void run_body(void *arg)
+{
+    Program *program = arg;
+    program->type->body(program->args[0], program->args[1]);
+}
+
+bool Program_start(PCB *process, const char *name, int arg1, int arg2)
+{
+    const ProgramType *type = NULL;
+    for (int i = 0; i < NUM_PROGRAM_TYPES && type == NULL; i++)
+    {
+        if (strcmp(programTypes[i].name, name) == 0)
+        {
+            type = &programTypes[i];
+        }
+    }
+    Program *program = type != NULL ? malloc(sizeof(Program)) : NULL;
+    if (program == NULL)
+    {
+        return false;
+    }
+    program->coroutine = Coroutine_create(run_body, program);
+    if (program->coroutine == NULL)
+    {
+        free(program);
+        return false;
+    }
+    program->type = type;
+    program->args[0] = arg1;
+    program->args[1] = arg2;
+    program->waiting = false;
+    program->interrupted = false;
+    process->program = program;
+    programCount++;
+    return true;
+}
+
+// Carries out the system call the body just made. The process is running on entry; it may have
+// blocked or been switched out on return.
+static void carry_out(Program *program, PCB *process)
+{
+    program->interrupted = false;
+    switch (program->call)
+    {
+    case CALL_YIELD:
+        program->result = 0;
+        Commands_Quantum(); // May terminate the process, through a pending signal
+        return;
+    case CALL_SEND:
+        program->result = Commands_SendTagged(program->target, program->value, program->message);
+        program->waiting = program->result == 0 && process->state == BLOCKED_ON_SEND;
+        return;
+    case CALL_RECEIVE:
+        if (receiveMatchingMessage(process, program->value, program->target, program->message, &program->senderPid))
+        {
+            printf("Process with PID %d received message from PID %d: %s\n", process->pid, program->senderPid,
+                   program->message);
+            program->result = 0;
+            return;
+        }
+        if (program->value == MAILBOX_BY_SENDER)
+        {
+            program->result = Commands_ReceiveFrom(program->target);
+        }
+        else if (program->value == MAILBOX_BY_TAG)
+        {
+            program->result = Commands_ReceiveTagged(program->target);
+        }
+        else
+        {
+            program->result = Commands_Receive();
+        }
+        program->waiting = program->result == 0 && process->state == BLOCKED_ON_RECEIVE;
+        return;
+    case CALL_REPLY:
+        program->result = Commands_Reply(program->target, program->message);
+        return;
+    case CALL_P:
+        program->result = Commands_P(program->target);
+        program->waiting = program->result == 0 && process->state == BLOCKED_ON_SEMAPHORE;
+        return;
+    case CALL_V:
+        program->result = Commands_V(program->target);
+        return;
+    case CALL_WAIT:
+        program->result = Commands_ConditionWait(program->target, program->value);
+        program->waiting = program->result == 0 && process->state == BLOCKED_ON_CONDITION;
+        return;
+    case CALL_SIGNAL:
+        program->result = Commands_ConditionSignal(program->target);
+        return;
+    case CALL_BROADCAST:
+        program->result = Commands_ConditionBroadcast(program->target);
+        return;
+    case CALL_READ_LOCK:
+        program->result = Commands_LockRead(program->target);
+        program->waiting = program->result == 0 && process->state == BLOCKED_ON_RWLOCK;
+        return;
+    case CALL_WRITE_LOCK:
+        program->result = Commands_LockWrite(program->target);
+        program->waiting = program->result == 0 && process->state == BLOCKED_ON_RWLOCK;
+        return;
+    case CALL_UNLOCK:
+        program->result = Commands_Unlock(program->target);
+        return;
+    case CALL_FUTEX_WAIT:
+        program->result = Commands_FutexWait(program->target, program->value);
+        program->waiting = program->result == 0 && process->state == BLOCKED_ON_FUTEX;
+        return;
+    case CALL_FUTEX_WAKE:
+        program->result = Commands_FutexWake(program->target, program->value);
+        return;
+    case CALL_FUTEX_SET:
+        program->result = Commands_FutexSet(program->target, program->value);
+        return;
+    }
+}
+
+void Program_step(PCB *process)
+{
+    Program *program = process->program;
+    if (program->waiting)
+    {
+        // The blocked call is over: what it waited for was delivered, or a signal interrupted it
+        program->waiting = false;
+        program->result = program->interrupted ? -1 : 0;
+    }
+
+    running = program;
+    Coroutine_resume(program->coroutine);
+    running = NULL;
+
+    if (Coroutine_finished(program->coroutine))
+    {
+        printf("Program %s of process with PID %d returned.\n", program->type->name, process->pid);
+        Commands_Exit();
+        return;
+    }
+    carry_out(program, process);
+}
+
+void Program_deliver(PCB *process, int senderPid, const char *message)
+{
+    Program *program = process->program;
+    if (program != NULL && program->waiting)
+    {
+        copy_message(program->message, message);
+        program->senderPid = senderPid;
+    }
+}
+
+void Program_interrupt(PCB *process)
+{
+    Program *program = process->program;
+    if (program != NULL && program->waiting)
+    {
+        program->interrupted = true;
+    }
+}
+
+const char *Program_name(const PCB *process)
+{
+    return process->program != NULL ? process->program->type->name : NULL;
+}
+
+const char *Program_names()
+{
+    static char names[256];
+    if (names[0] == '\0')
+    {
+        for (int i = 0; i < NUM_PROGRAM_TYPES; i++)
+        {
+            size_t length = strlen(names);
+            snprintf(names + length, sizeof(names) - length, "%s%s", i > 0 ? ", " : "", programTypes[i].name);
+        }
+    }
+    return names;
+}
+
+int Program_count()
+{
+    return programCount;
+}
+
+void Program_free(PCB *process)
+{
+    if (process->program == NULL)
+    {
+        return;
+    }
+    Coroutine_free(process->program->coroutine);
+    free(process->program);
+    process->program = NULL;
+    programCount--;
+}
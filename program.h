@@ -0,0 +1,65 @@
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <stdbool.h>
+#include "pcb.h"
+#include "mailbox.h"
+
+// Process bodies: real C functions bound to processes and run as coroutines (coroutine.h).
+// A body runs only while its process is the running one and only until its next system call.
+// The call then switches back to the kernel side, which carries it out with the same commands
+// the shell uses, so blocking and switching go through the scheduler as usual. A call that
+// blocks the process finishes when the process runs again; the body sees its result then.
+
+// Built-in bodies, named when a process is created with one
+typedef void (*ProgramBody)(int arg1, int arg2);
+
+// System calls, made from inside a body for the process running it. Each returns 0 on success
+// and -1 on failure, or when a signal cut a blocked wait short (signals.h).
+void Program_yield();                                        // Ends the tick: a timer tick
+int Program_send(int pid, const char *message, char *reply); // Blocks until the reply
+int Program_sendTagged(int pid, int tag, const char *message, char *reply);
+int Program_receive(char *message, int *senderPid);
+int Program_receiveFrom(int pid, char *message); // Other senders' messages stay queued
+int Program_receiveTagged(int tag, char *message, int *senderPid);
+int Program_reply(int pid, const char *message);
+int Program_P(int id);
+int Program_V(int id);
+int Program_wait(int id, int mutexId); // Condition wait; takes the mutex back once woken
+int Program_signal(int id);
+int Program_broadcast(int id);
+int Program_readLock(int id);
+int Program_writeLock(int id);
+int Program_unlock(int id);
+int Program_futexWait(int key, int expected); // Fails at once unless the word holds expected
+int Program_futexWake(int key, int count);
+int Program_futexSet(int key, int value);
+int Program_futexGet(int key); // Reads the word; not a system call, so the body keeps running
+int Program_self();
+
+// Binds process to the built-in body called name, run with the two arguments.
+// Returns false if there is no such body or no coroutine stack is available.
+bool Program_start(PCB *process, const char *name, int arg1, int arg2);
+
+// Runs the body of the running process up to its next system call and carries the call out.
+// A body that returns makes its process exit.
+void Program_step(PCB *process);
+
+// Kernel hooks: a message or reply handed to a process blocked for it, and a blocked wait cut
+// short by a signal. They do nothing for processes without a body.
+void Program_deliver(PCB *process, int senderPid, const char *message);
+void Program_interrupt(PCB *process);
+
+// Name of the process's body, NULL if it has none
+const char *Program_name(const PCB *process);
+
+// Names of the built-in bodies, separated by ", ", for prompts and error messages
+const char *Program_names();
+
+// Number of processes with a body
+int Program_count();
+
+// Releases the process's coroutine, returning its stack to the pool
+void Program_free(PCB *process);
+
+#endif // PROGRAM_H
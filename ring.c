@@ -0,0 +1,275 @@
+#include "ring.h"
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define RING_MAGIC 0x52494e4753494d31ULL // "RINGSIM1"
+#define RING_CACHE_LINE 64
+#define RING_NAME_LENGTH 256
+
+// Positions only ever grow; a position maps to slot position & mask. A slot whose sequence
+// equals a position is free for the producer of that position, and one whose sequence is
+// position + 1 holds a record for the consumer of that position.
+typedef struct
+{
+    _Alignas(RING_CACHE_LINE) _Atomic uint64_t head; // Next position to produce
+    _Alignas(RING_CACHE_LINE) _Atomic uint64_t tail; // Next position to consume
+    _Alignas(RING_CACHE_LINE) uint64_t mask;
+    uint64_t slotSize;
+    uint64_t slotsOffset; // From the start of the shared memory object
+} RingQueue;
+
+typedef struct
+{
+    _Atomic uint64_t magic; // Written last by the creator, so attachers never see a half-built channel
+    uint64_t size;
+    RingQueue commands;
+    RingQueue completions;
+} RingHeader;
+
+struct RingChannel
+{
+    RingHeader *header;
+    size_t size;
+    bool owner;
+    char name[RING_NAME_LENGTH];
+};
+
+typedef struct
+{
+    _Atomic uint64_t sequence;
+    RingCommand command;
+} CommandSlot;
+
+typedef struct
+{
+    _Atomic uint64_t sequence;
+    RingCompletion completion;
+} CompletionSlot;
+
+static size_t align_up(size_t value)
+{
+    return (value + RING_CACHE_LINE - 1) & ~(size_t)(RING_CACHE_LINE - 1);
+}
+
+static _Atomic uint64_t *slot_sequence(RingChannel *channel, RingQueue *queue, uint64_t position)
+{
+    char *slots = (char *)channel->header + queue->slotsOffset;
+    return (_Atomic uint64_t *)(slots + (position & queue->mask) * queue->slotSize);
+}
+
+static void init_queue(RingChannel *channel, RingQueue *queue, uint64_t capacity, size_t slotSize, size_t offset)
+{
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    queue->mask = capacity - 1;
+    queue->slotSize = slotSize;
+    queue->slotsOffset = offset;
+    for (uint64_t position = 0; position < capacity; position++)
+    {
+        atomic_init(slot_sequence(channel, queue, position), position);
+    }
+}
+
+RingChannel *Ring_create(const char *name, unsigned capacity)
+{
+    uint64_t slots = 1;
+    while (slots < capacity)
+    {
+        slots <<= 1;
+    }
+    size_t commandsOffset = align_up(sizeof(RingHeader));
+    size_t completionsOffset = align_up(commandsOffset + slots * sizeof(CommandSlot));
+    size_t size = align_up(completionsOffset + slots * sizeof(CompletionSlot));
+
+    RingChannel *channel = calloc(1, sizeof(RingChannel));
+    if (channel == NULL || strlen(name) >= RING_NAME_LENGTH)
+    {
+        free(channel);
+        return NULL;
+    }
+    shm_unlink(name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+    {
+        free(channel);
+        return NULL;
+    }
+    void *base = ftruncate(fd, (off_t)size) == 0 ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                                                  : MAP_FAILED;
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        shm_unlink(name);
+        free(channel);
+        return NULL;
+    }
+
+    channel->header = base;
+    channel->size = size;
+    channel->owner = true;
+    strcpy(channel->name, name);
+    channel->header->size = size;
+    init_queue(channel, &channel->header->commands, slots, sizeof(CommandSlot), commandsOffset);
+    init_queue(channel, &channel->header->completions, slots, sizeof(CompletionSlot), completionsOffset);
+    atomic_store_explicit(&channel->header->magic, RING_MAGIC, memory_order_release);
+    return channel;
+}
+
+RingChannel *Ring_attach(const char *name)
+{
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    off_t size = lseek(fd, 0, SEEK_END);
+    void *base = size >= (off_t)sizeof(RingHeader) ? mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                                                   : MAP_FAILED;
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        return NULL;
+    }
+    RingHeader *header = base;
+    if (atomic_load_explicit(&header->magic, memory_order_acquire) != RING_MAGIC || header->size != (uint64_t)size)
+    {
+        munmap(base, (size_t)size);
+        return NULL;
+    }
+    RingChannel *channel = calloc(1, sizeof(RingChannel));
+    if (channel == NULL)
+    {
+        munmap(base, (size_t)size);
+        return NULL;
+    }
+    channel->header = header;
+    channel->size = (size_t)size;
+    return channel;
+}
+
+void Ring_close(RingChannel *channel)
+{
+    if (channel == NULL)
+    {
+        return;
+    }
+    munmap(channel->header, channel->size);
+    if (channel->owner)
+    {
+        shm_unlink(channel->name);
+    }
+    free(channel);
+}
+
+// Claims the next free slot, or returns NULL if the ring is full. With one producer the claim
+// is a plain store; with several they race for the head with compare-and-swap.
+static void *claim_slot(RingChannel *channel, RingQueue *queue, bool shared, uint64_t *position)
+{
+    uint64_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    for (;;)
+    {
+        _Atomic uint64_t *sequence = slot_sequence(channel, queue, head);
+        int64_t difference = (int64_t)(atomic_load_explicit(sequence, memory_order_acquire) - head);
+        if (difference < 0)
+        {
+            return NULL; // The consumer has not freed this slot yet
+        }
+        if (difference > 0)
+        {
+            head = atomic_load_explicit(&queue->head, memory_order_relaxed); // Another producer took it
+            continue;
+        }
+        if (!shared)
+        {
+            atomic_store_explicit(&queue->head, head + 1, memory_order_relaxed);
+            break;
+        }
+        if (atomic_compare_exchange_weak_explicit(&queue->head, &head, head + 1, memory_order_relaxed,
+                                                  memory_order_relaxed))
+        {
+            break;
+        }
+    }
+    *position = head;
+    return slot_sequence(channel, queue, head);
+}
+
+// Returns the oldest published slot, or NULL if the ring is empty. There is only one consumer.
+static void *oldest_slot(RingChannel *channel, RingQueue *queue, uint64_t *position)
+{
+    uint64_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    _Atomic uint64_t *sequence = slot_sequence(channel, queue, tail);
+    if (atomic_load_explicit(sequence, memory_order_acquire) != tail + 1)
+    {
+        return NULL;
+    }
+    *position = tail;
+    return sequence;
+}
+
+// Hands a filled slot to the consumer, or a consumed slot back to the producers
+static void publish(_Atomic uint64_t *sequence, uint64_t value)
+{
+    atomic_store_explicit(sequence, value, memory_order_release);
+}
+
+bool Ring_pushCommand(RingChannel *channel, const RingCommand *command)
+{
+    uint64_t position;
+    CommandSlot *slot = claim_slot(channel, &channel->header->commands, true, &position);
+    if (slot == NULL)
+    {
+        return false;
+    }
+    slot->command = *command;
+    publish(&slot->sequence, position + 1);
+    return true;
+}
+
+bool Ring_popCommand(RingChannel *channel, RingCommand *command)
+{
+    RingQueue *queue = &channel->header->commands;
+    uint64_t position;
+    CommandSlot *slot = oldest_slot(channel, queue, &position);
+    if (slot == NULL)
+    {
+        return false;
+    }
+    *command = slot->command;
+    atomic_store_explicit(&queue->tail, position + 1, memory_order_relaxed);
+    publish(&slot->sequence, position + queue->mask + 1);
+    return true;
+}
+
+bool Ring_pushCompletion(RingChannel *channel, const RingCompletion *completion)
+{
+    uint64_t position;
+    CompletionSlot *slot = claim_slot(channel, &channel->header->completions, false, &position);
+    if (slot == NULL)
+    {
+        return false;
+    }
+    slot->completion = *completion;
+    publish(&slot->sequence, position + 1);
+    return true;
+}
+
+bool Ring_popCompletion(RingChannel *channel, RingCompletion *completion)
+{
+    RingQueue *queue = &channel->header->completions;
+    uint64_t position;
+    CompletionSlot *slot = oldest_slot(channel, queue, &position);
+    if (slot == NULL)
+    {
+        return false;
+    }
+    *completion = slot->completion;
+    atomic_store_explicit(&queue->tail, position + 1, memory_order_relaxed);
+    publish(&slot->sequence, position + queue->mask + 1);
+    return true;
+}
@@ -0,0 +1,74 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Shared-memory command channel for external drivers. A channel is a POSIX shared memory object
+// holding two bounded rings of fixed-size binary records: commands flow from any number of
+// driver processes to the simulator (multi-producer, single consumer), and completions flow back
+// from the simulator to one driver (single producer, single consumer). Neither side makes a
+// syscall per record; each slot carries a sequence number that tells its producer and consumer
+// whose turn it is.
+
+// Default number of records in each ring; always a power of two
+#define RING_DEFAULT_CAPACITY 65536
+// Message text carried by RING_SEND and RING_REPLY, including the terminator
+#define RING_MESSAGE_LENGTH 40
+
+typedef enum
+{
+    RING_CREATE,        // args[0] = priority
+    RING_FORK,
+    RING_KILL,          // args[0] = pid
+    RING_EXIT,
+    RING_SEND,          // args[0] = pid, message
+    RING_RECEIVE,
+    RING_REPLY,         // args[0] = pid, message
+    RING_NEW_SEMAPHORE, // args[0] = id, args[1] = value
+    RING_P,             // args[0] = id
+    RING_V,             // args[0] = id
+    RING_TICK,
+    RING_SYNC,          // Does nothing; its completion shows every earlier command has run
+    RING_QUIT           // Stops the simulator's ring loop
+} RingOp;
+
+// Set in RingCommand.flags to have a completion posted for the command
+#define RING_REPLY_WANTED 1
+
+typedef struct
+{
+    uint64_t tag; // Chosen by the driver and echoed in the completion
+    int32_t op;
+    int32_t flags;
+    int32_t args[2];
+    char message[RING_MESSAGE_LENGTH];
+} RingCommand;
+
+typedef struct
+{
+    uint64_t tag;
+    int32_t result; // What the command returned: a PID for RING_CREATE and RING_FORK, -1 on failure
+    int32_t op;
+} RingCompletion;
+
+typedef struct RingChannel RingChannel;
+
+// Creates the channel name (replacing a stale one) with capacity records per ring, rounded up
+// to a power of two. Returns NULL on failure.
+RingChannel *Ring_create(const char *name, unsigned capacity);
+
+// Maps the existing channel name. Returns NULL if it does not exist or is not ready yet.
+RingChannel *Ring_attach(const char *name);
+
+// Unmaps the channel; the creator also removes the shared memory object.
+void Ring_close(RingChannel *channel);
+
+// Each push returns false if the ring is full and each pop returns false if it is empty, so the
+// caller decides how to wait.
+bool Ring_pushCommand(RingChannel *channel, const RingCommand *command);
+bool Ring_popCommand(RingChannel *channel, RingCommand *command);
+bool Ring_pushCompletion(RingChannel *channel, const RingCompletion *completion);
+bool Ring_popCompletion(RingChannel *channel, RingCompletion *completion);
+
+#endif // RING_H
@@ -1,35 +1,129 @@
 #include "scheduler.h"
-#include "list.h"
+#include "semaphore.h"
+#include "edf.h"
+#include "group.h"
+#include "workload.h"
+#include "device.h"
+#include "snapshot.h"
+#include "stats.h"
+#include "signals.h"
 #include <stdlib.h> // For NULL definition
 
 // Define the number of priority levels
 #define NUM_PRIORITIES 3
 
-// Array of lists, one for each priority level
-List *priorityQueues[NUM_PRIORITIES];
+// Ordinary processes wait in the per-priority queues of their process group (group.c)
 extern void *currentProcess;
 
 // Current priority being served and index for round-robin within the queue
 int currentPriority = 0;
 void *currentProcess = NULL; // Pointer to current process for round-robin within a priority
+long currentTime = 0;        // Simulated time, in timer ticks
+PCB *initProcess = NULL;     // Runs only when every ready queue is empty; never queued itself
 
-List **Scheduler_getPriorityQueues()
+// Quantum length in ticks for each priority level, and whether it adapts to each process's bursts
+static int quantum[NUM_PRIORITIES] = {1, 1, 1};
+static bool adaptiveQuantum = false;
+static int wakeupsWaiting = 0; // Woken processes not yet dispatched
+static int lastDispatchedPid = -1;
+static SchedulerStats stats;
+
+ProcessQueue *Scheduler_getPriorityQueues()
 {
-    return priorityQueues;
+    return Group_get(0)->queues;
+}
+
+int Scheduler_readyCount()
+{
+    return Group_readyCount() + Edf_readyCount();
 }
 
 void Scheduler_init()
 {
-    for (int i = 0; i < NUM_PRIORITIES; i++)
+    Group_init();
+    currentPriority = 0;
+    currentProcess = NULL;
+    currentTime = 0;
+    wakeupsWaiting = 0;
+    lastDispatchedPid = -1;
+    stats = (SchedulerStats){0};
+}
+
+// Quantum the process gets when dispatched. In adaptive mode a process that keeps using its whole
+// quantum gets up to twice its recent average burst, so CPU-bound work switches less often.
+static int quantum_for(const PCB *process)
+{
+    int base = quantum[process->priority];
+    if (!adaptiveQuantum)
+    {
+        return base;
+    }
+    int adaptive = (2 * process->burstEstimate + SCHEDULER_BURST_SCALE - 1) / SCHEDULER_BURST_SCALE;
+    if (adaptive > SCHEDULER_MAX_QUANTUM)
+    {
+        adaptive = SCHEDULER_MAX_QUANTUM;
+    }
+    return adaptive > base ? adaptive : base;
+}
+
+// Ends the running process's CPU burst, folding its length into the average (weight 1/4)
+static void end_burst(PCB *process)
+{
+    if (process != NULL && process != initProcess)
+    {
+        process->burstEstimate += (process->sliceUsed * SCHEDULER_BURST_SCALE - process->burstEstimate) / 4;
+        process->sliceUsed = 0;
+    }
+}
+
+// Gives the CPU to process, counting a context switch and the response time of a wake-up
+static void dispatch(PCB *process)
+{
+    currentProcess = process;
+    if (process == NULL)
+    {
+        return;
+    }
+    process->state = RUNNING;
+    process->sliceUsed = 0;
+    if (process->pid != lastDispatchedPid)
+    {
+        stats.contextSwitches++;
+        lastDispatchedPid = process->pid;
+    }
+    if (process->readySince >= 0)
     {
-        priorityQueues[i] = List_create();
-        if (priorityQueues[i] == NULL)
+        long response = currentTime - process->readySince;
+        stats.responses++;
+        stats.responseTotal += response;
+        if (response > stats.responseMax)
         {
-            // Handle error: unable to create list for priority queue
+            stats.responseMax = response;
         }
+        process->readySince = -1;
+        wakeupsWaiting--;
+    }
+}
+
+// Queues a ready process. A wake-up (or a new process) starts a response-time measurement.
+static void make_ready(PCB *process, bool wakeup)
+{
+    if (wakeup && process != initProcess && process->readySince < 0)
+    {
+        process->readySince = currentTime;
+        wakeupsWaiting++;
+    }
+
+    // Set the process state to READY when it's scheduled.
+    process->state = READY;
+    if (Edf_isRealTime(process))
+    {
+        Edf_enqueue(process); // By deadline, or held back until its next release if out of budget
+    }
+    else if (process != initProcess)
+    {
+        Group_enqueue(process, false);
     }
-    currentPriority = 0;
-    currentProcess = NULL;
 }
 
 void Scheduler_scheduleProcess(PCB *process)
@@ -39,60 +133,160 @@ void Scheduler_scheduleProcess(PCB *process)
         // Invalid process or priority
         return;
     }
-
-    // Set the process state to READY when it's scheduled.
-    process->state = READY;
-    List_append(priorityQueues[process->priority], process);
+    make_ready(process, true);
 }
 
-PCB *Scheduler_getNextProcess()
+void Scheduler_scheduleQueue(ProcessQueue *waiters)
 {
-    // Iterate over priority levels from highest to lowest
-    for (int i = 0; i < NUM_PRIORITIES; i++)
+    if (waiters == NULL || waiters->head == NULL)
+    {
+        return;
+    }
+    int priority = waiters->head->priority;
+    int groupId = waiters->head->groupId;
+    PCB *process = waiters->head;
+    while (process != NULL)
     {
-        if (List_count(priorityQueues[i]) > 0)
+        PCB *next = process->queueNext;
+        if (process->priority != priority || process->groupId != groupId || process == initProcess ||
+            Edf_isRealTime(process))
         {
-            PCB *prevProcess = (PCB *)currentProcess;
-            if (prevProcess)
-            {
-                prevProcess->state = READY; // Previous process is now ready
-            }
-
-            // Found the next process to run
-            currentProcess = List_trim(priorityQueues[i]); // Get the first process from the queue
-            if (currentProcess)
-            {
-                ((PCB *)currentProcess)->state = RUNNING; // New process is now running
-            }
-            return (PCB *)currentProcess;
+            processQueueRemove(process);
+            Scheduler_scheduleProcess(process);
         }
+        else
+        {
+            process->state = READY;
+            process->readySince = currentTime;
+            wakeupsWaiting++;
+        }
+        process = next;
+    }
+    Group_enqueueAll(waiters);
+}
+
+// Dispatches the most urgent ready process, or init if none is ready
+static PCB *pick_next()
+{
+    // Real-time processes come before every priority level, earliest deadline first
+    PCB *realTime = Edf_pickNext();
+    if (realTime != NULL)
+    {
+        Scheduler_setCurrentProcess(realTime);
+        return realTime;
+    }
+
+    // Then the group with the smallest share of its CPU used, and the most urgent process in it
+    PCB *process = Group_pickNext();
+    if (process != NULL)
+    {
+        Scheduler_setCurrentProcess(process);
+        return process;
+    }
+
+    // Nothing is ready, so the init process runs
+    if (initProcess != NULL)
+    {
+        Scheduler_setCurrentProcess(initProcess);
+        return initProcess;
     }
     return NULL; // No process found, system idle
 }
 
+// Signals posted while a process was off the CPU take effect as it is dispatched. Returns false
+// if one terminated it; the process has then been freed and nothing is running.
+static bool deliver_signals(PCB *process)
+{
+    if (process == NULL || process == initProcess || process->pendingSignals == 0 || Signal_deliver(process))
+    {
+        return true;
+    }
+    currentProcess = NULL;
+    process->state = TERMINATED;
+    Edf_release(process);
+    destroyPCB(process);
+    return false;
+}
+
+PCB *Scheduler_getNextProcess()
+{
+    PCB *process = pick_next();
+    while (!deliver_signals(process))
+    {
+        process = pick_next(); // The CPU goes to the next in line
+    }
+    return process;
+}
+
 void Scheduler_timeQuantumExpired()
+{
+    Scheduler_tick(RUNNING);
+}
+
+void Scheduler_tick(ProcessState runningState)
 {
     PCB *currentPCB = (PCB *)currentProcess;
+    currentTime++;
+    Stats_advanceTime(currentTime); // Samples the queues as they stood over the tick that just ended
+    semaphoreAccountQuantum(currentPCB);
+
+    // Init gives way at every tick; anyone else keeps the CPU until its quantum is used up, its
+    // real-time budget or group cap runs out, or a wake-up cuts an adaptive extension short
+    bool expired = currentPCB == NULL || currentPCB == initProcess;
+    if (Edf_isRealTime(currentPCB))
+    {
+        expired |= Edf_chargeQuantum(currentPCB, 1); // An exhausted job is held back by make_ready below
+    }
+    else if (!expired)
+    {
+        Group_chargeQuantum(currentPCB, 1);
+        expired |= Group_get(currentPCB->groupId)->throttled;
+    }
+    Edf_advanceTime(currentTime);
+    Group_advanceTime(currentTime);
+    Workload_advanceTime(currentTime);
+    Device_advanceTime(currentTime);
+    if (currentPCB != NULL && currentPCB != initProcess && runningState != RUNNING)
+    {
+        // It blocked or finished during the tick rather than being preempted
+        end_burst(currentPCB);
+        currentPCB->state = runningState;
+        currentProcess = NULL;
+        Scheduler_getNextProcess();
+        return;
+    }
+    if (!expired)
+    {
+        currentPCB->sliceUsed++;
+        expired = currentPCB->sliceUsed >= quantum_for(currentPCB) ||
+                  (wakeupsWaiting > 0 && currentPCB->sliceUsed >= quantum[currentPCB->priority]) ||
+                  Edf_readyCount() > 0; // A released real-time job preempts ordinary processes
+        if (!expired)
+        {
+            return;
+        }
+    }
     if (currentPCB != NULL)
     {
-        // Before moving to the next process, set the state of the current process to READY.
-        currentPCB->state = READY;
+        if (currentPCB != initProcess)
+        {
+            stats.quantaExpired++;
+        }
+        end_burst(currentPCB);
 
-        // Remove the current process from the front and re-insert it at the end of its priority queue for round-robin scheduling.
-        List_append(priorityQueues[currentPCB->priority], currentPCB);
+        // Re-insert it at the end of its priority queue for round-robin scheduling (init is never queued).
+        make_ready(currentPCB, false);
         currentProcess = NULL; // Clear the current process pointer
     }
 
-    // Now, get the next process to run. The getNextProcess function will set the state of the chosen process to RUNNING.
-    currentPCB = Scheduler_getNextProcess();
+    // Now, get the next process to run. The getNextProcess function will set the state of the chosen process to RUNNING,
+    // falling back to the init process if there's no other process to run.
+    Scheduler_getNextProcess();
+}
 
-    // If there's no other process to run, the init process (which should always be available) is scheduled to run.
-    if (currentPCB == NULL)
-    {
-        // Code to schedule the init process
-        // Note: The init process should be maintained somewhere to be used here.
-        // Set the state of the init process to RUNNING and update currentProcess pointer.
-    }
+void Scheduler_setInitProcess(PCB *process)
+{
+    initProcess = process;
 }
 
 // Function to get the currently running process
@@ -109,42 +303,40 @@ int Scheduler_removeProcess(PCB *process)
     }
     // Set the process state to indicate it is no longer scheduled
     process->state = TERMINATED; // Assuming TERMINATED is a defined state
-    if (process == NULL)
+    if (process->readySince >= 0)
     {
-        return -1;
+        process->readySince = -1; // Its wake-up will never be dispatched
+        wakeupsWaiting--;
     }
-    for (int i = 0; i < NUM_PRIORITIES; i++)
+    if (Edf_isRealTime(process))
     {
-        List *queue = priorityQueues[i];
-        for (Node *node = queue->head; node != NULL; node = node->next)
-        {
-            if (node->item == process)
-            {
-                // Found the process node, remove it
-                if (node == queue->head)
-                {
-                    queue->head = node->next;
-                }
-                else
-                {
-                    node->previous->next = node->next;
-                }
-                if (node == queue->tail)
-                {
-                    queue->tail = node->previous;
-                }
-                else
-                {
-                    node->next->previous = node->previous;
-                }
-                // Free the node
-                pushToFreeNodeStack(node);
-                queue->size--;
-                return 0;
-            }
-        }
+        bool queued = Edf_dequeue(process);
+        Edf_release(process);
+        return queued ? 0 : -1;
     }
-    return -1;
+    return Group_dequeue(process) ? 0 : -1;
+}
+
+void Scheduler_setPriority(PCB *process, int priority)
+{
+    if (process == NULL || priority < 0 || priority >= NUM_PRIORITIES || process->priority == priority)
+    {
+        return;
+    }
+    if (Group_dequeue(process))
+    {
+        process->priority = priority;
+        Group_enqueue(process, false);
+    }
+    else
+    {
+        process->priority = priority;
+    }
+}
+
+long Scheduler_getTime()
+{
+    return currentTime;
 }
 
 void Scheduler_setCurrentProcess(PCB *process)
@@ -153,14 +345,109 @@ void Scheduler_setCurrentProcess(PCB *process)
     PCB *oldProcess = (PCB *)currentProcess;
     if (oldProcess)
     {
+        end_burst(oldProcess);
         oldProcess->state = READY;
     }
 
-    currentProcess = process; // Update the global pointer to the current process
+    // Update the global pointer to the current process and set its state to RUNNING
+    dispatch(process);
+}
 
-    // Set the new current process's state to RUNNING
-    if (process)
+PCB *Scheduler_descheduleCurrentProcess(ProcessState state)
+{
+    PCB *process = (PCB *)currentProcess;
+    if (process != NULL)
     {
-        process->state = RUNNING;
+        end_burst(process);
+        process->state = state;
+        currentProcess = NULL; // Keep Scheduler_getNextProcess from marking it READY
     }
-}
\ No newline at end of file
+    return Scheduler_getNextProcess();
+}
+
+void Scheduler_preemptCurrentProcess()
+{
+    PCB *process = (PCB *)currentProcess;
+    if (process != NULL)
+    {
+        end_burst(process);
+        process->state = READY;
+        if (Edf_isRealTime(process))
+        {
+            Edf_enqueue(process);
+        }
+        else if (process != initProcess)
+        {
+            Group_enqueue(process, true);
+        }
+        currentProcess = NULL;
+    }
+}
+
+PCB *Scheduler_switchTo(PCB *process)
+{
+    end_burst((PCB *)currentProcess); // The caller has already blocked or requeued it
+    if (process != NULL && process->readySince < 0)
+    {
+        process->readySince = currentTime; // Woken and dispatched at once
+        wakeupsWaiting++;
+    }
+    dispatch(process);
+    return deliver_signals(process) ? process : Scheduler_getNextProcess();
+}
+
+bool Scheduler_setQuantum(int priority, int ticks)
+{
+    if (priority < 0 || priority >= NUM_PRIORITIES || ticks < 1 || ticks > SCHEDULER_MAX_QUANTUM)
+    {
+        return false;
+    }
+    quantum[priority] = ticks;
+    return true;
+}
+
+int Scheduler_getQuantum(int priority)
+{
+    return priority >= 0 && priority < NUM_PRIORITIES ? quantum[priority] : 0;
+}
+
+void Scheduler_setAdaptiveQuantum(bool enabled)
+{
+    adaptiveQuantum = enabled;
+}
+
+bool Scheduler_isAdaptiveQuantum()
+{
+    return adaptiveQuantum;
+}
+
+SchedulerStats Scheduler_getStats()
+{
+    return stats;
+}
+
+void Scheduler_save(SnapshotWriter *writer)
+{
+    Snapshot_putPid(writer, (PCB *)currentProcess);
+    Snapshot_putPid(writer, initProcess);
+    Snapshot_putLong(writer, currentTime);
+    Snapshot_putInt(writer, currentPriority);
+    Snapshot_putBytes(writer, quantum, sizeof(quantum));
+    Snapshot_putInt(writer, adaptiveQuantum);
+    Snapshot_putInt(writer, wakeupsWaiting);
+    Snapshot_putInt(writer, lastDispatchedPid);
+    Snapshot_putBytes(writer, &stats, sizeof(stats));
+}
+
+void Scheduler_restore(SnapshotReader *reader)
+{
+    currentProcess = Snapshot_getPcb(reader);
+    initProcess = Snapshot_getPcb(reader);
+    currentTime = Snapshot_getLong(reader);
+    currentPriority = Snapshot_getInt(reader);
+    Snapshot_getBytes(reader, quantum, sizeof(quantum));
+    adaptiveQuantum = Snapshot_getInt(reader) != 0;
+    wakeupsWaiting = Snapshot_getInt(reader);
+    lastDispatchedPid = Snapshot_getInt(reader);
+    Snapshot_getBytes(reader, &stats, sizeof(stats));
+}
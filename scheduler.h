@@ -1,21 +1,104 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 
-#include "list.h" // Make sure to include the correct header for the list implementation
-#include "pcb.h"  // Assuming PCB structure is defined in pcb.h
+#include "pcb.h"  // Assuming PCB structure is defined in pcb.h, along with ProcessQueue
 void Scheduler_setCurrentProcess(PCB* process);
 
 #define NUM_PRIORITIES 3
+// Longest quantum, in timer ticks, fixed or adaptive
+#define SCHEDULER_MAX_QUANTUM 16
+// Fixed-point scale of PCB burstEstimate
+#define SCHEDULER_BURST_SCALE 256
+
+// Counters for judging quantum settings
+typedef struct SchedulerStats
+{
+    long contextSwitches; // Dispatches of a different process than the last one
+    long quantaExpired;   // Times a process was preempted at the end of its quantum
+    long responses;       // Wake-ups that have since been dispatched
+    long responseTotal;   // Ticks those wake-ups spent ready before running
+    long responseMax;
+} SchedulerStats;
+
 // Initialize the scheduler. This should be called before any other scheduler function.
 void Scheduler_init();
 
+// Registers the init process. It is never placed in a ready queue; it runs whenever no other
+// process is ready. Pass NULL once init has exited.
+void Scheduler_setInitProcess(PCB* process);
+
 // Schedule a process. Adds the process to the scheduler in the appropriate priority queue.
 void Scheduler_scheduleProcess(PCB* process);
 
-// Get the next process to run based on priority and round-robin scheduling.
+// Makes every process in waiters ready in one splice onto the back of the ready queue for
+// their priority, leaving waiters empty. Processes whose priority differs from the first
+// one's (after an inherited boost) are queued individually. Each process is still visited
+// once to mark it ready, so this is O(n); the splice saves the per-process enqueue.
+void Scheduler_scheduleQueue(ProcessQueue* waiters);
+
+// Get the next process to run based on priority and round-robin scheduling. Pending signals of
+// the chosen process are delivered first (signals.h); if one terminates it, it is freed and
+// the next process is chosen instead.
 PCB* Scheduler_getNextProcess();
 
-// Called when the time quantum for the currently running process expires.
+// Returns the running process, or NULL if the system is idle.
+PCB* Scheduler_getCurrentProcess();
+
+// Removes a process from its ready queue in O(1) and marks it TERMINATED; a real-time process also
+// leaves the EDF class. Returns 0 on success, -1 if it was not queued.
+int Scheduler_removeProcess(PCB* process);
+
+// Returns the NUM_PRIORITIES ready queues of the default process group, highest priority first.
+ProcessQueue* Scheduler_getPriorityQueues();
+
+// Number of processes ready to run in every scheduling class, not counting init.
+int Scheduler_readyCount();
+
+// Changes a process's effective priority. A ready process moves to the back of its new
+// queue in O(1); a running or blocked process uses the new priority the next time it is queued.
+void Scheduler_setPriority(PCB* process, int priority);
+
+// Simulated time in timer ticks.
+long Scheduler_getTime();
+
+// Called on every timer tick. The running process is preempted once it has used its quantum.
 void Scheduler_timeQuantumExpired();
 
+// Timer tick at the end of which the running process leaves the CPU in runningState (a blocked
+// state or TERMINATED) instead, e.g. because its CPU burst ended. RUNNING is a plain tick.
+void Scheduler_tick(ProcessState runningState);
+
+// Sets the quantum of a priority level in ticks (1 to SCHEDULER_MAX_QUANTUM). All default to 1.
+bool Scheduler_setQuantum(int priority, int ticks);
+int Scheduler_getQuantum(int priority);
+
+// In adaptive mode each process's quantum grows to twice its recent average CPU burst (never
+// below its level's quantum), so CPU-bound processes switch less. While any woken process is
+// waiting to run, extensions beyond the level's quantum are cut short, which keeps interactive
+// latency at what the fixed quantum would give.
+void Scheduler_setAdaptiveQuantum(bool enabled);
+bool Scheduler_isAdaptiveQuantum();
+
+SchedulerStats Scheduler_getStats();
+
+// Takes the running process off the CPU in the given state (a blocked state or TERMINATED)
+// and dispatches the next ready process. Returns the new running process, or NULL if idle.
+PCB* Scheduler_descheduleCurrentProcess(ProcessState state);
+
+// Puts the running process back at the front of its ready queue without dispatching anyone.
+void Scheduler_preemptCurrentProcess();
+
+// Runs process immediately, bypassing the ready queues. The caller must already have blocked
+// or requeued the process that was running. Pending signals are delivered as by
+// Scheduler_getNextProcess; returns the process that ends up running, which is not process if
+// a signal terminated it.
+PCB* Scheduler_switchTo(PCB* process);
+
+// Snapshot support (snapshot.h): the clock, running and init processes, quanta and statistics.
+// Ready queues belong to the group and EDF modules and are saved there.
+struct SnapshotWriter;
+struct SnapshotReader;
+void Scheduler_save(struct SnapshotWriter* writer);
+void Scheduler_restore(struct SnapshotReader* reader);
+
 #endif // SCHEDULER_H
@@ -1,16 +1,127 @@
 #include "semaphore.h"
+#include "scheduler.h"
+#include "deadlock.h"
+#include "pidtable.h"
+#include "snapshot.h"
+#include "stats.h"
 #include <stdlib.h>
 
+static bool inheritanceEnabled = true;
+static int blockedByPriority[NUM_PRIORITIES]; // Semaphore waiters across all semaphores
+static long inversionQuanta = 0;
+
 // Initializes a semaphore with a given value
 void initializeSemaphore(Semaphore *semaphore, int initialValue)
 {
     if (semaphore != NULL)
     {
         semaphore->value = initialValue;
-        semaphore->queueSize = 0; // No process is waiting initially
+        processQueueInit(&semaphore->queue); // No process is waiting initially
+        for (int i = 0; i < NUM_PRIORITIES; i++)
+        {
+            semaphore->waiterCounts[i] = 0;
+        }
+        semaphore->holderPid = -1;
     }
 }
 
+// Returns the most urgent priority among the semaphore's waiters, or NUM_PRIORITIES if none
+static int highest_waiter_priority(const Semaphore *semaphore)
+{
+    int priority = 0;
+    while (priority < NUM_PRIORITIES && semaphore->waiterCounts[priority] == 0)
+    {
+        priority++;
+    }
+    return priority;
+}
+
+// Changes a process's effective priority, keeping the waiter counts right if it is itself
+// waiting on a semaphore
+static void set_priority(PCB *process, int priority)
+{
+    Semaphore *waitingOn = process->state == BLOCKED_ON_SEMAPHORE ? process->waitsOnSemaphore : NULL;
+    if (waitingOn != NULL)
+    {
+        waitingOn->waiterCounts[process->priority]--;
+        blockedByPriority[process->priority]--;
+        waitingOn->waiterCounts[priority]++;
+        blockedByPriority[priority]++;
+    }
+    Scheduler_setPriority(process, priority); // Requeues a ready process in O(1)
+}
+
+// Raises the holder of semaphore to priority, following the holder's own semaphore wait so a
+// chain of holders all run at least as urgently as the waiter at its end
+static void inherit_priority(Semaphore *semaphore, int priority)
+{
+    int limit = PidTable_count();
+    for (int steps = 0; semaphore != NULL && steps < limit; steps++)
+    {
+        PCB *holder = PidTable_lookup(semaphore->holderPid);
+        if (holder == NULL || holder->priority <= priority)
+        {
+            return;
+        }
+        set_priority(holder, priority);
+        semaphore = holder->waitsOnSemaphore;
+    }
+}
+
+// Records that process acquired semaphore
+static void add_hold(PCB *process, Semaphore *semaphore)
+{
+    semaphore->holderPid = process->pid;
+    if (process->heldSemaphoreCount < PCB_MAX_HELD_SEMAPHORES)
+    {
+        process->heldSemaphores[process->heldSemaphoreCount++] = semaphore;
+    }
+}
+
+// Forgets one hold process has on semaphore, if it has any
+static void remove_hold(PCB *process, Semaphore *semaphore)
+{
+    for (int i = 0; i < process->heldSemaphoreCount; i++)
+    {
+        if (process->heldSemaphores[i] == semaphore)
+        {
+            process->heldSemaphoreCount--;
+            for (; i < process->heldSemaphoreCount; i++)
+            {
+                process->heldSemaphores[i] = process->heldSemaphores[i + 1];
+            }
+            return;
+        }
+    }
+}
+
+// Sets process to its own priority, or that of the most urgent waiter on a semaphore it holds
+static void recompute_priority(PCB *process)
+{
+    int priority = process->basePriority;
+    for (int i = 0; inheritanceEnabled && i < process->heldSemaphoreCount; i++)
+    {
+        int waiting = highest_waiter_priority(process->heldSemaphores[i]);
+        if (waiting < priority)
+        {
+            priority = waiting;
+        }
+    }
+    if (process->priority != priority)
+    {
+        set_priority(process, priority);
+    }
+}
+
+// Unlinks a waiter from the semaphore's queue and the per-priority counts
+static void remove_waiter(Semaphore *semaphore, PCB *process)
+{
+    processQueueRemove(process);
+    semaphore->waiterCounts[process->priority]--;
+    blockedByPriority[process->priority]--;
+    Stats_add(STATS_SEMAPHORE_WAITERS, -1);
+}
+
 // P (Wait) operation on a semaphore
 void semaphoreP(Semaphore* semaphore, PCB* process) {
     if (semaphore == NULL || process == NULL) return;
@@ -18,39 +129,131 @@ void semaphoreP(Semaphore* semaphore, PCB* process) {
     semaphore->value--;
     if (semaphore->value < 0) {
         // Block the process if semaphore value is negative
-        if (semaphore->queueSize < MAX_QUEUE_SIZE) {
-            semaphore->queue[semaphore->queueSize++] = process;
-            process->state = BLOCKED_ON_SEMAPHORE;
+        processQueueAppend(&semaphore->queue, process);
+        semaphore->waiterCounts[process->priority]++;
+        blockedByPriority[process->priority]++;
+        Stats_add(STATS_SEMAPHORE_WAITERS, 1);
+        process->state = BLOCKED_ON_SEMAPHORE;
+        Deadlock_waitForSemaphore(process, semaphore);
+        if (inheritanceEnabled) {
+            inherit_priority(semaphore, process->priority);
         }
-        // Else, you might want to handle the case where the semaphore queue is full.
     } else {
         // If the semaphore is not negative, the process continues without blocking.
         process->state = RUNNING;
+        add_hold(process, semaphore);
     }
 }
 
 
 // V (Signal) operation on a semaphore
-void semaphoreV(Semaphore* semaphore) {
+void semaphoreV(Semaphore* semaphore, PCB *releaser) {
     if (semaphore == NULL) return;
 
+    // Only the releasing process loses the boost this semaphore's waiters gave it; waiters on
+    // semaphores it still holds keep it raised
+    if (releaser != NULL) {
+        remove_hold(releaser, semaphore);
+        recompute_priority(releaser);
+    }
+
     semaphore->value++;
-    if (semaphore->value <= 0 && semaphore->queueSize > 0) {
+    if (semaphore->value <= 0 && semaphore->queue.head != NULL) {
         // Unblock the first process in the queue if the semaphore value is non-positive
-        PCB* process = semaphore->queue[0];
-        
-        // Shift the queue
-        for (int i = 1; i < semaphore->queueSize; i++) {
-            semaphore->queue[i - 1] = semaphore->queue[i];
-        }
-        semaphore->queueSize--;
+        PCB* process = semaphore->queue.head;
+        remove_waiter(semaphore, process);
+
+        // The woken process now holds the semaphore; its own wait edge goes away
+        add_hold(process, semaphore);
+        Deadlock_clearWait(process);
 
         // Update the process state and reschedule it.
         process->state = READY;
         Scheduler_scheduleProcess(process);
-        
-        // Optionally, if you have a function to immediately switch to this process, call it here
-        // e.g., Scheduler_setCurrentProcess(process);
+
+        // Remaining waiters more urgent than the new holder lend it their priority
+        if (inheritanceEnabled) {
+            inherit_priority(semaphore, highest_waiter_priority(semaphore));
+        }
+    } else if (semaphore->value > 0) {
+        semaphore->holderPid = -1; // Released with nobody waiting
     }
     // No need to wake up the process explicitly if it will be handled by the scheduler.
 }
+
+// Takes a blocked process out of its semaphore's queue without it acquiring the semaphore,
+// undoing the effect of its P. Used when the process is killed while waiting.
+void semaphoreCancelWait(PCB *process)
+{
+    if (process == NULL || process->state != BLOCKED_ON_SEMAPHORE || process->waitsOnSemaphore == NULL)
+    {
+        return;
+    }
+    Semaphore *semaphore = process->waitsOnSemaphore;
+    remove_waiter(semaphore, process);
+    semaphore->value++;
+    Deadlock_clearWait(process);
+
+    // The holder no longer runs at this waiter's priority on its account
+    PCB *holder = PidTable_lookup(semaphore->holderPid);
+    if (holder != NULL)
+    {
+        recompute_priority(holder);
+    }
+}
+
+void semaphoreSetPriorityInheritance(bool enabled)
+{
+    inheritanceEnabled = enabled;
+}
+
+void semaphoreAccountQuantum(PCB *running)
+{
+    if (running == NULL)
+    {
+        return;
+    }
+    for (int priority = 0; priority < running->priority; priority++)
+    {
+        if (blockedByPriority[priority] > 0)
+        {
+            inversionQuanta++;
+            return;
+        }
+    }
+}
+
+long semaphoreInversionQuanta()
+{
+    return inversionQuanta;
+}
+
+void semaphoreSaveState(SnapshotWriter *writer)
+{
+    Snapshot_putInt(writer, inheritanceEnabled);
+    Snapshot_putBytes(writer, blockedByPriority, sizeof(blockedByPriority));
+    Snapshot_putLong(writer, inversionQuanta);
+}
+
+void semaphoreRestoreState(SnapshotReader *reader)
+{
+    inheritanceEnabled = Snapshot_getInt(reader) != 0;
+    Snapshot_getBytes(reader, blockedByPriority, sizeof(blockedByPriority));
+    inversionQuanta = Snapshot_getLong(reader);
+}
+
+void semaphoreSave(SnapshotWriter *writer, const Semaphore *semaphore)
+{
+    Snapshot_putInt(writer, semaphore->value);
+    Snapshot_putInt(writer, semaphore->holderPid);
+    Snapshot_putBytes(writer, semaphore->waiterCounts, sizeof(semaphore->waiterCounts));
+    Snapshot_putQueue(writer, &semaphore->queue);
+}
+
+void semaphoreRestore(SnapshotReader *reader, Semaphore *semaphore)
+{
+    initializeSemaphore(semaphore, Snapshot_getInt(reader));
+    semaphore->holderPid = Snapshot_getInt(reader);
+    Snapshot_getBytes(reader, semaphore->waiterCounts, sizeof(semaphore->waiterCounts));
+    Snapshot_getQueue(reader, &semaphore->queue);
+}
@@ -2,21 +2,42 @@
 #define SEMAPHORE_H
 
 #include "pcb.h" // Include the PCB definition for managing process queues
-
-#define MAX_QUEUE_SIZE 10 // Maximum queue size for each semaphore
-#include "list.h"
-List **Scheduler_getPriorityQueues();
+#include "scheduler.h" // NUM_PRIORITIES
 
 typedef struct Semaphore
 {
     int value;                  // The semaphore value
-    PCB *queue[MAX_QUEUE_SIZE]; // Queue of PCBs waiting on this semaphore
-    int queueSize;              // Number of PCBs in the queue
+    ProcessQueue queue;         // Queue of PCBs waiting on this semaphore, in arrival order
+    int waiterCounts[NUM_PRIORITIES]; // Waiters per priority level, to find the most urgent one in O(1)
+    int holderPid;              // Process that most recently acquired the semaphore, -1 if none
 } Semaphore;
 
 // Function prototypes
 void initializeSemaphore(Semaphore *semaphore, int initialValue);
 void semaphoreP(Semaphore *semaphore, PCB *process);
-void semaphoreV(Semaphore *semaphore);
+void semaphoreV(Semaphore *semaphore, PCB *releaser); // releaser may be NULL
+void semaphoreCancelWait(PCB *process);
+
+// Priority inheritance: while a more urgent process waits on a semaphore, its holder (and
+// anyone the holder is itself waiting on) runs at the waiter's priority. When a process calls
+// V it drops to the priority of the most urgent waiter on the semaphores it still holds, or its
+// own if that is more urgent. Enabled by default.
+void semaphoreSetPriorityInheritance(bool enabled);
+
+// Called once per quantum with the process that used it. Counts the quantum as priority
+// inversion if a process more urgent than the running one is blocked on a semaphore.
+void semaphoreAccountQuantum(PCB *running);
+
+// Quanta counted as priority inversion since startup.
+long semaphoreInversionQuanta();
+
+// Snapshot support (snapshot.h): the inheritance setting and inversion accounting. Semaphores
+// themselves are saved by their owner with semaphoreSave and semaphoreRestore.
+struct SnapshotWriter;
+struct SnapshotReader;
+void semaphoreSaveState(struct SnapshotWriter *writer);
+void semaphoreRestoreState(struct SnapshotReader *reader);
+void semaphoreSave(struct SnapshotWriter *writer, const Semaphore *semaphore);
+void semaphoreRestore(struct SnapshotReader *reader, Semaphore *semaphore);
 
 #endif // SEMAPHORE_H
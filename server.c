@@ -0,0 +1,450 @@
+#define _GNU_SOURCE
+#include "server.h"
+#include "shell.h"
+#include "commands.h"
+#include "ring.h"
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// All commands that arrived on one client since its last batch run together: the complete
+// lines go through a single in-memory stream, and their output is captured for the whole
+// epoll round by pointing stdout at one scratch file, so no syscall is made per command.
+typedef struct Client
+{
+    int fd;
+    unsigned events;  // Events currently registered with epoll
+    bool closing;     // Q was read; close once the pending output is sent
+    char in[SERVER_INPUT_SIZE];
+    size_t inLength;
+    char *out;
+    size_t outStart;  // First byte not yet sent
+    size_t outLength; // End of the pending output
+    size_t outCapacity;
+} Client;
+
+static int epollFd = -1;
+static int listenFd = -1;
+static int signalFd = -1;
+static int captureFd = -1; // Receives stdout while commands run
+static int savedStdout = -1;
+static int clientCount = 0;
+
+// Markers for the two non-client descriptors in epoll_event.data
+static char listenMarker;
+static char signalMarker;
+
+static void close_client(Client *client)
+{
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    free(client->out);
+    free(client);
+    clientCount--;
+}
+
+// Registers interest in reading while the client's output is under the limit, and in writing
+// while it has output pending
+static void update_events(Client *client)
+{
+    unsigned events = 0;
+    if (!client->closing && client->outLength - client->outStart < SERVER_MAX_PENDING_OUTPUT)
+    {
+        events |= EPOLLIN;
+    }
+    if (client->outStart < client->outLength)
+    {
+        events |= EPOLLOUT;
+    }
+    if (events != client->events)
+    {
+        struct epoll_event event = {.events = events, .data.ptr = client};
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, client->fd, &event);
+        client->events = events;
+    }
+}
+
+// Sends as much pending output as the socket takes. Returns false if the client is gone.
+static bool flush_client(Client *client)
+{
+    while (client->outStart < client->outLength)
+    {
+        ssize_t sent = send(client->fd, client->out + client->outStart, client->outLength - client->outStart,
+                            MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        client->outStart += (size_t)sent;
+    }
+    client->outStart = client->outLength = 0;
+    return !client->closing;
+}
+
+// Moves the output captured since *captured to the client's pending output
+static bool collect_output(Client *client, off_t *captured)
+{
+    fflush(stdout);
+    off_t end = lseek(captureFd, 0, SEEK_CUR);
+    size_t length = (size_t)(end - *captured);
+    if (length == 0)
+    {
+        return true;
+    }
+    if (client->outStart > 0 && client->outStart == client->outLength)
+    {
+        client->outStart = client->outLength = 0;
+    }
+    if (client->outLength + length > client->outCapacity)
+    {
+        size_t capacity = client->outCapacity ? client->outCapacity : 4096;
+        while (capacity < client->outLength + length)
+        {
+            capacity *= 2;
+        }
+        char *out = realloc(client->out, capacity);
+        if (out == NULL)
+        {
+            return false;
+        }
+        client->out = out;
+        client->outCapacity = capacity;
+    }
+    if (pread(captureFd, client->out + client->outLength, length, *captured) != (ssize_t)length)
+    {
+        return false;
+    }
+    client->outLength += length;
+    *captured = end;
+    return true;
+}
+
+// Runs every complete line the client has sent. Returns false if the client must be dropped.
+static bool run_batch(Client *client, off_t *captured)
+{
+    char *lastNewline = memrchr(client->in, '\n', client->inLength);
+    if (lastNewline == NULL)
+    {
+        if (client->inLength < SERVER_INPUT_SIZE)
+        {
+            return true;
+        }
+        printf("Command line too long.\n.\n");
+        client->inLength = 0;
+        return collect_output(client, captured);
+    }
+
+    size_t batchLength = (size_t)(lastNewline - client->in) + 1;
+    FILE *batch = fmemopen(client->in, batchLength, "r");
+    if (batch == NULL)
+    {
+        return false;
+    }
+    ShellResult result;
+    while ((result = Shell_runCommand(batch)) == SHELL_CONTINUE)
+    {
+        printf(".\n");
+    }
+    fclose(batch);
+    if (result == SHELL_QUIT)
+    {
+        printf(".\n");
+        client->closing = true;
+        client->inLength = 0;
+    }
+    else
+    {
+        memmove(client->in, client->in + batchLength, client->inLength - batchLength);
+        client->inLength -= batchLength;
+    }
+    return collect_output(client, captured);
+}
+
+static void accept_clients()
+{
+    int fd;
+    while ((fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+    {
+        Client *client = malloc(sizeof(Client));
+        if (client == NULL)
+        {
+            close(fd);
+            continue;
+        }
+        client->fd = fd;
+        client->events = EPOLLIN;
+        client->closing = false;
+        client->inLength = 0;
+        client->out = NULL;
+        client->outStart = client->outLength = client->outCapacity = 0;
+        struct epoll_event event = {.events = EPOLLIN, .data.ptr = client};
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+        {
+            close(fd);
+            free(client);
+            continue;
+        }
+        clientCount++;
+    }
+}
+
+// Reads what the client sent and runs it. A client that shuts down its side still gets the
+// output of the commands it sent. Returns false if the client must be dropped.
+static bool read_client(Client *client, off_t *captured)
+{
+    ssize_t received = recv(client->fd, client->in + client->inLength, SERVER_INPUT_SIZE - client->inLength, 0);
+    if (received < 0)
+    {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    client->inLength += (size_t)received;
+    if (received == 0)
+    {
+        client->closing = true;
+    }
+    return run_batch(client, captured);
+}
+
+static bool set_up(const char *path)
+{
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return false;
+    }
+    strcpy(address.sun_path, path);
+    unlink(path);
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &signals, NULL);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0 || bind(listenFd, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+        listen(listenFd, SOMAXCONN) < 0)
+    {
+        perror("socket");
+        return false;
+    }
+    signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    captureFd = memfd_create("simulator-output", MFD_CLOEXEC);
+    savedStdout = dup(STDOUT_FILENO);
+    if (signalFd < 0 || epollFd < 0 || captureFd < 0 || savedStdout < 0)
+    {
+        perror("server");
+        return false;
+    }
+
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = &listenMarker};
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.ptr = &signalMarker;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &event);
+    return true;
+}
+
+bool Server_run(const char *path)
+{
+    if (!set_up(path))
+    {
+        return false;
+    }
+    printf("Listening for commands on %s.\n", path);
+    fflush(stdout);
+
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    bool running = true;
+    while (running)
+    {
+        int ready = epoll_wait(epollFd, events, SERVER_MAX_EVENTS, -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("epoll_wait");
+            break;
+        }
+
+        // Everything printed while this round's commands run lands in the capture file
+        fflush(stdout);
+        dup2(captureFd, STDOUT_FILENO);
+        off_t captured = 0;
+        for (int i = 0; i < ready; i++)
+        {
+            void *source = events[i].data.ptr;
+            if (source == &listenMarker)
+            {
+                accept_clients();
+                continue;
+            }
+            if (source == &signalMarker)
+            {
+                running = false;
+                continue;
+            }
+            Client *client = source;
+            bool alive = true;
+            if (events[i].events & (EPOLLERR | EPOLLHUP) && !(events[i].events & EPOLLIN))
+            {
+                alive = false;
+            }
+            if (alive && events[i].events & EPOLLIN)
+            {
+                alive = read_client(client, &captured);
+            }
+            if (alive)
+            {
+                alive = flush_client(client);
+            }
+            if (!alive)
+            {
+                close_client(client);
+                continue;
+            }
+            update_events(client);
+        }
+        fflush(stdout);
+        dup2(savedStdout, STDOUT_FILENO);
+        ftruncate(captureFd, 0);
+        lseek(captureFd, 0, SEEK_SET);
+    }
+
+    close(listenFd);
+    unlink(path);
+    printf("Server stopped with %d clients connected.\n", clientCount);
+    return true;
+}
+
+static volatile sig_atomic_t ringStopped = 0;
+
+static void stop_ring(int signal)
+{
+    (void)signal;
+    ringStopped = 1;
+}
+
+// Runs one binary command the same way the shell would, logging it in the shell's form
+static int run_ring_command(RingCommand *command)
+{
+    command->message[RING_MESSAGE_LENGTH - 1] = '\0';
+    int *args = command->args;
+    switch (command->op)
+    {
+    case RING_CREATE:
+        Shell_logCommand("C %d", args[0]);
+        return Commands_CreateProcess(args[0]);
+    case RING_FORK:
+        Shell_logCommand("F");
+        return Commands_Fork();
+    case RING_KILL:
+        Shell_logCommand("K %d", args[0]);
+        return Commands_Kill(args[0]);
+    case RING_EXIT:
+        Shell_logCommand("E");
+        return Commands_Exit();
+    case RING_SEND:
+        Shell_logCommand("S %d %s", args[0], command->message);
+        return Commands_Send(args[0], command->message);
+    case RING_RECEIVE:
+        Shell_logCommand("R");
+        return Commands_Receive();
+    case RING_REPLY:
+        Shell_logCommand("Y %d %s", args[0], command->message);
+        return Commands_Reply(args[0], command->message);
+    case RING_NEW_SEMAPHORE:
+        Shell_logCommand("N %d %d", args[0], args[1]);
+        return Commands_NewSemaphore(args[0], args[1]);
+    case RING_P:
+        Shell_logCommand("P %d", args[0]);
+        return Commands_P(args[0]);
+    case RING_V:
+        Shell_logCommand("V %d", args[0]);
+        return Commands_V(args[0]);
+    case RING_TICK:
+        Shell_logCommand("T");
+        return Commands_Quantum();
+    case RING_SYNC:
+    case RING_QUIT:
+        return 0;
+    default:
+        printf("Invalid ring command %d.\n", command->op);
+        return -1;
+    }
+}
+
+bool Server_runRing(const char *name)
+{
+    RingChannel *channel = Ring_create(name, RING_DEFAULT_CAPACITY);
+    if (channel == NULL)
+    {
+        perror("shm_open");
+        return false;
+    }
+    struct sigaction action = {.sa_handler = stop_ring};
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    printf("Listening for commands on shared memory ring %s.\n", name);
+    fflush(stdout);
+
+    long commands = 0;
+    int idle = 0;
+    bool running = true;
+    while (running && !ringStopped)
+    {
+        RingCommand command;
+        int batch = 0;
+        while (batch < SERVER_RING_BATCH && Ring_popCommand(channel, &command))
+        {
+            RingCompletion completion = {.tag = command.tag, .op = command.op};
+            completion.result = run_ring_command(&command);
+            if (command.flags & RING_REPLY_WANTED)
+            {
+                while (!Ring_pushCompletion(channel, &completion) && !ringStopped)
+                {
+                    sched_yield(); // The driver is behind on reading completions
+                }
+            }
+            Shell_exitIfOver();
+            batch++;
+            if (command.op == RING_QUIT)
+            {
+                running = false;
+                break;
+            }
+        }
+        commands += batch;
+
+        if (batch > 0)
+        {
+            idle = 0;
+        }
+        else if (++idle > SERVER_RING_YIELDS)
+        {
+            struct timespec pause = {.tv_sec = 0, .tv_nsec = 100000};
+            nanosleep(&pause, NULL);
+        }
+        else if (idle > SERVER_RING_SPINS)
+        {
+            sched_yield();
+        }
+    }
+
+    Ring_close(channel);
+    printf("Shared memory ring closed after %ld commands.\n", commands);
+    return true;
+}
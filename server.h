@@ -0,0 +1,33 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdbool.h>
+
+// Server mode: the simulator listens on a Unix-domain stream socket and takes commands from any
+// number of clients at once, in a single thread driven by epoll. Each client sends one command
+// per line, in the same form the interactive shell reads, and may pipeline as many lines as it
+// likes. Every command's output is sent back to the client that issued it, followed by a line
+// holding a single '.', so a client can match responses to its commands. Q closes only that
+// client's connection; SIGINT or SIGTERM stop the server.
+
+// Bytes of unprocessed input kept per client; a longer line is rejected
+#define SERVER_INPUT_SIZE 65536
+// Output waiting for a slow client beyond which its further input is left unread
+#define SERVER_MAX_PENDING_OUTPUT (1 << 20)
+// Events handled per epoll_wait call
+#define SERVER_MAX_EVENTS 256
+
+// Serves clients on path until interrupted. Returns false if the server cannot be set up.
+bool Server_run(const char *path);
+
+// Commands taken from the shared-memory ring per pass before the simulator checks for signals
+#define SERVER_RING_BATCH 256
+// Empty polls of the ring before the simulator starts yielding the CPU, and then sleeping
+#define SERVER_RING_SPINS 64
+#define SERVER_RING_YIELDS 4096
+
+// Runs binary commands from the shared-memory channel name (see ring.h) until a RING_QUIT
+// command, SIGINT or SIGTERM. Returns false if the channel cannot be created.
+bool Server_runRing(const char *name);
+
+#endif // SERVER_H
@@ -0,0 +1,806 @@
+#include "shell.h"
+#include "commands.h"
+#include "scheduler.h"
+#include "group.h"
+#include "device.h"
+#include "snapshot.h"
+#include "pidtable.h"
+#include "program.h"
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SHELL_PATH_LENGTH 256
+#define SHELL_COMMENT_LENGTH 256
+
+static const char *commandPrompt =
+    "Enter command (C - Create, D - Create Real-Time, F - Fork, ; - Process State, G - Configure Group, J - Join Group, K - Kill, "
+    "E - Exit, S - Send, : - Tagged Send, R - Receive, < - Selective Receive, Y - Reply, B - Broadcast, = - Multicast to Group, $ - Mailbox Capacity, N - New Semaphore, P - Semaphore P, "
+    "V - Semaphore V, ~ - Condition, ^ - Reader-Writer Lock, + - Futex, T - Timer Tick, U - Set Quantum, L - Adaptive Quanta, | - Priority Inheritance, W - Scripted Workload, "
+    "X - Random Workload, Z - Compare Policies, O - I/O, H - Device Policy, M - Sample Queues, I - Procinfo, "
+    "A - Totalinfo, ! - Signal, & - Signal Action, @ - Create Program, % - Run Programs, > - Snapshot, # - Comment, Q - Quit): ";
+
+static FILE *commandLog = NULL;
+static bool replaying = false;
+static long eventCount = 0;         // State-changing commands run so far
+static long fastForwardTo = 0;      // Event whose output is the first shown again
+static int mutedStdout = -1;        // The real stdout while fast-forwarding
+static long lastArrival = -1;       // Wall-clock milliseconds of the last logged command
+
+// Discards the rest of a malformed command line
+static void skip_line(FILE *in)
+{
+    int c;
+    while ((c = fgetc(in)) != '\n' && c != EOF)
+        ;
+}
+
+static long now_milliseconds()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1000L + time.tv_nsec / 1000000;
+}
+
+// Puts stdout back once the fast-forward target is reached
+static void end_fast_forward()
+{
+    fflush(stdout);
+    dup2(mutedStdout, STDOUT_FILENO);
+    close(mutedStdout);
+    mutedStdout = -1;
+    printf("Fast-forwarded to event %ld.\n", eventCount + 1);
+}
+
+void Shell_setFastForward(long event)
+{
+    fastForwardTo = event;
+    if (event <= eventCount + 1)
+    {
+        if (mutedStdout >= 0)
+        {
+            end_fast_forward();
+        }
+        return;
+    }
+    if (mutedStdout >= 0)
+    {
+        return;
+    }
+    int devNull = open("/dev/null", O_WRONLY);
+    fflush(stdout);
+    mutedStdout = dup(STDOUT_FILENO);
+    if (devNull < 0 || mutedStdout < 0)
+    {
+        close(devNull);
+        close(mutedStdout);
+        mutedStdout = -1;
+        return;
+    }
+    dup2(devNull, STDOUT_FILENO);
+    close(devNull);
+}
+
+long Shell_eventCount()
+{
+    return eventCount;
+}
+
+void Shell_logCommand(const char *format, ...)
+{
+    if (mutedStdout >= 0 && eventCount + 1 >= fastForwardTo)
+    {
+        end_fast_forward();
+    }
+    eventCount++;
+    if (commandLog == NULL || replaying)
+    {
+        return;
+    }
+
+    // Arrival times do not change what the simulator does, but they show how a session was paced
+    long arrival = now_milliseconds();
+    if (lastArrival >= 0 && arrival - lastArrival >= SHELL_ARRIVAL_RESOLUTION_MS)
+    {
+        fprintf(commandLog, "# +%ldms\n", arrival - lastArrival);
+    }
+    lastArrival = arrival;
+
+    va_list args;
+    va_start(args, format);
+    vfprintf(commandLog, format, args);
+    va_end(args);
+    fputc('\n', commandLog);
+    fflush(commandLog);
+}
+
+bool Shell_openLog(const char *path)
+{
+    commandLog = fopen(path, "a");
+    if (commandLog == NULL)
+    {
+        return false;
+    }
+    // The process table size decides which PIDs get handed out, so a new log starts with it
+    fseek(commandLog, 0, SEEK_END);
+    if (ftell(commandLog) == 0)
+    {
+        fprintf(commandLog, "# pids %d\n", PidTable_capacity());
+        fflush(commandLog);
+    }
+    return true;
+}
+
+int Shell_recordedMaxPids(const char *path)
+{
+    FILE *in = fopen(path, "r");
+    int maxPids;
+    if (in == NULL)
+    {
+        return -1;
+    }
+    if (fscanf(in, "# pids %d", &maxPids) != 1)
+    {
+        maxPids = -1;
+    }
+    fclose(in);
+    return maxPids;
+}
+
+void Shell_closeLog()
+{
+    if (commandLog == NULL)
+    {
+        return;
+    }
+    uint64_t digest;
+    if (Snapshot_digest(&digest))
+    {
+        fprintf(commandLog, "# state %016" PRIx64 "\n", digest);
+    }
+    fclose(commandLog);
+    commandLog = NULL;
+}
+
+void Shell_exitIfOver()
+{
+    if (Commands_isSimulationOver() && !replaying)
+    {
+        Shell_closeLog();
+        exit(0);
+    }
+}
+
+bool Shell_replay(const char *path, long offset)
+{
+    FILE *in = fopen(path, "r");
+    if (in == NULL || (offset > 0 && fseek(in, offset, SEEK_SET) != 0))
+    {
+        if (in != NULL)
+        {
+            fclose(in);
+        }
+        return false;
+    }
+    replaying = true;
+    Shell_run(in);
+    replaying = false;
+    fclose(in);
+    return true;
+}
+
+void Shell_printStats()
+{
+    printf("Events: %ld state-changing commands.\n", eventCount);
+    Commands_WorkloadStats();
+    Commands_DeviceStats();
+    Commands_QueueStats();
+    Commands_SchedulerStats();
+    Commands_IpcStats();
+    Commands_InversionStats();
+    Commands_DeadlockStats();
+    Commands_RealTimeStats();
+    Commands_GroupStats();
+    Commands_SignalStats();
+    Commands_ProgramStats();
+}
+
+// Writes a snapshot that corresponds to the log position right after this command
+static void take_snapshot(const char *path)
+{
+    long logOffset = commandLog != NULL ? ftell(commandLog) : -1;
+    if (Program_count() > 0)
+    {
+        printf("Cannot snapshot while processes run programs; their coroutine stacks are not saved.\n");
+    }
+    else if (Snapshot_save(path, logOffset))
+    {
+        printf("Snapshot saved to %s.\n", path);
+    }
+    else
+    {
+        printf("Failed to save snapshot to %s.\n", path);
+    }
+}
+
+// Reads a comment line. A recorded state digest is checked against the current state, so a
+// replayed log confirms it reproduced the recorded run exactly.
+static void read_comment(FILE *in)
+{
+    char comment[SHELL_COMMENT_LENGTH];
+    uint64_t recorded;
+    uint64_t digest;
+    if (fgets(comment, sizeof(comment), in) == NULL)
+    {
+        return;
+    }
+    if (strchr(comment, '\n') == NULL)
+    {
+        skip_line(in);
+    }
+    if (sscanf(comment, " state %" SCNx64, &recorded) != 1 || !Snapshot_digest(&digest))
+    {
+        return;
+    }
+    if (digest == recorded)
+    {
+        printf("Replay matches the recorded state after %ld events.\n", eventCount);
+    }
+    else
+    {
+        printf("Replay diverged from the recorded state after %ld events (%016" PRIx64 ", recorded %016" PRIx64
+               ").\n", eventCount, digest, recorded);
+    }
+}
+
+// Reads the arguments of one command, runs it and logs it. Returns false on Q.
+static bool run_command(char command, FILE *in)
+{
+    int priority;
+    int pid;
+    int id;
+    int value;
+    int cap;
+    unsigned seed;
+    int device;
+    int track;
+    char script[100];
+    char message[MAX_MESSAGE_LENGTH];
+    char path[SHELL_PATH_LENGTH];
+
+    switch (command)
+    {
+    case 'C':
+    case 'c': // For case-insensitivity
+        printf("Enter priority (0=high, 1=norm, 2=low): ");
+        if (fscanf(in, "%d", &priority) != 1)
+        {
+            printf("Invalid input for priority.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("C %d", priority);
+        Commands_CreateProcess(priority);
+        break;
+    case 'D':
+    case 'd':
+        printf("Enter budget and period in quanta: ");
+        if (fscanf(in, "%d %d", &id, &value) != 2)
+        {
+            printf("Invalid input for real-time parameters.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("D %d %d", id, value);
+        Commands_CreateRealTimeProcess(id, value);
+        break;
+    case 'F':
+    case 'f':
+        Shell_logCommand("F");
+        Commands_Fork();
+        break;
+    case ';':
+        printf("Enter state block (0=address space, 1=environment, 2=resource table), byte offset and value to "
+               "write (-1 to read it): ");
+        if (fscanf(in, "%d %d %d", &id, &cap, &value) != 3)
+        {
+            printf("Invalid input for process state.\n");
+            skip_line(in);
+            break;
+        }
+        if (value < 0)
+        {
+            Commands_ReadState(id, cap); // Reports only, so it is not logged
+            break;
+        }
+        Shell_logCommand("; %d %d %d", id, cap, value);
+        Commands_WriteState(id, cap, value);
+        break;
+    case 'G':
+    case 'g':
+        printf("Enter group ID (0-%d), weight and cap percent (0 = none): ", MAX_GROUPS - 1);
+        if (fscanf(in, "%d %d %d", &id, &value, &cap) != 3)
+        {
+            printf("Invalid input for group.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("G %d %d %d", id, value, cap);
+        Commands_ConfigureGroup(id, value, cap);
+        break;
+    case 'J':
+    case 'j':
+        printf("Enter PID and group ID: ");
+        if (fscanf(in, "%d %d", &pid, &id) != 2)
+        {
+            printf("Invalid input for group.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("J %d %d", pid, id);
+        Commands_JoinGroup(pid, id);
+        break;
+    case 'K':
+    case 'k':
+        printf("Enter PID of process to kill: ");
+        if (fscanf(in, "%d", &pid) != 1)
+        {
+            printf("Invalid input for PID.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("K %d", pid);
+        Commands_Kill(pid);
+        break;
+    case '@':
+        printf("Enter priority, program (%s) and two arguments: ", Program_names());
+        if (fscanf(in, "%d %99s %d %d", &priority, script, &id, &value) != 4)
+        {
+            printf("Invalid input for program.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("@ %d %s %d %d", priority, script, id, value);
+        Commands_CreateProgramProcess(priority, script, id, value);
+        break;
+    case '%':
+        printf("Enter number of program steps: ");
+        if (fscanf(in, "%d", &value) != 1)
+        {
+            printf("Invalid input for program steps.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("%% %d", value);
+        Commands_RunPrograms(value);
+        break;
+    case '!':
+        printf("Enter PID and signal (0=INT, 1=TERM, 2=KILL, 3=ALRM, 4=USR): ");
+        if (fscanf(in, "%d %d", &pid, &value) != 2)
+        {
+            printf("Invalid input for signal.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("! %d %d", pid, value);
+        Commands_Signal(pid, value);
+        break;
+    case '&':
+        printf("Enter PID, signal and action (0=default, 1=handle, 2=ignore): ");
+        if (fscanf(in, "%d %d %d", &pid, &id, &value) != 3)
+        {
+            printf("Invalid input for signal action.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("& %d %d %d", pid, id, value);
+        Commands_SetSignalAction(pid, id, value);
+        break;
+    case 'S':
+    case 's':
+        printf("Enter PID of receiver: ");
+        if (fscanf(in, "%d", &pid) != 1)
+        {
+            printf("Invalid input for PID.\n");
+            skip_line(in);
+            break;
+        }
+        printf("Enter message (max %d characters): ", MAX_MESSAGE_LENGTH - 1);
+        if (fscanf(in, " %39[^\n]", message) != 1)
+        {
+            printf("Invalid input for message.\n");
+            break;
+        }
+        Shell_logCommand("S %d %s", pid, message);
+        Commands_Send(pid, message);
+        break;
+    case ':':
+        printf("Enter PID of receiver and tag: ");
+        if (fscanf(in, "%d %d", &pid, &value) != 2)
+        {
+            printf("Invalid input for tagged send.\n");
+            skip_line(in);
+            break;
+        }
+        printf("Enter message (max %d characters): ", MAX_MESSAGE_LENGTH - 1);
+        if (fscanf(in, " %39[^\n]", message) != 1)
+        {
+            printf("Invalid input for message.\n");
+            break;
+        }
+        Shell_logCommand(": %d %d %s", pid, value, message);
+        Commands_SendTagged(pid, value, message);
+        break;
+    case 'R':
+    case 'r':
+        Shell_logCommand("R");
+        Commands_Receive();
+        break;
+    case '<':
+        printf("Enter what to receive (0=from sender PID, 1=with tag) and the PID or tag: ");
+        if (fscanf(in, "%d %d", &value, &id) != 2 || value < 0 || value > 1)
+        {
+            printf("Invalid input for selective receive.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("< %d %d", value, id);
+        if (value == 0)
+        {
+            Commands_ReceiveFrom(id);
+        }
+        else
+        {
+            Commands_ReceiveTagged(id);
+        }
+        break;
+    case 'Y':
+    case 'y':
+        printf("Enter PID of process to reply to: ");
+        if (fscanf(in, "%d", &pid) != 1)
+        {
+            printf("Invalid input for PID.\n");
+            skip_line(in);
+            break;
+        }
+        printf("Enter reply (max %d characters): ", MAX_MESSAGE_LENGTH - 1);
+        if (fscanf(in, " %39[^\n]", message) != 1)
+        {
+            printf("Invalid input for reply.\n");
+            break;
+        }
+        Shell_logCommand("Y %d %s", pid, message);
+        Commands_Reply(pid, message);
+        break;
+    case 'B':
+    case 'b':
+        printf("Enter message (max %d characters): ", MAX_MESSAGE_LENGTH - 1);
+        if (fscanf(in, " %39[^\n]", message) != 1)
+        {
+            printf("Invalid input for message.\n");
+            break;
+        }
+        Shell_logCommand("B %s", message);
+        Commands_Broadcast(message);
+        break;
+    case '=':
+        printf("Enter group ID (0-%d): ", MAX_GROUPS - 1);
+        if (fscanf(in, "%d", &id) != 1)
+        {
+            printf("Invalid input for group ID.\n");
+            skip_line(in);
+            break;
+        }
+        printf("Enter message (max %d characters): ", MAX_MESSAGE_LENGTH - 1);
+        if (fscanf(in, " %39[^\n]", message) != 1)
+        {
+            printf("Invalid input for message.\n");
+            break;
+        }
+        Shell_logCommand("= %d %s", id, message);
+        Commands_Multicast(id, message);
+        break;
+    case '$':
+        printf("Enter PID and mailbox capacity: ");
+        if (fscanf(in, "%d %d", &pid, &value) != 2)
+        {
+            printf("Invalid input for mailbox capacity.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("$ %d %d", pid, value);
+        Commands_SetMailboxCapacity(pid, value);
+        break;
+    case 'N':
+    case 'n':
+        printf("Enter semaphore ID (0-%d) and initial value: ", NUM_SEMAPHORES - 1);
+        if (fscanf(in, "%d %d", &id, &value) != 2)
+        {
+            printf("Invalid input for semaphore.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("N %d %d", id, value);
+        Commands_NewSemaphore(id, value);
+        break;
+    case 'P':
+    case 'p':
+    case 'V':
+    case 'v':
+        printf("Enter semaphore ID: ");
+        if (fscanf(in, "%d", &id) != 1)
+        {
+            printf("Invalid input for semaphore ID.\n");
+            skip_line(in);
+            break;
+        }
+        if (command == 'P' || command == 'p')
+        {
+            Shell_logCommand("P %d", id);
+            Commands_P(id);
+        }
+        else
+        {
+            Shell_logCommand("V %d", id);
+            Commands_V(id);
+        }
+        break;
+    case '~':
+        printf("Enter condition ID (0-%d), operation (0=wait, 1=signal, 2=broadcast) and semaphore a wait "
+               "releases (-1 for none): ", NUM_CONDITIONS - 1);
+        if (fscanf(in, "%d %d %d", &id, &value, &cap) != 3 || value < 0 || value > 2)
+        {
+            printf("Invalid input for condition.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("~ %d %d %d", id, value, cap);
+        if (value == 0)
+        {
+            Commands_ConditionWait(id, cap);
+        }
+        else if (value == 1)
+        {
+            Commands_ConditionSignal(id);
+        }
+        else
+        {
+            Commands_ConditionBroadcast(id);
+        }
+        break;
+    case '^':
+        printf("Enter lock ID (0-%d) and operation (0=read, 1=write, 2=release): ", NUM_RWLOCKS - 1);
+        if (fscanf(in, "%d %d", &id, &value) != 2 || value < 0 || value > 2)
+        {
+            printf("Invalid input for lock.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("^ %d %d", id, value);
+        if (value == 0)
+        {
+            Commands_LockRead(id);
+        }
+        else if (value == 1)
+        {
+            Commands_LockWrite(id);
+        }
+        else
+        {
+            Commands_Unlock(id);
+        }
+        break;
+    case '+':
+        printf("Enter futex key (0-%d), operation (0=wait while the word holds value, 1=wake up to value waiters, "
+               "2=set the word to value) and value: ", NUM_FUTEX_WORDS - 1);
+        if (fscanf(in, "%d %d %d", &id, &value, &cap) != 3 || value < 0 || value > 2)
+        {
+            printf("Invalid input for futex.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("+ %d %d %d", id, value, cap);
+        if (value == 0)
+        {
+            Commands_FutexWait(id, cap);
+        }
+        else if (value == 1)
+        {
+            Commands_FutexWake(id, cap);
+        }
+        else
+        {
+            Commands_FutexSet(id, cap);
+        }
+        break;
+    case 'T':
+    case 't':
+        Shell_logCommand("T");
+        Commands_Quantum();
+        break;
+    case 'U':
+    case 'u':
+        printf("Enter priority (0=high, 1=norm, 2=low) and quantum in ticks: ");
+        if (fscanf(in, "%d %d", &priority, &value) != 2)
+        {
+            printf("Invalid input for quantum.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("U %d %d", priority, value);
+        Commands_SetQuantum(priority, value);
+        break;
+    case 'L':
+    case 'l':
+        printf("Enter 1 to enable adaptive quanta or 0 to disable them: ");
+        if (fscanf(in, "%d", &value) != 1)
+        {
+            printf("Invalid input for adaptive quanta.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("L %d", value);
+        Commands_AdaptiveQuantum(value != 0);
+        break;
+    case '|':
+        printf("Enter 1 to enable priority inheritance or 0 to disable it: ");
+        if (fscanf(in, "%d", &value) != 1)
+        {
+            printf("Invalid input for priority inheritance.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("| %d", value);
+        Commands_PriorityInheritance(value != 0);
+        break;
+    case 'W':
+    case 'w':
+        printf("Enter priority, device for I/O (-1 for none) and burst script (CPU, I/O, CPU, ... ticks): ");
+        if (fscanf(in, "%d %d %99[^\n]", &priority, &id, script) != 3)
+        {
+            printf("Invalid input for workload.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("W %d %d %s", priority, id, script);
+        Commands_CreateScriptedProcess(priority, id, script);
+        break;
+    case 'X':
+    case 'x':
+        printf("Enter process count, priority, mean CPU burst, mean I/O burst, bursts per process, device for I/O "
+               "(-1 for none) and seed: ");
+        if (fscanf(in, "%d %d %d %d %d %d %u", &value, &priority, &id, &cap, &pid, &device, &seed) != 7)
+        {
+            printf("Invalid input for workload.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("X %d %d %d %d %d %d %u", value, priority, id, cap, pid, device, seed);
+        Commands_CreateRandomProcesses(value, priority, id, cap, pid, device, seed);
+        break;
+    case 'O':
+    case 'o':
+        printf("Enter device (0-%d), track (0-%d) and length in ticks: ", NUM_DEVICES - 1, DEVICE_TRACKS - 1);
+        if (fscanf(in, "%d %d %d", &device, &track, &value) != 3)
+        {
+            printf("Invalid input for I/O.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("O %d %d %d", device, track, value);
+        Commands_Io(device, track, value);
+        break;
+    case 'H':
+    case 'h':
+        printf("Enter device (0-%d) and policy (0=FIFO, 1=SCAN, 2=DEADLINE): ", NUM_DEVICES - 1);
+        if (fscanf(in, "%d %d", &device, &value) != 2)
+        {
+            printf("Invalid input for device policy.\n");
+            skip_line(in);
+            break;
+        }
+        Shell_logCommand("H %d %d", device, value);
+        Commands_SetDevicePolicy(device, value);
+        break;
+    case 'M':
+    case 'm':
+        printf("Enter sample period in ticks (0 to stop) and sample file: ");
+        if (fscanf(in, "%d", &value) != 1 || (value > 0 && fscanf(in, " %255[^\n]", path) != 1))
+        {
+            printf("Invalid input for sampler.\n");
+            skip_line(in);
+            break;
+        }
+        if (value > 0)
+        {
+            Shell_logCommand("M %d %s", value, path);
+        }
+        else
+        {
+            Shell_logCommand("M 0");
+        }
+        Commands_StartSampler(value, value > 0 ? path : NULL);
+        break;
+    case 'I':
+    case 'i':
+        printf("Enter PID and format (0=text, 1=JSON): ");
+        if (fscanf(in, "%d %d", &pid, &value) != 2)
+        {
+            printf("Invalid input for Procinfo.\n");
+            skip_line(in);
+            break;
+        }
+        Commands_Procinfo(pid, value != 0); // Reports only, so it is not logged
+        break;
+    case 'A':
+    case 'a':
+        printf("Enter format (0=text, 1=JSON): ");
+        if (fscanf(in, "%d", &value) != 1)
+        {
+            printf("Invalid input for Totalinfo.\n");
+            skip_line(in);
+            break;
+        }
+        Commands_Totalinfo(value != 0);
+        break;
+    case 'Z':
+    case 'z':
+        Commands_ComparePolicies(); // Leaves the simulator state unchanged, so it is not logged
+        break;
+    case '>':
+        printf("Enter snapshot file: ");
+        if (fscanf(in, " %255[^\n]", path) != 1)
+        {
+            printf("Invalid input for snapshot file.\n");
+            break;
+        }
+        Shell_logCommand("> %s", path);
+        if (!replaying)
+        {
+            take_snapshot(path);
+        }
+        break;
+    case '#':
+        read_comment(in);
+        break;
+    case 'Q':
+    case 'q':
+        return false;
+    case 'E':
+    case 'e':
+        Shell_logCommand("E");
+        Commands_Exit();
+        break;
+    default:
+        printf("Invalid command.\n");
+    }
+    return true;
+}
+
+ShellResult Shell_runCommand(FILE *in)
+{
+    char command;
+    Shell_exitIfOver(); // The simulation ended during a replay that has now finished
+    if (fscanf(in, " %c", &command) != 1)
+    { // Note the space before %c to skip any leading whitespace
+        return SHELL_END;
+    }
+    bool keepGoing = run_command(command, in);
+    Shell_exitIfOver();
+    return keepGoing ? SHELL_CONTINUE : SHELL_QUIT;
+}
+
+bool Shell_run(FILE *in)
+{
+    ShellResult result;
+    printf("%s", commandPrompt);
+    while ((result = Shell_runCommand(in)) == SHELL_CONTINUE)
+    {
+        printf("%s", commandPrompt);
+    }
+    return result == SHELL_QUIT;
+}
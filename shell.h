@@ -0,0 +1,67 @@
+#ifndef SHELL_H
+#define SHELL_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// Pauses between commands shorter than this are not recorded in the log
+#define SHELL_ARRIVAL_RESOLUTION_MS 10
+
+// Command interpreter of the simulator. It reads one-letter commands and their arguments from
+// any stream, so the same commands can come from the terminal, a file or a command log.
+
+typedef enum
+{
+    SHELL_CONTINUE, // A command was run (or rejected as invalid)
+    SHELL_END,      // The input ended
+    SHELL_QUIT      // Q was read
+} ShellResult;
+
+// Runs commands from in until Q or the end of input, prompting before each. Returns true if it
+// stopped at Q.
+bool Shell_run(FILE *in);
+
+// Reads and runs a single command from in without prompting.
+ShellResult Shell_runCommand(FILE *in);
+
+// Appends every command run from now on to the log at path, one line each in a form Shell_run
+// accepts, so a session can be replayed. A new log starts with a "# pids <n>" line recording the
+// process table size. Returns false if the log cannot be opened.
+bool Shell_openLog(const char *path);
+
+// Returns the process table size recorded at the start of the log at path, -1 if there is none.
+int Shell_recordedMaxPids(const char *path);
+
+// Appends one command to the log, if there is one, before it runs, so a command that ends the
+// program is kept too. Front ends that bypass Shell_runCommand log their commands through this.
+// Every state-changing command passes through here, which makes it the event counter: events
+// are numbered from 1 in the order they run. A gap of SHELL_ARRIVAL_RESOLUTION_MS or more
+// since the previous command is recorded as a "# +<ms>ms" comment line.
+void Shell_logCommand(const char *format, ...);
+
+// Ends the log with a "# state <digest>" line for the final state (see Snapshot_digest) and
+// closes it. Replaying the log checks every such line it reaches.
+void Shell_closeLog();
+
+// Ends the program once the simulation is over (Commands_isSimulationOver), closing the log
+// first so it keeps its final state. A replay reads on to the end of its log to check that
+// state, so the program ends after it instead. Shell_runCommand calls this before and after
+// every command; front ends that bypass it call it after each of theirs.
+void Shell_exitIfOver();
+
+// Sends output to /dev/null until event is about to run, to reach a point deep in a long replay
+// quickly. The simulator still does all the same work, statistics included, so the state it
+// reaches is identical. An event that has already been reached turns the output back on.
+void Shell_setFastForward(long event);
+
+// Number of events run so far.
+long Shell_eventCount();
+
+// Runs the commands logged in path from offset onwards, without logging them again.
+// Snapshot commands in the log are skipped. Returns false if the log cannot be read.
+bool Shell_replay(const char *path, long offset);
+
+// Prints the statistics reported on Q.
+void Shell_printStats();
+
+#endif // SHELL_H
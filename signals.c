@@ -0,0 +1,138 @@
+#include "signals.h"
+#include "scheduler.h"
+#include "semaphore.h"
+#include "futex.h"
+#include "deadlock.h"
+#include "snapshot.h"
+#include "program.h"
+#include <stdio.h>
+
+static SignalStats stats;
+
+static const char *signalNames[NUM_SIGNALS] = {"SIGINT", "SIGTERM", "SIGKILL", "SIGALRM", "SIGUSR"};
+
+const char *Signal_name(SignalId signal)
+{
+    return signal >= 0 && signal < NUM_SIGNALS ? signalNames[signal] : "unknown";
+}
+
+// Whether posting signal to process has no effect: it is ignored explicitly, or by default
+static bool is_ignored(const PCB *process, SignalId signal)
+{
+    unsigned bit = SIGNAL_BIT(signal);
+    if (signal == SIGNAL_KILL)
+    {
+        return false;
+    }
+    return (process->ignoredSignals & bit) != 0 || (signal == SIGNAL_USER && (process->handledSignals & bit) == 0);
+}
+
+bool Signal_setAction(PCB *process, SignalId signal, SignalAction action)
+{
+    if (process == NULL || signal < 0 || signal >= NUM_SIGNALS || signal == SIGNAL_KILL)
+    {
+        return false;
+    }
+    unsigned bit = SIGNAL_BIT(signal);
+    process->handledSignals &= ~bit;
+    process->ignoredSignals &= ~bit;
+    if (action == SIGNAL_HANDLE)
+    {
+        process->handledSignals |= bit;
+    }
+    else if (action == SIGNAL_IGNORE)
+    {
+        process->ignoredSignals |= bit;
+    }
+    if (is_ignored(process, signal))
+    {
+        process->pendingSignals &= ~bit;
+    }
+    return true;
+}
+
+// Takes a process out of a wait the signal interrupts, giving back what the wait had claimed.
+// Returns false if it is in some other state.
+static bool interrupt_wait(PCB *process)
+{
+    switch (process->state)
+    {
+    case BLOCKED_ON_SEMAPHORE:
+        semaphoreCancelWait(process); // Undoes its P, so it does not hold the semaphore
+        break;
+    case BLOCKED_ON_FUTEX:
+        Futex_cancelWait(process);
+        break;
+    case BLOCKED_ON_SEND:
+        cancelSend(process); // Gives up on the reply, or on room for a held-back message
+        break;
+    case BLOCKED_ON_RECEIVE:
+        break;
+    default:
+        return false;
+    }
+    Deadlock_clearWait(process);
+    Program_interrupt(process); // A process body sees its call fail
+    Scheduler_scheduleProcess(process);
+    return true;
+}
+
+SignalPostResult Signal_post(PCB *process, SignalId signal)
+{
+    if (is_ignored(process, signal))
+    {
+        stats.dropped++;
+        return SIGNAL_DROPPED;
+    }
+    process->pendingSignals |= SIGNAL_BIT(signal);
+    stats.posted++;
+    if (interrupt_wait(process))
+    {
+        stats.wakeups++;
+        return SIGNAL_WOKE;
+    }
+    return SIGNAL_PENDING;
+}
+
+bool Signal_deliver(PCB *process)
+{
+    unsigned pending = process->pendingSignals;
+    process->pendingSignals = 0;
+    for (int signal = 0; signal < NUM_SIGNALS; signal++)
+    {
+        unsigned bit = SIGNAL_BIT(signal);
+        if ((pending & bit) == 0)
+        {
+            continue;
+        }
+        stats.delivered++;
+        if (signal != SIGNAL_KILL && (process->handledSignals & bit) != 0)
+        {
+            stats.handled++;
+            printf("Process with PID %d runs its handler for %s.\n", process->pid, signalNames[signal]);
+        }
+        else if (signal == SIGNAL_TERMINATE || signal == SIGNAL_KILL)
+        {
+            stats.terminations++;
+            printf("Process with PID %d terminated by %s.\n", process->pid, signalNames[signal]);
+            return false;
+        }
+        // SIGINT and SIGALRM have done all they do by default when they woke the process
+    }
+    return true;
+}
+
+SignalStats Signal_getStats()
+{
+    return stats;
+}
+
+void Signal_save(SnapshotWriter *writer)
+{
+    Snapshot_putBytes(writer, &stats, sizeof(stats));
+}
+
+void Signal_restore(SnapshotReader *reader)
+{
+    Snapshot_getBytes(reader, &stats, sizeof(stats));
+}
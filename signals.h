@@ -0,0 +1,69 @@
+#ifndef SIGNALS_H
+#define SIGNALS_H
+
+#include <stdbool.h>
+#include "pcb.h"
+
+// Asynchronous signals to processes. Posting sets a bit in the target's pending mask in O(1);
+// the signal takes effect the next time the target is dispatched, where a handled signal runs
+// the process's handler and any other takes its default action. A process blocked in Receive,
+// on a semaphore or on a futex is woken early, without what it was waiting for, so it notices.
+// A process blocked on a Send or on I/O keeps waiting and sees the signal once that completes.
+
+typedef enum
+{
+    SIGNAL_INTERRUPT, // Default: only wakes the process from a blocked wait
+    SIGNAL_TERMINATE, // Default: terminates the process; handle it to shut down gracefully
+    SIGNAL_KILL,      // Always terminates; can be neither handled nor ignored
+    SIGNAL_ALARM,     // Default: only wakes the process, for timeouts
+    SIGNAL_USER,      // Default: ignored
+    NUM_SIGNALS
+} SignalId;
+
+typedef enum
+{
+    SIGNAL_DEFAULT,
+    SIGNAL_HANDLE,
+    SIGNAL_IGNORE
+} SignalAction;
+
+// Outcome of posting a signal
+typedef enum
+{
+    SIGNAL_DROPPED, // The process ignores it
+    SIGNAL_PENDING, // Delivered the next time the process is dispatched
+    SIGNAL_WOKE     // Also woke the process from a blocked wait
+} SignalPostResult;
+
+#define SIGNAL_BIT(signal) (1u << (signal))
+
+typedef struct
+{
+    long posted;       // Signals made pending, counting each repeat of one already pending
+    long dropped;      // Posted to a process that ignores them
+    long wakeups;      // Blocked waits cut short
+    long delivered;
+    long handled;      // Delivered to a handler
+    long terminations; // Processes a signal terminated
+} SignalStats;
+
+const char *Signal_name(SignalId signal);
+
+// Sets how process responds to signal. Returns false for SIGNAL_KILL, whose action is fixed.
+// Ignoring a signal discards it if it is already pending.
+bool Signal_setAction(PCB *process, SignalId signal, SignalAction action);
+
+SignalPostResult Signal_post(PCB *process, SignalId signal);
+
+// Delivers every pending signal of a process that has just been given the CPU, lowest number
+// first. Returns false if one of them terminates it; the caller then frees the process.
+bool Signal_deliver(PCB *process);
+
+SignalStats Signal_getStats();
+
+struct SnapshotWriter;
+struct SnapshotReader;
+void Signal_save(struct SnapshotWriter *writer);
+void Signal_restore(struct SnapshotReader *reader);
+
+#endif // SIGNALS_H
@@ -0,0 +1,412 @@
+#include "snapshot.h"
+#include "pidtable.h"
+#include "scheduler.h"
+#include "group.h"
+#include "edf.h"
+#include "semaphore.h"
+#include "commands.h"
+#include "futex.h"
+#include "deadlock.h"
+#include "cow.h"
+#include "workload.h"
+#include "device.h"
+#include "stats.h"
+#include "signals.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Written after the magic to reject snapshots from a machine with another byte order or int size
+#define SNAPSHOT_BYTE_ORDER 0x01020304
+// Marks the end of the sections, to catch a save and restore that disagree on layout
+#define SNAPSHOT_END_MARKER 0x454e4421L
+// Output buffer size; the state is written in large sequential chunks
+#define SNAPSHOT_BUFFER_SIZE (1 << 20)
+#define SNAPSHOT_FNV_OFFSET 0xcbf29ce484222325ULL
+#define SNAPSHOT_FNV_PRIME 0x100000001b3ULL
+
+static size_t pointer_hash(const void *pointer, long capacity)
+{
+    uintptr_t value = (uintptr_t)pointer;
+    value ^= value >> 17;
+    value *= (uintptr_t)0x9e3779b97f4a7c15ULL;
+    return (size_t)(value >> 7) & (size_t)(capacity - 1);
+}
+
+static bool map_grow(SnapshotPointerMap *map)
+{
+    long capacity = map->capacity > 0 ? 2 * map->capacity : 1024;
+    const void **keys = calloc(capacity, sizeof(void *));
+    long *values = malloc(capacity * sizeof(long));
+    if (keys == NULL || values == NULL)
+    {
+        free(keys);
+        free(values);
+        return false;
+    }
+    for (long i = 0; i < map->capacity; i++)
+    {
+        if (map->keys[i] != NULL)
+        {
+            size_t slot = pointer_hash(map->keys[i], capacity);
+            while (keys[slot] != NULL)
+            {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            keys[slot] = map->keys[i];
+            values[slot] = map->values[i];
+        }
+    }
+    free(map->keys);
+    free(map->values);
+    map->keys = keys;
+    map->values = values;
+    map->capacity = capacity;
+    return true;
+}
+
+void Snapshot_putBytes(SnapshotWriter *writer, const void *bytes, size_t size)
+{
+    if (writer->file == NULL)
+    {
+        const unsigned char *byte = bytes;
+        for (size_t i = 0; i < size; i++)
+        {
+            writer->digest = (writer->digest ^ byte[i]) * SNAPSHOT_FNV_PRIME;
+        }
+    }
+    else if (!writer->failed && size > 0 && fwrite(bytes, 1, size, writer->file) != size)
+    {
+        writer->failed = true;
+    }
+}
+
+void Snapshot_putInt(SnapshotWriter *writer, int value)
+{
+    Snapshot_putBytes(writer, &value, sizeof(value));
+}
+
+void Snapshot_putLong(SnapshotWriter *writer, long value)
+{
+    Snapshot_putBytes(writer, &value, sizeof(value));
+}
+
+void Snapshot_putPid(SnapshotWriter *writer, const PCB *process)
+{
+    Snapshot_putInt(writer, process != NULL ? process->pid : -1);
+}
+
+void Snapshot_putQueue(SnapshotWriter *writer, const ProcessQueue *queue)
+{
+    Snapshot_putInt(writer, queue->count);
+    for (const PCB *process = queue->head; process != NULL; process = process->queueNext)
+    {
+        Snapshot_putInt(writer, process->pid);
+    }
+}
+
+bool Snapshot_putObject(SnapshotWriter *writer, const void *object)
+{
+    if (object == NULL)
+    {
+        Snapshot_putLong(writer, -1);
+        return false;
+    }
+    SnapshotPointerMap *map = &writer->objects;
+    if (map->count * 2 >= map->capacity && !map_grow(map))
+    {
+        writer->failed = true;
+        return false;
+    }
+    size_t slot = pointer_hash(object, map->capacity);
+    while (map->keys[slot] != NULL && map->keys[slot] != object)
+    {
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+    if (map->keys[slot] == object)
+    {
+        Snapshot_putLong(writer, map->values[slot]);
+        return false;
+    }
+    map->keys[slot] = object;
+    map->values[slot] = map->count++;
+    Snapshot_putLong(writer, map->values[slot]);
+    return true;
+}
+
+void Snapshot_getBytes(SnapshotReader *reader, void *bytes, size_t size)
+{
+    if (reader->failed || size > reader->size - reader->offset)
+    {
+        reader->failed = true;
+        memset(bytes, 0, size);
+        return;
+    }
+    memcpy(bytes, reader->data + reader->offset, size);
+    reader->offset += size;
+}
+
+// The fixed-size reads copy with a constant size, which the compiler turns into a plain load;
+// a restore makes tens of them per process
+int Snapshot_getInt(SnapshotReader *reader)
+{
+    int value = 0;
+    if (reader->failed || sizeof(value) > reader->size - reader->offset)
+    {
+        reader->failed = true;
+        return value;
+    }
+    memcpy(&value, reader->data + reader->offset, sizeof(value));
+    reader->offset += sizeof(value);
+    return value;
+}
+
+long Snapshot_getLong(SnapshotReader *reader)
+{
+    long value = 0;
+    if (reader->failed || sizeof(value) > reader->size - reader->offset)
+    {
+        reader->failed = true;
+        return value;
+    }
+    memcpy(&value, reader->data + reader->offset, sizeof(value));
+    reader->offset += sizeof(value);
+    return value;
+}
+
+PCB *Snapshot_getPcb(SnapshotReader *reader)
+{
+    int pid = Snapshot_getInt(reader);
+    if (pid == -1)
+    {
+        return NULL;
+    }
+    PCB *process = PidTable_lookup(pid);
+    if (process == NULL)
+    {
+        reader->failed = true;
+    }
+    return process;
+}
+
+void Snapshot_getQueue(SnapshotReader *reader, ProcessQueue *queue)
+{
+    int count = Snapshot_getInt(reader);
+    for (int i = 0; i < count && !reader->failed; i++)
+    {
+        PCB *process = Snapshot_getPcb(reader);
+        if (process != NULL)
+        {
+            processQueueAppend(queue, process);
+        }
+    }
+}
+
+void *Snapshot_getObject(SnapshotReader *reader, bool *isNew)
+{
+    long index = Snapshot_getLong(reader);
+    *isNew = false;
+    if (index == -1 || reader->failed)
+    {
+        return NULL;
+    }
+    if (index == reader->objectCount)
+    {
+        *isNew = true;
+        return NULL;
+    }
+    if (index < 0 || index > reader->objectCount)
+    {
+        reader->failed = true;
+        return NULL;
+    }
+    return reader->objects[index];
+}
+
+void Snapshot_addObject(SnapshotReader *reader, void *object)
+{
+    if (reader->objectCount == reader->objectCapacity)
+    {
+        long capacity = reader->objectCapacity > 0 ? 2 * reader->objectCapacity : 1024;
+        void **objects = realloc(reader->objects, capacity * sizeof(void *));
+        if (objects == NULL)
+        {
+            reader->failed = true;
+            return;
+        }
+        reader->objects = objects;
+        reader->objectCapacity = capacity;
+    }
+    reader->objects[reader->objectCount++] = object;
+}
+
+static void count_process(PCB *process, void *arg)
+{
+    (void)process;
+    (*(int *)arg)++;
+}
+
+static void save_process(PCB *process, void *arg)
+{
+    savePCB((SnapshotWriter *)arg, process);
+}
+
+static void count_process_links(PCB *process, void *arg)
+{
+    if (process->blockedSenders.count > 0 || process->replyWaiters.count > 0)
+    {
+        (*(int *)arg)++;
+    }
+}
+
+// Only processes with senders queued on them are written; most have none
+static void save_process_links(PCB *process, void *arg)
+{
+    if (process->blockedSenders.count == 0 && process->replyWaiters.count == 0)
+    {
+        return;
+    }
+    SnapshotWriter *writer = (SnapshotWriter *)arg;
+    Snapshot_putPid(writer, process);
+    Snapshot_putQueue(writer, &process->blockedSenders);
+    Snapshot_putQueue(writer, &process->replyWaiters);
+}
+
+// Writes every section in the order Snapshot_restore reads them
+static void save_state(SnapshotWriter *writer, long logOffset)
+{
+    Snapshot_putBytes(writer, SNAPSHOT_MAGIC, 8);
+    Snapshot_putInt(writer, SNAPSHOT_VERSION);
+    Snapshot_putInt(writer, SNAPSHOT_BYTE_ORDER);
+    Snapshot_putLong(writer, logOffset);
+
+    // Processes first, so that every later section can refer to them by PID
+    PidTable_save(writer);
+    int processCount = 0;
+    PidTable_forEach(count_process, &processCount);
+    Snapshot_putInt(writer, processCount);
+    PidTable_forEach(save_process, writer);
+    int linkedCount = 0;
+    PidTable_forEach(count_process_links, &linkedCount);
+    Snapshot_putInt(writer, linkedCount);
+    PidTable_forEach(save_process_links, writer);
+
+    Scheduler_save(writer);
+    Group_save(writer);
+    Edf_save(writer);
+    semaphoreSaveState(writer);
+    Commands_save(writer);
+    Futex_save(writer);
+    Deadlock_save(writer);
+    Cow_save(writer);
+    Workload_save(writer);
+    Device_save(writer);
+    Signal_save(writer);
+    Stats_save(writer); // Last, so the gauges are not disturbed by queues being rebuilt
+    Snapshot_putLong(writer, SNAPSHOT_END_MARKER);
+    free(writer->objects.keys);
+    free(writer->objects.values);
+}
+
+bool Snapshot_save(const char *path, long logOffset)
+{
+    SnapshotWriter writer = {NULL, SNAPSHOT_FNV_OFFSET, false, {NULL, NULL, 0, 0}};
+    writer.file = fopen(path, "wb");
+    if (writer.file == NULL)
+    {
+        return false;
+    }
+    setvbuf(writer.file, NULL, _IOFBF, SNAPSHOT_BUFFER_SIZE);
+    save_state(&writer, logOffset);
+
+    bool ok = !writer.failed;
+    if (fclose(writer.file) != 0)
+    {
+        ok = false;
+    }
+    return ok;
+}
+
+bool Snapshot_digest(uint64_t *digest)
+{
+    SnapshotWriter writer = {NULL, SNAPSHOT_FNV_OFFSET, false, {NULL, NULL, 0, 0}};
+    save_state(&writer, 0);
+    *digest = writer.digest;
+    return !writer.failed;
+}
+
+bool Snapshot_restore(const char *path, long *logOffset)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+    SnapshotReader reader = {data, (size_t)info.st_size, 0, false, NULL, 0, 0};
+    char magic[8];
+    Snapshot_getBytes(&reader, magic, sizeof(magic));
+    if (memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 || Snapshot_getInt(&reader) != SNAPSHOT_VERSION ||
+        Snapshot_getInt(&reader) != SNAPSHOT_BYTE_ORDER)
+    {
+        munmap(data, (size_t)info.st_size);
+        return false;
+    }
+    *logOffset = Snapshot_getLong(&reader);
+
+    PidTable_restore(&reader);
+    int processCount = Snapshot_getInt(&reader);
+    if (processCount > 0 && !reservePCBs(processCount))
+    {
+        reader.failed = true;
+    }
+    for (int i = 0; i < processCount && !reader.failed; i++)
+    {
+        restorePCB(&reader);
+    }
+    int linkedCount = Snapshot_getInt(&reader);
+    for (int i = 0; i < linkedCount && !reader.failed; i++)
+    {
+        PCB *process = Snapshot_getPcb(&reader);
+        if (process != NULL)
+        {
+            Snapshot_getQueue(&reader, &process->blockedSenders);
+            Snapshot_getQueue(&reader, &process->replyWaiters);
+        }
+    }
+
+    Scheduler_restore(&reader);
+    Group_restore(&reader);
+    Edf_restore(&reader);
+    semaphoreRestoreState(&reader);
+    Commands_restore(&reader);
+    Futex_restore(&reader);
+    Deadlock_restore(&reader);
+    Cow_restore(&reader);
+    Workload_restore(&reader);
+    Device_restore(&reader);
+    Signal_restore(&reader);
+    Stats_restore(&reader);
+    bool ok = !reader.failed && Snapshot_getLong(&reader) == SNAPSHOT_END_MARKER && !reader.failed;
+
+    free(reader.objects);
+    munmap(data, (size_t)info.st_size);
+    return ok;
+}
@@ -0,0 +1,83 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "pcb.h"
+
+#define SNAPSHOT_MAGIC "SIMSNAP1"
+#define SNAPSHOT_VERSION 2
+
+// Binary checkpoint of the whole simulator. The file is a header followed by one section per
+// module, each written by that module's save function and read back by its restore function in
+// the same order. Processes are written first; after that every reference to a process is its
+// PID. Objects shared between processes (copy-on-write blocks, message payloads) are written
+// once, at their first reference, and later references are the object's index.
+// Numbers are in native byte order; a snapshot is only read on the kind of machine that wrote it.
+
+typedef struct SnapshotPointerMap
+{
+    const void **keys;
+    long *values;
+    long capacity; // Always a power of two
+    long count;
+} SnapshotPointerMap;
+
+typedef struct SnapshotWriter
+{
+    FILE *file;                 // NULL when only the digest is wanted
+    uint64_t digest;            // FNV-1a hash of everything written, kept when file is NULL
+    bool failed;
+    SnapshotPointerMap objects; // Shared object to its index
+} SnapshotWriter;
+
+typedef struct SnapshotReader
+{
+    const unsigned char *data; // The whole file, mapped read-only
+    size_t size;
+    size_t offset;
+    bool failed;               // Set by any read past the end or of a bad reference
+    void **objects;            // Shared objects by index
+    long objectCount;
+    long objectCapacity;
+} SnapshotReader;
+
+void Snapshot_putInt(SnapshotWriter *writer, int value);
+void Snapshot_putLong(SnapshotWriter *writer, long value);
+void Snapshot_putBytes(SnapshotWriter *writer, const void *bytes, size_t size);
+// Writes the PID of process, or -1 for NULL.
+void Snapshot_putPid(SnapshotWriter *writer, const PCB *process);
+// Writes a list of PIDs, head to tail.
+void Snapshot_putQueue(SnapshotWriter *writer, const ProcessQueue *queue);
+// Writes the index of a shared object. Returns true if this is its first reference, in which
+// case the caller writes its contents next. NULL is written as -1 and returns false.
+bool Snapshot_putObject(SnapshotWriter *writer, const void *object);
+
+int Snapshot_getInt(SnapshotReader *reader);
+long Snapshot_getLong(SnapshotReader *reader);
+void Snapshot_getBytes(SnapshotReader *reader, void *bytes, size_t size);
+// Reads a PID and returns its process, NULL for -1. A PID of no live process fails the reader.
+PCB *Snapshot_getPcb(SnapshotReader *reader);
+// Reads a list of PIDs and appends their processes to queue.
+void Snapshot_getQueue(SnapshotReader *reader, ProcessQueue *queue);
+// Reads a shared object index. Returns the object if it was seen before. For a first reference
+// it returns NULL and sets *isNew; the caller reads the contents and calls Snapshot_addObject.
+void *Snapshot_getObject(SnapshotReader *reader, bool *isNew);
+void Snapshot_addObject(SnapshotReader *reader, void *object);
+
+// Writes the complete simulator state to path. logOffset is the command log position the
+// snapshot corresponds to, -1 if there is no log. Returns false on any I/O error.
+bool Snapshot_save(const char *path, long logOffset);
+
+// Computes a hash of the complete simulator state, the same bytes Snapshot_save would write,
+// without writing them anywhere. Two runs in the same state get the same digest.
+bool Snapshot_digest(uint64_t *digest);
+
+// Restores the state saved in path into a freshly initialized simulator (no processes yet),
+// reading the file through mmap in one pass. Sets *logOffset to the saved log position.
+// Returns false if the file cannot be read or is not a valid snapshot.
+bool Snapshot_restore(const char *path, long *logOffset);
+
+#endif // SNAPSHOT_H
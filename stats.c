@@ -0,0 +1,115 @@
+#include "stats.h"
+#include "scheduler.h"
+#include "snapshot.h"
+#include <stdio.h>
+
+// Buffer of the sample file; samples are small, so flushing is left to the buffer filling up
+#define STATS_SAMPLE_BUFFER_SIZE (1 << 16)
+
+static StatsGauge gauges[STATS_NUM_GAUGES];
+static FILE *sampleFile = NULL;
+static int samplePeriod = 0;
+
+static const char *gaugeNames[STATS_NUM_GAUGES] = {
+    "ready_high", "ready_norm", "ready_low", "ready_rt", "semaphore_waiters", "mailbox_messages",
+};
+
+void Stats_add(StatsGaugeId id, long delta)
+{
+    StatsGauge *gauge = &gauges[id];
+    long now = Scheduler_getTime();
+    gauge->area += gauge->value * (now - gauge->lastChange);
+    gauge->lastChange = now;
+    gauge->value += delta;
+    if (delta > 0)
+    {
+        gauge->entries += delta;
+        if (gauge->value > gauge->max)
+        {
+            gauge->max = gauge->value;
+        }
+    }
+}
+
+const StatsGauge *Stats_get(StatsGaugeId id)
+{
+    return &gauges[id];
+}
+
+long Stats_area(StatsGaugeId id, long now)
+{
+    const StatsGauge *gauge = &gauges[id];
+    return gauge->area + gauge->value * (now - gauge->lastChange);
+}
+
+const char *Stats_name(StatsGaugeId id)
+{
+    return gaugeNames[id];
+}
+
+bool Stats_startSampler(const char *path, int period)
+{
+    if (sampleFile != NULL)
+    {
+        fclose(sampleFile);
+        sampleFile = NULL;
+    }
+    samplePeriod = 0;
+    if (path == NULL || period <= 0)
+    {
+        return true;
+    }
+    sampleFile = fopen(path, "w");
+    if (sampleFile == NULL)
+    {
+        return false;
+    }
+    setvbuf(sampleFile, NULL, _IOFBF, STATS_SAMPLE_BUFFER_SIZE);
+    samplePeriod = period;
+    fprintf(sampleFile, "tick");
+    for (int id = 0; id < STATS_NUM_GAUGES; id++)
+    {
+        fprintf(sampleFile, " %s", gaugeNames[id]);
+    }
+    fputc('\n', sampleFile);
+    return true;
+}
+
+void Stats_advanceTime(long now)
+{
+    if (sampleFile == NULL || now % samplePeriod != 0)
+    {
+        return;
+    }
+    fprintf(sampleFile, "%ld", now);
+    for (int id = 0; id < STATS_NUM_GAUGES; id++)
+    {
+        fprintf(sampleFile, " %ld", gauges[id].value);
+    }
+    fputc('\n', sampleFile);
+}
+
+// The sampler's file is not part of the state, like the command log
+void Stats_save(SnapshotWriter *writer)
+{
+    for (int id = 0; id < STATS_NUM_GAUGES; id++)
+    {
+        Snapshot_putLong(writer, gauges[id].value);
+        Snapshot_putLong(writer, gauges[id].max);
+        Snapshot_putLong(writer, gauges[id].entries);
+        Snapshot_putLong(writer, gauges[id].area);
+        Snapshot_putLong(writer, gauges[id].lastChange);
+    }
+}
+
+void Stats_restore(SnapshotReader *reader)
+{
+    for (int id = 0; id < STATS_NUM_GAUGES; id++)
+    {
+        gauges[id].value = Snapshot_getLong(reader);
+        gauges[id].max = Snapshot_getLong(reader);
+        gauges[id].entries = Snapshot_getLong(reader);
+        gauges[id].area = Snapshot_getLong(reader);
+        gauges[id].lastChange = Snapshot_getLong(reader);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include "scheduler.h"
+
+// Time-weighted queue statistics. Each gauge tracks the length of one kind of queue over the
+// whole run: every change adds the old length times the ticks it lasted to an area, so the
+// average length is area / elapsed ticks and, by Little's law, the average time spent queued is
+// area / entries. Changes are O(1) and the queues report them where they link and unlink.
+
+typedef enum
+{
+    STATS_READY,                               // One gauge per priority level, STATS_READY + priority
+    STATS_REAL_TIME_READY = STATS_READY + NUM_PRIORITIES,
+    STATS_SEMAPHORE_WAITERS,                   // Across all semaphores
+    STATS_MAILBOX_MESSAGES,                    // Across all mailboxes
+    STATS_NUM_GAUGES
+} StatsGaugeId;
+
+typedef struct
+{
+    long value;      // Current length
+    long max;
+    long entries;    // Items that have joined the queue
+    long area;       // Sum over ticks of the length, up to lastChange
+    long lastChange;
+} StatsGauge;
+
+struct SnapshotWriter;
+struct SnapshotReader;
+
+// Changes a gauge by delta items at the current simulated time. A positive delta counts as entries.
+void Stats_add(StatsGaugeId id, long delta);
+
+const StatsGauge *Stats_get(StatsGaugeId id);
+
+// Area of the gauge up to now, including the stretch since its last change.
+long Stats_area(StatsGaugeId id, long now);
+
+const char *Stats_name(StatsGaugeId id);
+
+// Writes one line with the length of every gauge to path each period ticks, after a header
+// line naming the columns. A period of 0 stops the sampler. Returns false if path cannot be opened.
+bool Stats_startSampler(const char *path, int period);
+
+// Called once per tick with the new time; writes a sample when one is due.
+void Stats_advanceTime(long now);
+
+void Stats_save(struct SnapshotWriter *writer);
+void Stats_restore(struct SnapshotReader *reader);
+
+#endif // STATS_H
@@ -0,0 +1,291 @@
+#include "workload.h"
+#include "scheduler.h"
+#include "device.h"
+#include "snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+
+static ProcessQueue wheel[WORKLOAD_WHEEL_SLOTS]; // Processes doing I/O, by completion tick
+static bool wheelReady = false;
+static unsigned randomState = 1;
+static int activeCount = 0;
+static long firstArrival = -1;
+static long busyTicks = 0;
+static long lastTick = 0;
+
+// Turnaround of every completed workload, for the percentile
+static long *turnarounds = NULL;
+static long completed = 0;
+static long turnaroundCapacity = 0;
+static long turnaroundTotal = 0;
+static long waitingTotal = 0;
+
+static void init_wheel(void)
+{
+    if (!wheelReady)
+    {
+        for (int i = 0; i < WORKLOAD_WHEEL_SLOTS; i++)
+        {
+            processQueueInit(&wheel[i]);
+        }
+        wheelReady = true;
+    }
+}
+
+// xorshift32: cheap, and reproducible across platforms for a given seed
+static unsigned next_random(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+// Geometric burst length with the given mean, at least one tick
+static int random_burst(int mean)
+{
+    int length = 1;
+    while (length < 100 * mean && next_random() % (unsigned)mean != 0)
+    {
+        length++;
+    }
+    return length;
+}
+
+void Workload_seed(unsigned seed)
+{
+    randomState = seed != 0 ? seed : 1; // xorshift never leaves zero
+}
+
+bool Workload_attach(PCB *process, const int *phases, int count, int device)
+{
+    if (process == NULL || process->workload != NULL || count < 1 || count > WORKLOAD_MAX_PHASES || count % 2 == 0 ||
+        device < -1 || device >= NUM_DEVICES)
+    {
+        return false;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (phases[i] < 1)
+        {
+            return false;
+        }
+    }
+    Workload *workload = malloc(sizeof(Workload));
+    if (workload == NULL)
+    {
+        return false;
+    }
+    memcpy(workload->phases, phases, count * sizeof(int));
+    workload->phaseCount = count;
+    workload->device = device;
+    for (int i = 1; i < count; i += 2)
+    {
+        // Drawn up front, so the same workload asks for the same tracks under any policy
+        workload->tracks[i] = device >= 0 ? (int)(next_random() % DEVICE_TRACKS) : 0;
+    }
+    workload->phase = 0;
+    workload->remaining = phases[0];
+    workload->arrival = Scheduler_getTime();
+    workload->cpuTicks = 0;
+    workload->ioTicks = 0;
+    workload->ioStart = 0;
+    workload->wakeTime = 0;
+    process->workload = workload;
+    activeCount++;
+    if (firstArrival < 0)
+    {
+        firstArrival = workload->arrival;
+    }
+    return true;
+}
+
+bool Workload_attachRandom(PCB *process, int cpuMean, int ioMean, int bursts, int device)
+{
+    int phases[WORKLOAD_MAX_PHASES];
+    if (cpuMean < 1 || ioMean < 1 || bursts < 1 || 2 * bursts - 1 > WORKLOAD_MAX_PHASES)
+    {
+        return false;
+    }
+    for (int i = 0; i < 2 * bursts - 1; i++)
+    {
+        phases[i] = random_burst(i % 2 == 0 ? cpuMean : ioMean);
+    }
+    return Workload_attach(process, phases, 2 * bursts - 1, device);
+}
+
+static void record_completion(Workload *workload, long finish)
+{
+    long turnaround = finish - workload->arrival;
+    if (completed == turnaroundCapacity)
+    {
+        long capacity = turnaroundCapacity > 0 ? 2 * turnaroundCapacity : 64;
+        long *grown = realloc(turnarounds, capacity * sizeof(long));
+        if (grown == NULL)
+        {
+            return;
+        }
+        turnarounds = grown;
+        turnaroundCapacity = capacity;
+    }
+    turnarounds[completed++] = turnaround;
+    turnaroundTotal += turnaround;
+    waitingTotal += turnaround - workload->cpuTicks - workload->ioTicks;
+}
+
+ProcessState Workload_runTick(PCB *running)
+{
+    long now = Scheduler_getTime();
+    lastTick = now + 1;
+    if (running == NULL)
+    {
+        return RUNNING;
+    }
+    if (firstArrival >= 0)
+    {
+        busyTicks++;
+    }
+    Workload *workload = running->workload;
+    if (workload == NULL)
+    {
+        return RUNNING;
+    }
+    workload->cpuTicks++;
+    if (--workload->remaining > 0)
+    {
+        return RUNNING;
+    }
+    if (workload->phase == workload->phaseCount - 1)
+    {
+        record_completion(workload, now + 1);
+        return TERMINATED;
+    }
+
+    // Start the I/O burst at the end of this tick, on the device or as a plain delay
+    int length = workload->phases[workload->phase + 1];
+    int track = workload->tracks[workload->phase + 1];
+    workload->ioStart = now + 1;
+    workload->phase += 2;
+    workload->remaining = workload->phases[workload->phase];
+    if (workload->device < 0 || !Device_submit(running, workload->device, track, length, now + 1))
+    {
+        init_wheel();
+        workload->wakeTime = now + 1 + length;
+        processQueueAppend(&wheel[workload->wakeTime & (WORKLOAD_WHEEL_SLOTS - 1)], running);
+    }
+    return BLOCKED_ON_IO;
+}
+
+void Workload_advanceTime(long now)
+{
+    init_wheel();
+    ProcessQueue *slot = &wheel[now & (WORKLOAD_WHEEL_SLOTS - 1)];
+    PCB *process = slot->head;
+    while (process != NULL)
+    {
+        PCB *next = process->queueNext;
+        Workload *workload = process->workload;
+        if (workload->wakeTime <= now)
+        {
+            processQueueRemove(process);
+            Workload_ioDone(process, now);
+            Scheduler_scheduleProcess(process);
+        }
+        process = next; // Bursts longer than the wheel wait for a later lap
+    }
+}
+
+void Workload_ioDone(PCB *process, long now)
+{
+    if (process->workload != NULL)
+    {
+        process->workload->ioTicks += now - process->workload->ioStart;
+    }
+}
+
+void Workload_free(PCB *process)
+{
+    if (process != NULL && process->workload != NULL)
+    {
+        free(process->workload);
+        process->workload = NULL;
+        activeCount--;
+    }
+}
+
+int Workload_activeCount()
+{
+    return activeCount;
+}
+
+static int compare_long(const void *a, const void *b)
+{
+    long x = *(const long *)a;
+    long y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+void Workload_getReport(WorkloadReport *report)
+{
+    report->completed = completed;
+    report->elapsed = firstArrival >= 0 ? lastTick - firstArrival : 0;
+    report->busyTicks = busyTicks;
+    report->turnaroundTotal = turnaroundTotal;
+    report->waitingTotal = waitingTotal;
+    report->turnaroundP99 = 0;
+    if (completed > 0)
+    {
+        qsort(turnarounds, completed, sizeof(long), compare_long);
+        report->turnaroundP99 = turnarounds[(completed * 99 + 99) / 100 - 1]; // Nearest rank
+    }
+}
+
+void Workload_save(SnapshotWriter *writer)
+{
+    init_wheel();
+    Snapshot_putInt(writer, (int)randomState);
+    Snapshot_putInt(writer, activeCount);
+    Snapshot_putLong(writer, firstArrival);
+    Snapshot_putLong(writer, busyTicks);
+    Snapshot_putLong(writer, lastTick);
+    Snapshot_putLong(writer, turnaroundTotal);
+    Snapshot_putLong(writer, waitingTotal);
+    Snapshot_putLong(writer, completed);
+    Snapshot_putBytes(writer, turnarounds, (size_t)completed * sizeof(long));
+    for (int i = 0; i < WORKLOAD_WHEEL_SLOTS; i++)
+    {
+        Snapshot_putQueue(writer, &wheel[i]);
+    }
+}
+
+void Workload_restore(SnapshotReader *reader)
+{
+    init_wheel();
+    randomState = (unsigned)Snapshot_getInt(reader);
+    activeCount = Snapshot_getInt(reader);
+    firstArrival = Snapshot_getLong(reader);
+    busyTicks = Snapshot_getLong(reader);
+    lastTick = Snapshot_getLong(reader);
+    turnaroundTotal = Snapshot_getLong(reader);
+    waitingTotal = Snapshot_getLong(reader);
+    long count = Snapshot_getLong(reader);
+    if (count < 0 || (size_t)count > (reader->size - reader->offset) / sizeof(long))
+    {
+        reader->failed = true;
+        return;
+    }
+    long *restored = realloc(turnarounds, (count > 0 ? count : 1) * sizeof(long));
+    if (restored == NULL)
+    {
+        reader->failed = true;
+        return;
+    }
+    turnarounds = restored;
+    turnaroundCapacity = count > 0 ? count : 1;
+    completed = count;
+    Snapshot_getBytes(reader, turnarounds, (size_t)count * sizeof(long));
+    for (int i = 0; i < WORKLOAD_WHEEL_SLOTS; i++)
+    {
+        Snapshot_getQueue(reader, &wheel[i]);
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdbool.h>
+#include "pcb.h"
+
+// Most phases a burst script can have
+#define WORKLOAD_MAX_PHASES 64
+// Slots in the timer wheel of processes doing I/O. Must be a power of two.
+#define WORKLOAD_WHEEL_SLOTS 64
+
+// Synthetic work for a process: a script of alternating CPU and I/O bursts, in ticks, that
+// starts and ends with a CPU burst. The process spends each tick it runs on its current CPU burst,
+// blocks in BLOCKED_ON_IO for each I/O burst, and terminates when the script is done. An I/O
+// burst is either a plain delay or, when the workload has a device, a request to a random track
+// of that device whose transfer takes the burst length once the device gets to it.
+typedef struct Workload
+{
+    int phases[WORKLOAD_MAX_PHASES];
+    int phaseCount;
+    int tracks[WORKLOAD_MAX_PHASES]; // Track of each I/O burst on the device
+    int device;    // Device the I/O bursts go to (device.h), -1 for plain delays
+    int phase;     // Index of the current burst
+    int remaining; // Ticks left in it
+    long arrival;  // Tick the process was given the workload
+    long cpuTicks; // Ticks spent on CPU and I/O bursts so far
+    long ioTicks;
+    long ioStart;  // Tick the current I/O burst started at
+    long wakeTime; // Tick a plain-delay I/O burst completes at
+} Workload;
+
+// Turnaround, waiting time and utilization of the workloads run so far, in ticks
+typedef struct WorkloadReport
+{
+    long completed;
+    long elapsed;         // Ticks since the first workload arrived
+    long busyTicks;       // Ticks in that span with a process other than init running
+    long turnaroundTotal;
+    long turnaroundP99;
+    long waitingTotal;    // Turnaround not spent running or doing I/O
+} WorkloadReport;
+
+// Gives process a burst script of count phases doing I/O on device (-1 for plain delays).
+// Returns false if the script or device is invalid.
+bool Workload_attach(PCB *process, const int *phases, int count, int device);
+
+// Gives process a random script of bursts CPU bursts separated by I/O bursts, with geometric
+// lengths of the given means drawn from the workload random number generator.
+bool Workload_attachRandom(PCB *process, int cpuMean, int ioMean, int bursts, int device);
+
+// Seeds the generator, so the same commands produce the same workload.
+void Workload_seed(unsigned seed);
+
+// Runs the current tick for running (NULL when only init is running). Returns RUNNING while
+// the process has CPU work left, otherwise the state it leaves the CPU in at the end of the
+// tick: BLOCKED_ON_IO, or TERMINATED when its script is done.
+ProcessState Workload_runTick(PCB *running);
+
+// Makes every process whose I/O burst completes at now ready. O(1) per tick amortized.
+void Workload_advanceTime(long now);
+
+// Ends the I/O burst of a process whose device request completed at now.
+void Workload_ioDone(PCB *process, long now);
+
+// Frees the workload of a process that is being destroyed.
+void Workload_free(PCB *process);
+
+// Number of processes whose workloads have not finished.
+int Workload_activeCount();
+
+void Workload_getReport(WorkloadReport *report);
+
+// Snapshot support (snapshot.h): the generator, the I/O timer wheel and the completion statistics.
+// Each workload is saved with its process.
+struct SnapshotWriter;
+struct SnapshotReader;
+void Workload_save(struct SnapshotWriter *writer);
+void Workload_restore(struct SnapshotReader *reader);
+
+#endif // WORKLOAD_H